@@ -0,0 +1,77 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+using namespace std;
+
+#if OYUKI_COUNT_ALLOCS
+
+namespace
+{
+	atomic<uint64_t> allocations{ 0 };
+	atomic<uint64_t> allocatedBytes{ 0 };
+
+	void* countedAlloc(size_t size)
+	{
+		allocations.fetch_add(1, memory_order_relaxed);
+		allocatedBytes.fetch_add(size, memory_order_relaxed);
+		return malloc(size ? size : 1);
+	}
+}
+
+uint64_t AllocationCounter::count()
+{
+	return allocations.load(memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::bytes()
+{
+	return allocatedBytes.load(memory_order_relaxed);
+}
+
+// Reemplazo de las versiones sin alineacion extra de operator new/delete.
+// Las alineadas (alignas > 16) siguen usando las de la biblioteca.
+void* operator new(size_t size)
+{
+	void* p = countedAlloc(size);
+	if (!p) throw bad_alloc();
+	return p;
+}
+
+void* operator new[](size_t size)
+{
+	void* p = countedAlloc(size);
+	if (!p) throw bad_alloc();
+	return p;
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+	return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+	return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { free(p); }
+
+#else
+
+uint64_t AllocationCounter::count()
+{
+	return 0;
+}
+
+uint64_t AllocationCounter::bytes()
+{
+	return 0;
+}
+
+#endif
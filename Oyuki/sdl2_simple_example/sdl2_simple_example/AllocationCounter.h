@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+
+// Cuenta las llamadas al operator new global de todo el proceso, para comprobar
+// que un frame estable no reserva memoria del heap. Lo que va directo a malloc
+// (ImGui, SDL, el driver) no pasa por aqui.
+// Con OYUKI_COUNT_ALLOCS = 0 no se reemplaza operator new y count() devuelve 0.
+
+#ifndef OYUKI_COUNT_ALLOCS
+#define OYUKI_COUNT_ALLOCS 1
+#endif
+
+namespace AllocationCounter
+{
+	uint64_t count();
+	uint64_t bytes();
+}
@@ -0,0 +1,159 @@
+#include "AssimpIO.h"
+#include "MappedFile.h"
+#include "MemoryTracker.h"
+#include "Pak.h"
+#include <assimp/cfileio.h>
+#include <assimp/cimport.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdio.h>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace
+{
+	// Un fichero abierto a traves de mapped(). Lo que se lee esta siempre en
+	// 'view': el mapeo del fichero suelto o la entrada del Pak.
+	struct MappedAiFile
+	{
+		aiFile file;
+		MappedFile mapping;
+		vector<unsigned char> storage; // entrada comprimida del Pak
+		PakView view;
+		size_t position = 0;
+		FILE* output = nullptr; // Assimp solo escribe al exportar: eso va por stdio
+	};
+
+	MappedAiFile* mappedFile(aiFile* file)
+	{
+		return reinterpret_cast<MappedAiFile*>(file->UserData);
+	}
+
+	size_t mappedRead(aiFile* file, char* buffer, size_t size, size_t count)
+	{
+		MappedAiFile* f = mappedFile(file);
+		if (f->output || size == 0) return 0;
+		const size_t items = min(count, (f->view.size - f->position) / size);
+		memcpy(buffer, f->view.data + f->position, items * size);
+		f->position += items * size;
+		return items;
+	}
+
+	size_t mappedWrite(aiFile* file, const char* buffer, size_t size, size_t count)
+	{
+		MappedAiFile* f = mappedFile(file);
+		return f->output ? fwrite(buffer, size, count, f->output) : 0;
+	}
+
+	size_t mappedTell(aiFile* file)
+	{
+		MappedAiFile* f = mappedFile(file);
+		return f->output ? static_cast<size_t>(ftell(f->output)) : f->position;
+	}
+
+	size_t mappedSize(aiFile* file)
+	{
+		MappedAiFile* f = mappedFile(file);
+		if (!f->output) return f->view.size;
+		const long position = ftell(f->output);
+		fseek(f->output, 0, SEEK_END);
+		const long size = ftell(f->output);
+		fseek(f->output, position, SEEK_SET);
+		return static_cast<size_t>(size);
+	}
+
+	aiReturn mappedSeek(aiFile* file, size_t offset, aiOrigin origin)
+	{
+		MappedAiFile* f = mappedFile(file);
+		if (f->output) {
+			const int whence = origin == aiOrigin_SET ? SEEK_SET : origin == aiOrigin_CUR ? SEEK_CUR : SEEK_END;
+			return fseek(f->output, static_cast<long>(offset), whence) == 0 ? aiReturn_SUCCESS : aiReturn_FAILURE;
+		}
+		const size_t base = origin == aiOrigin_SET ? 0 : origin == aiOrigin_CUR ? f->position : f->view.size;
+		if (base + offset > f->view.size) return aiReturn_FAILURE;
+		f->position = base + offset;
+		return aiReturn_SUCCESS;
+	}
+
+	void mappedFlush(aiFile* file)
+	{
+		MappedAiFile* f = mappedFile(file);
+		if (f->output) fflush(f->output);
+	}
+
+	// Deja en 'view' el contenido de 'path': del Pak montado si esta, si no proyectado del disco
+	bool mapInput(const char* path, MappedFile& mapping, vector<unsigned char>& storage, PakView& view)
+	{
+		if (const PakEntry* entry = Pak::find(path)) {
+			if (!Pak::read(*entry, storage, view)) return false;
+			MemoryTracker::add(MemTag::Importer, storage.capacity());
+			return true;
+		}
+		if (!mapping.open(path)) return false;
+		// Los importadores leen casi siempre de principio a fin: lectura adelantada agresiva
+		mapping.advise(MapAccess::Sequential);
+		mapping.prefetch(0, mapping.size());
+		view.data = mapping.data();
+		view.size = mapping.size();
+		return true;
+	}
+
+	aiFile* mappedOpen(aiFileIO*, const char* path, const char* mode)
+	{
+		auto f = make_unique<MappedAiFile>();
+		if (strpbrk(mode, "wa+")) {
+			f->output = fopen(path, mode);
+			if (!f->output) return nullptr;
+		}
+		else if (!mapInput(path, f->mapping, f->storage, f->view)) {
+			return nullptr;
+		}
+		f->file = { mappedRead, mappedWrite, mappedTell, mappedSize, mappedSeek, mappedFlush, reinterpret_cast<aiUserData>(f.get()) };
+		return &f.release()->file;
+	}
+
+	void mappedClose(aiFileIO*, aiFile* file)
+	{
+		MappedAiFile* f = mappedFile(file);
+		if (f->output) fclose(f->output);
+		MemoryTracker::remove(MemTag::Importer, f->storage.capacity());
+		delete f;
+	}
+
+	aiFileIO mappedFileIO = { mappedOpen, mappedClose, nullptr };
+}
+
+const char* AssimpIO::ioName(ImportIO io)
+{
+	switch (io) {
+	case ImportIO::Stdio: return "stdio";
+	case ImportIO::Mapped: return "mmap";
+	case ImportIO::Memory: return "memory";
+	}
+	return "?";
+}
+
+aiFileIO* AssimpIO::mapped()
+{
+	return &mappedFileIO;
+}
+
+const aiScene* AssimpIO::import(const char* file, unsigned int flags, ImportIO io)
+{
+	if (io == ImportIO::Stdio) return aiImportFile(file, flags);
+	if (io == ImportIO::Mapped) return aiImportFileEx(file, flags, &mappedFileIO);
+
+	MappedFile mapping;
+	vector<unsigned char> storage;
+	PakView view;
+	if (!mapInput(file, mapping, storage, view)) return nullptr;
+	// La pista es la extension: Assimp elige el importador con ella
+	const char* dot = strrchr(file, '.');
+	const string hint = dot ? string(dot + 1) : string();
+	const aiScene* scene = aiImportFileFromMemory(reinterpret_cast<const char*>(view.data),
+		static_cast<unsigned int>(view.size), flags, hint.c_str());
+	MemoryTracker::remove(MemTag::Importer, storage.capacity());
+	return scene;
+}
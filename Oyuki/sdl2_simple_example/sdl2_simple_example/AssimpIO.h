@@ -0,0 +1,23 @@
+#pragma once
+
+struct aiFileIO;
+struct aiScene;
+
+// Como lee Assimp el fichero de entrada.
+//   Stdio:  aiImportFile, con el IO por defecto (fopen/fread y su buffer); no ve el Pak
+//   Mapped: aiFileIO propio que sirve los ficheros desde un mmap con lectura
+//           secuencial adelantada, y las entradas del Pak montado desde memoria
+//   Memory: se proyecta el fichero entero y se pasa a aiImportFileFromMemory.
+//           No sirve para formatos que abren otros ficheros (.obj + .mtl).
+enum class ImportIO { Stdio, Mapped, Memory };
+
+namespace AssimpIO
+{
+	const char* ioName(ImportIO io);
+
+	// El aiFileIO del modo Mapped (para aiImportFileEx)
+	aiFileIO* mapped();
+
+	// aiImportFile* segun 'io'; nullptr si falla (el error en aiGetErrorString)
+	const aiScene* import(const char* file, unsigned int flags, ImportIO io);
+}
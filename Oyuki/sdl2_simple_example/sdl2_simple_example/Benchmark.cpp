@@ -0,0 +1,1107 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "Mesh.h"
+#include "Simulation.h"
+#include "Culling.h"
+#include "RenderPacket.h"
+#include "MemoryTracker.h"
+#include "Scene.h"
+#include "SimdMath.h"
+#include "Startup.h"
+#include "SceneFile.h"
+#include "Picking.h"
+#include "Camera.h"
+#include "Resources.h"
+#include "SoftwareRenderer.h"
+#include <assimp/scene.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+using namespace std;
+
+using hrclock = chrono::high_resolution_clock;
+
+namespace
+{
+	double elapsedMs(hrclock::time_point t0)
+	{
+		return chrono::duration<double, milli>(hrclock::now() - t0).count();
+	}
+
+	void writeJsonString(FILE* f, const string& s)
+	{
+		fputc('"', f);
+		for (char c : s) {
+			if (c == '"' || c == '\\') fputc('\\', f);
+			if (static_cast<unsigned char>(c) >= 0x20) fputc(c, f);
+		}
+		fputc('"', f);
+	}
+
+	// Evita que el compilador elimine resultados que no se usan
+	volatile size_t sink = 0;
+
+	// Mejor tiempo de 'repeats' ejecuciones; setup() se llama antes de cada una sin medirse
+	template<class Setup, class Run>
+	double measure(int repeats, Setup setup, Run run)
+	{
+		double best = 1e30;
+		for (int r = 0; r < repeats; r++) {
+			setup();
+			const auto t0 = hrclock::now();
+			run();
+			best = min(best, elapsedMs(t0));
+		}
+		return best;
+	}
+
+	// Malla en rejilla con 'triangles' triangulos (redondeado a la rejilla), normales y UVs
+	aiMesh* makeGridMesh(size_t triangles)
+	{
+		const unsigned int side = max(1u, static_cast<unsigned int>(sqrt(triangles / 2.0)));
+		const unsigned int verts = (side + 1) * (side + 1);
+
+		aiMesh* mesh = new aiMesh();
+		mesh->mNumVertices = verts;
+		mesh->mVertices = new aiVector3D[verts];
+		mesh->mNormals = new aiVector3D[verts];
+		mesh->mTextureCoords[0] = new aiVector3D[verts];
+		for (unsigned int y = 0; y <= side; y++) {
+			for (unsigned int x = 0; x <= side; x++) {
+				const unsigned int v = y * (side + 1) + x;
+				const float u = static_cast<float>(x) / side, w = static_cast<float>(y) / side;
+				mesh->mVertices[v] = aiVector3D(u * 2.0f - 1.0f, 0.1f * sinf(u * 20.0f), w * 2.0f - 1.0f);
+				mesh->mNormals[v] = aiVector3D(0.0f, 1.0f, 0.0f);
+				mesh->mTextureCoords[0][v] = aiVector3D(u, w, 0.0f);
+			}
+		}
+
+		mesh->mNumFaces = side * side * 2;
+		mesh->mFaces = new aiFace[mesh->mNumFaces];
+		unsigned int f = 0;
+		for (unsigned int y = 0; y < side; y++) {
+			for (unsigned int x = 0; x < side; x++) {
+				const unsigned int i = y * (side + 1) + x;
+				const unsigned int quad[2][3] = { { i, i + side + 1, i + 1 }, { i + 1, i + side + 1, i + side + 2 } };
+				for (const auto& tri : quad) {
+					aiFace& face = mesh->mFaces[f++];
+					face.mNumIndices = 3;
+					face.mIndices = new unsigned int[3]{ tri[0], tri[1], tri[2] };
+				}
+			}
+		}
+		return mesh;
+	}
+
+	// Esfera de radio ~1 con bultos (para que el BVH no sea trivial), en el formato de MeshData
+	void makeBumpySphere(size_t triangles, vector<glm::vec3>& vertices, vector<vector<unsigned int>>& faces)
+	{
+		const unsigned int rings = max(2u, static_cast<unsigned int>(sqrt(triangles / 4.0)));
+		const unsigned int segments = rings * 2;
+		vertices.clear();
+		faces.clear();
+		vertices.reserve(static_cast<size_t>(rings + 1) * (segments + 1));
+		faces.reserve(static_cast<size_t>(rings) * segments * 2);
+		for (unsigned int r = 0; r <= rings; r++) {
+			const float theta = 3.14159265f * r / rings;
+			for (unsigned int s = 0; s <= segments; s++) {
+				const float phi = 6.28318531f * s / segments;
+				const float radius = 1.0f + 0.05f * sinf(theta * 17.0f) * cosf(phi * 13.0f);
+				vertices.push_back(glm::vec3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi)) * radius);
+			}
+		}
+		for (unsigned int r = 0; r < rings; r++) {
+			for (unsigned int s = 0; s < segments; s++) {
+				const unsigned int i = r * (segments + 1) + s;
+				faces.push_back({ i, i + segments + 1, i + 1 });
+				faces.push_back({ i + 1, i + segments + 1, i + segments + 2 });
+			}
+		}
+	}
+
+	// Referencia del BVH: todos los triangulos con la misma prueba
+	bool bruteForceRay(const vector<glm::vec3>& vertices, const vector<vector<unsigned int>>& faces,
+		const glm::vec3& origin, const glm::vec3& direction, BvhHit& hit)
+	{
+		float best = numeric_limits<float>::max();
+		for (size_t i = 0; i < faces.size(); i++) {
+			const glm::vec3 v0 = vertices[faces[i][0]];
+			const glm::vec3 e1 = vertices[faces[i][1]] - v0, e2 = vertices[faces[i][2]] - v0;
+			const glm::vec3 p = glm::cross(direction, e2);
+			const float det = glm::dot(e1, p);
+			if (fabsf(det) < 1e-12f) continue;
+			const float invDet = 1.0f / det;
+			const glm::vec3 s = origin - v0;
+			const float u = glm::dot(s, p) * invDet;
+			if (!(u >= 0.0f && u <= 1.0f)) continue;
+			const glm::vec3 q = glm::cross(s, e1);
+			const float v = glm::dot(direction, q) * invDet;
+			if (!(v >= 0.0f && u + v <= 1.0f)) continue;
+			const float t = glm::dot(e2, q) * invDet;
+			if (!(t >= 0.0f && t < best)) continue;
+			best = t;
+			hit.distance = t;
+			hit.triangle = static_cast<uint32_t>(i);
+		}
+		return best < numeric_limits<float>::max();
+	}
+
+	// Conversion de vertices anterior (push_back por vertice a dvec3, sin reserve) como referencia
+	void convertVerticesPushBack(const aiMesh* mesh, float scaleFactor, vector<glm::dvec3>& vertices,
+		vector<glm::dvec3>& normals, vector<glm::dvec3>& texCoords)
+	{
+		for (unsigned int v = 0; v < mesh->mNumVertices; v++) {
+			const aiVector3D vertex = mesh->mVertices[v];
+			vertices.push_back(glm::dvec3(vertex.x * scaleFactor, vertex.y * scaleFactor, vertex.z * scaleFactor));
+			if (mesh->HasNormals()) {
+				const aiVector3D normal = mesh->mNormals[v];
+				normals.push_back(glm::dvec3(normal.x, normal.y, normal.z));
+			}
+			if (mesh->HasTextureCoords(0)) {
+				const aiVector3D texCoord = mesh->mTextureCoords[0][v];
+				texCoords.push_back(glm::dvec3(texCoord.x, texCoord.y, 0));
+			}
+		}
+	}
+
+	struct StageResult
+	{
+		const char* stage;
+		size_t size;     // triangulos o elementos de la etapa
+		double ms;
+	};
+
+	// Campo "VmRSS:"/"VmHWM:" de /proc/self/status en bytes, 0 si no existe
+	size_t procStatusBytes(const char* field)
+	{
+		size_t bytes = 0;
+#ifdef __linux__
+		FILE* f = fopen("/proc/self/status", "r");
+		if (!f) return 0;
+		char line[256];
+		const size_t length = strlen(field);
+		while (fgets(line, sizeof(line), f)) {
+			if (strncmp(line, field, length) == 0) {
+				bytes = strtoull(line + length, nullptr, 10) * 1024;
+				break;
+			}
+		}
+		fclose(f);
+#endif
+		return bytes;
+	}
+
+	// Vuelve a empezar el pico de memoria residente (VmHWM); false si no se puede
+	bool resetPeakMemory()
+	{
+#ifdef __linux__
+		FILE* f = fopen("/proc/self/clear_refs", "w");
+		if (!f) return false;
+		const bool written = fputs("5", f) >= 0;
+		return fclose(f) == 0 && written;
+#else
+		return false;
+#endif
+	}
+
+	// ru_maxrss no se reinicia con clear_refs: se lee VmHWM si esta
+	size_t peakResidentBytes()
+	{
+		const size_t hwm = procStatusBytes("VmHWM:");
+		return hwm ? hwm : Benchmark::peakMemoryBytes();
+	}
+
+	// Trabajo sintetico parecido a transformar vertices
+	float work(size_t i)
+	{
+		float v = static_cast<float>(i);
+		for (int k = 0; k < 64; k++) v = sqrtf(v * 1.0001f + 1.0f);
+		return v;
+	}
+}
+
+int Benchmark::runJobSystem()
+{
+	const size_t ELEMENTS = 4 * 1024 * 1024;
+	const int REPEATS = 5;
+	const int maxThreads = static_cast<int>(thread::hardware_concurrency()) > 0 ? static_cast<int>(thread::hardware_concurrency()) : 1;
+
+	vector<float> data(ELEMENTS);
+	vector<float> reference(ELEMENTS);
+	for (size_t i = 0; i < ELEMENTS; i++) reference[i] = work(i);
+
+	int failures = 0;
+	double baseline = 0.0;
+	printf("threads  parallelFor(ms)  speedup  jobs/s(empty)\n");
+	for (int threads = 1; threads <= maxThreads; threads++) {
+		JobSystem::init(threads);
+
+		double best = 1e30;
+		for (int r = 0; r < REPEATS; r++) {
+			const auto t0 = hrclock::now();
+			JobSystem::parallelFor(ELEMENTS, 16 * 1024, [&data](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) data[i] = work(i);
+			});
+			best = min(best, elapsedMs(t0));
+			if (data != reference) failures++;
+		}
+		if (threads == 1) baseline = best;
+
+		// Muchos jobs vacios con contadores anidados para medir overhead y contencion
+		const int OUTER = 256, INNER = 256;
+		atomic<int> executed{ 0 };
+		const auto t0 = hrclock::now();
+		JobCounter outer;
+		for (int o = 0; o < OUTER; o++) {
+			atomic<int>* exec = &executed;
+			JobSystem::run(outer, [exec]() {
+				JobCounter inner;
+				for (int i = 0; i < INNER; i++) JobSystem::run(inner, [exec]() { exec->fetch_add(1, memory_order_relaxed); });
+				JobSystem::wait(inner);
+			});
+		}
+		JobSystem::wait(outer);
+		const double jobsMs = elapsedMs(t0);
+		if (executed.load() != OUTER * INNER) failures++;
+
+		printf("%7d  %15.2f  %7.2fx  %13.0f\n", threads, best, baseline / best, OUTER * INNER / (jobsMs / 1000.0));
+		JobSystem::shutdown();
+	}
+
+	if (failures) printf("ERROR: %d resultados incorrectos\n", failures);
+	return failures ? 1 : 0;
+}
+
+int Benchmark::runStages(size_t maxTriangles, const char* out)
+{
+	const int REPEATS = 5;
+	vector<StageResult> results;
+	auto report = [&results](const char* stage, size_t size, double ms) {
+		results.push_back({ stage, size, ms });
+		printf("%-18s %10zu  %10.3f ms  %8.2f M/s\n", stage, size, ms, size / (ms * 1000.0));
+	};
+
+	printf("%-18s %10s  %13s  %10s\n", "etapa", "tamano", "mejor", "ritmo");
+	// Potencias de 10 y al final el propio maxTriangles
+	for (size_t triangles = min<size_t>(1000, maxTriangles); triangles <= maxTriangles;
+		triangles = (triangles == maxTriangles) ? maxTriangles + 1 : min(triangles * 10, maxTriangles)) {
+		aiMesh* mesh = makeGridMesh(triangles);
+		const size_t tris = mesh->mNumFaces;
+		const size_t verts = mesh->mNumVertices;
+		MeshData meshData;
+
+		// LoadFBX: aiVector3D -> vertices/normales/UVs de MeshData (medido en vertices)
+		vector<glm::dvec3> oldVertices, oldNormals, oldTexCoords;
+		report("pushBackVertices", verts, measure(REPEATS, [&] {
+			oldVertices = vector<glm::dvec3>();
+			oldNormals = vector<glm::dvec3>();
+			oldTexCoords = vector<glm::dvec3>();
+		}, [&] {
+			convertVerticesPushBack(mesh, 1.0f, oldVertices, oldNormals, oldTexCoords);
+		}));
+		report("convertVertices", verts, measure(REPEATS, [&] { meshData = MeshData(); }, [&] {
+			convertVertices(mesh, 1.0f, meshData);
+		}));
+
+		// LoadFBX: aiFace -> triangulos
+		report("convertFaces", tris, measure(REPEATS, [&] { meshData.triangles.clear(); meshData.triangles.shrink_to_fit(); }, [&] {
+			convertFaces(mesh, meshData);
+		}));
+
+		// LoadToBuffers: aplanado de indices para el EBO
+		pmr::vector<unsigned int> indices;
+		report("flattenIndices", tris, measure(REPEATS, [&] { indices = pmr::vector<unsigned int>(); }, [&] {
+			flattenIndices(meshData, indices);
+			sink = sink + indices.size();
+		}));
+		delete mesh;
+
+		// display_func/extract_frame con tantos objetos como triangulos/100
+		const size_t objects = max<size_t>(10, tris / 100);
+		vector<glm::vec3> boundsMin(objects), boundsMax(objects);
+		vector<glm::mat4> models(objects, glm::mat4(1.0f));
+		for (size_t i = 0; i < objects; i++) {
+			const float x = static_cast<float>(i % 100) - 50.0f, z = static_cast<float>(i / 100 % 100) - 50.0f;
+			models[i] = glm::translate(glm::mat4(1.0f), glm::vec3(x, 0.0f, z));
+			boundsMin[i] = glm::vec3(-0.5f);
+			boundsMax[i] = glm::vec3(0.5f);
+		}
+
+		SimState state;
+		state.rotationX = 20.0f;
+		state.zoomLevel = -10.0f;
+		const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+
+		vector<glm::mat4> views(objects);
+		report("viewMatrix", objects, measure(REPEATS, [] {}, [&] {
+			for (size_t i = 0; i < objects; i++) {
+				state.rotationY = static_cast<float>(i);
+				views[i] = computeViewMatrix(state);
+			}
+		}));
+
+		const Frustum frustum = extractFrustum(projection * views[0]);
+		size_t visible = 0;
+		report("frustumCulling", objects, measure(REPEATS, [&] { visible = 0; }, [&] {
+			for (size_t i = 0; i < objects; i++) {
+				glm::vec3 wmin, wmax;
+				transformBounds(models[i], boundsMin[i], boundsMax[i], wmin, wmax);
+				if (isVisible(frustum, wmin, wmax)) visible++;
+			}
+			sink = sink + visible;
+		}));
+
+		vector<DrawPacket> draws(objects);
+		report("sortDraws", objects, measure(REPEATS, [&] {
+			for (size_t i = 0; i < objects; i++)
+				draws[i].sortKey = makeSortKey(static_cast<GLuint>(i * 2654435761u % 64), static_cast<float>((i * 40503u) % 1000));
+		}, [&] {
+			sortDraws(draws);
+		}));
+	}
+
+	if (out) {
+		FILE* f = fopen(out, "w");
+		if (!f) {
+			fprintf(stderr, "No se puede escribir %s\n", out);
+			return 1;
+		}
+		fprintf(f, "[\n");
+		for (size_t i = 0; i < results.size(); i++) {
+			fprintf(f, "  { \"stage\": \"%s\", \"size\": %zu, \"ms\": %.4f }%s\n",
+				results[i].stage, results[i].size, results[i].ms, i + 1 < results.size() ? "," : "");
+		}
+		fprintf(f, "]\n");
+		fclose(f);
+	}
+	return 0;
+}
+
+int Benchmark::runScene(size_t entities)
+{
+	const int REPEATS = 5;
+	const int maxThreads = static_cast<int>(thread::hardware_concurrency()) > 0 ? static_cast<int>(thread::hardware_concurrency()) : 1;
+
+	// Malla sin objetos GL: solo hace falta para las bounds y el lookup del handle
+	MeshData cube;
+	cube.boundsMin = glm::vec3(-0.5f);
+	cube.boundsMax = glm::vec3(0.5f);
+	const MeshHandle mesh = Resources::meshes.insert(cube);
+
+	Scene scene;
+	const auto c0 = hrclock::now();
+	scene.transforms.reserve(entities);
+	scene.renderers.reserve(entities);
+	scene.bounds.reserve(entities);
+	scene.materials.reserve(entities);
+	const int side = max(1, static_cast<int>(cbrt(static_cast<double>(entities))));
+	for (size_t i = 0; i < entities; i++) {
+		Transform t;
+		t.position = glm::vec3(i % side, (i / side) % side, i / (side * side)) * 2.0f - glm::vec3(static_cast<float>(side));
+		t.rotation = glm::vec3(static_cast<float>(i % 360));
+		scene.spawnMesh(mesh, t);
+	}
+	const double createMs = elapsedMs(c0);
+	printf("%zu entidades creadas en %.2f ms\n", entities, createMs);
+
+	const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 1000.0f);
+	const glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -static_cast<float>(side) * 2.0f));
+	const Frustum frustum = extractFrustum(projection * view);
+	FramePacket packet;
+
+	printf("threads  %-18s %10s  %10s\n", "sistema", "mejor(ms)", "M ent/s");
+	for (int threads : { 1, maxThreads }) {
+		JobSystem::init(threads);
+		auto report = [threads, entities](const char* system, double ms) {
+			printf("%7d  %-18s %10.3f  %10.2f\n", threads, system, ms, entities / (ms * 1000.0));
+		};
+
+		report("iterate", measure(REPEATS, [] {}, [&scene] {
+			// Recorrido denso puro, sin trabajo: limite de ancho de banda
+			glm::vec3 sum(0.0f);
+			for (size_t i = 0; i < scene.transforms.size(); i++) sum += scene.transforms.at(i).position;
+			sink = sink + static_cast<size_t>(sum.x);
+		}));
+		report("updateTransforms", measure(REPEATS, [] {}, [&scene] { SceneSystems::updateTransforms(scene); }));
+		report("updateBounds", measure(REPEATS, [] {}, [&scene] { SceneSystems::updateBounds(scene); }));
+		report("extractDraws", measure(REPEATS, [&packet] { packet.reset(0); }, [&] {
+			SceneSystems::extractDraws(scene, frustum, view, packet);
+			sink = sink + packet.draws.size();
+		}));
+
+		// Altas y bajas: destruye y recrea un 10% de las entidades
+		report("destroy+spawn 10%", measure(REPEATS, [] {}, [&scene, mesh, entities] {
+			for (size_t i = 0; i < entities / 10; i++) {
+				scene.destroy(scene.transforms.entityAt(i * 7 % scene.transforms.size()));
+				scene.spawnMesh(mesh);
+			}
+		}));
+		JobSystem::shutdown();
+	}
+
+	scene.clear();
+	Resources::meshes.remove(mesh);
+	return 0;
+}
+
+int Benchmark::runSceneFile(size_t entities)
+{
+	const int REPEATS = 5;
+	if (entities == 0) entities = 1;
+
+	// Dos mallas y un material sin objetos GL: la carga las encuentra por hash
+	MeshHandle meshes[2];
+	for (int m = 0; m < 2; m++) {
+		MeshData mesh;
+		mesh.boundsMin = glm::vec3(-0.5f - m);
+		mesh.boundsMax = glm::vec3(0.5f + m);
+		mesh.contentHash = 0x5EED0000ull + m;
+		meshes[m] = Resources::meshes.insert(mesh);
+	}
+	Material tinted;
+	tinted.color = glm::vec4(0.8f, 0.2f, 0.2f, 1.0f);
+	const MaterialHandle material = Resources::materials.insert(tinted);
+
+	Scene scene;
+	scene.reserve(entities);
+	for (size_t i = 0; i < entities; i++) {
+		Transform t;
+		t.position = glm::vec3(static_cast<float>(i % 100), static_cast<float>(i / 100 % 100), static_cast<float>(i / 10000));
+		t.rotation = glm::vec3(static_cast<float>(i % 360), 0.0f, static_cast<float>(i % 90));
+		t.scale = glm::vec3(1.0f + (i % 3) * 0.5f);
+		const Entity entity = scene.spawnMesh(meshes[i % 2], t);
+		scene.materials.add(entity, { material });
+	}
+	SimState camera;
+	camera.rotationX = 12.5f;
+	camera.zoomLevel = -40.0f;
+	camera.cameraOffsetY = 3.0f;
+
+	const string path = (filesystem::temp_directory_path() / "oyuki_bench_scene.oysc").string();
+	const auto s0 = hrclock::now();
+	if (!SceneFile::save(path.c_str(), scene, camera)) return 1;
+	const double saveMs = elapsedMs(s0);
+	const double fileMb = filesystem::file_size(path) / (1024.0 * 1024.0);
+
+	Scene loaded;
+	SimState loadedCamera;
+	double best = 1e30;
+	for (int r = 0; r < REPEATS; r++) {
+		SceneLoadStats stats;
+		if (!SceneFile::load(path.c_str(), loaded, loadedCamera, &stats)) return 1;
+		best = min(best, stats.ms);
+	}
+	filesystem::remove(path);
+
+	int failures = 0;
+	if (loaded.entityCount() != scene.entityCount() || loaded.transforms.size() != scene.transforms.size()) failures++;
+	for (size_t i = 0; !failures && i < scene.transforms.size(); i++) {
+		const Transform& a = scene.transforms.at(i);
+		const Transform& b = loaded.transforms.at(i);
+		const MeshRenderer* ra = scene.renderers.get(scene.transforms.entityAt(i));
+		const MeshRenderer* rb = loaded.renderers.get(loaded.transforms.entityAt(i));
+		const MaterialRef* ma = scene.materials.get(scene.transforms.entityAt(i));
+		const MaterialRef* mb = loaded.materials.get(loaded.transforms.entityAt(i));
+		if (a.position != b.position || a.rotation != b.rotation || a.scale != b.scale || !rb || ra->mesh != rb->mesh
+			|| !mb || ma->material != mb->material) {
+			fprintf(stderr, "La entidad %zu no coincide tras cargar\n", i);
+			failures++;
+		}
+	}
+	if (loadedCamera.rotationX != camera.rotationX || loadedCamera.zoomLevel != camera.zoomLevel
+		|| loadedCamera.cameraOffsetY != camera.cameraOffsetY) {
+		fprintf(stderr, "La camara no coincide tras cargar\n");
+		failures++;
+	}
+
+	printf("%zu entidades, %.2f MB\n", entities, fileMb);
+	printf("guardar %10.3f ms\n", saveMs);
+	printf("cargar  %10.3f ms (mejor de %d)  %.2f M ent/s  %s\n", best, REPEATS, entities / (best * 1000.0),
+		best < 100.0 ? "< 100 ms" : ">= 100 ms");
+
+	for (const MeshHandle mesh : meshes) Resources::meshes.remove(mesh);
+	Resources::materials.remove(material);
+	return failures ? 1 : 0;
+}
+
+int Benchmark::runSimd(size_t count)
+{
+	const int REPEATS = 5;
+	if (count == 0) count = 1;
+
+	// Datos deterministas: matrices TRS, cajas alrededor del origen y un flujo de vertices
+	vector<glm::mat4> a(count), b(count), product(count), reference(count);
+	vector<glm::vec3> localMin(count), localMax(count), worldMin(count), worldMax(count);
+	vector<glm::vec3> refMin(count), refMax(count);
+	for (size_t i = 0; i < count; i++) {
+		const float f = static_cast<float>(i);
+		a[i] = glm::translate(glm::mat4(1.0f), glm::vec3(sinf(f) * 50.0f, cosf(f * 0.7f) * 50.0f, sinf(f * 0.3f) * 50.0f));
+		a[i] = glm::rotate(a[i], f * 0.01f, glm::normalize(glm::vec3(1.0f, f * 0.1f + 1.0f, 0.5f)));
+		a[i] = glm::scale(a[i], glm::vec3(1.0f + (i % 7) * 0.25f));
+		b[i] = glm::rotate(glm::mat4(1.0f), f * 0.02f, glm::vec3(0.0f, 1.0f, 0.0f));
+		localMin[i] = glm::vec3(-0.5f - (i % 3), -1.0f, -0.25f * (i % 5) - 0.1f);
+		localMax[i] = glm::vec3(0.5f, 1.0f + (i % 4), 0.75f);
+	}
+	const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 200.0f);
+	const glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -60.0f));
+	const Frustum frustum = extractFrustum(projection * view);
+
+	vector<float> soa(count * 6);
+	const SimdMath::AabbSoA boxes = { &soa[0], &soa[count], &soa[count * 2], &soa[count * 3], &soa[count * 4], &soa[count * 5] };
+	vector<unsigned char> visible(count), refVisible(count);
+
+	const size_t floats = count * 3;
+	vector<float> stream(floats), scaledFloats(floats);
+	vector<double> scaledDoubles(floats);
+	for (size_t i = 0; i < floats; i++) stream[i] = sinf(i * 0.37f) * 100.0f;
+	const float SCALE = 0.01f;
+
+	// Referencias con glm/Culling (las mismas funciones que usaba el motor antes)
+	const double refMulMs = measure(REPEATS, [] {}, [&] {
+		for (size_t i = 0; i < count; i++) reference[i] = a[i] * b[i];
+	});
+	const double refAabbMs = measure(REPEATS, [] {}, [&] {
+		for (size_t i = 0; i < count; i++) transformBounds(a[i], localMin[i], localMax[i], refMin[i], refMax[i]);
+	});
+	for (size_t i = 0; i < count; i++) {
+		soa[i] = refMin[i].x; soa[count + i] = refMin[i].y; soa[count * 2 + i] = refMin[i].z;
+		soa[count * 3 + i] = refMax[i].x; soa[count * 4 + i] = refMax[i].y; soa[count * 5 + i] = refMax[i].z;
+	}
+	const double refCullMs = measure(REPEATS, [] {}, [&] {
+		for (size_t i = 0; i < count; i++) refVisible[i] = isVisible(frustum, refMin[i], refMax[i]);
+	});
+	const double refStreamMs = measure(REPEATS, [] {}, [&] {
+		for (size_t i = 0; i < floats; i++) scaledDoubles[i] = static_cast<double>(stream[i] * SCALE);
+	});
+	glm::vec3 refBoundsMin(stream[0], stream[1], stream[2]), refBoundsMax = refBoundsMin;
+	for (size_t i = 0; i < floats; i += 3) {
+		refBoundsMin = glm::min(refBoundsMin, glm::vec3(stream[i], stream[i + 1], stream[i + 2]));
+		refBoundsMax = glm::max(refBoundsMax, glm::vec3(stream[i], stream[i + 1], stream[i + 2]));
+	}
+	const vector<double> refDoubles = scaledDoubles;
+
+	// La cuantizacion no tiene equivalente en glm: la referencia es el nivel escalar
+	const SimdLevel previous = SimdMath::level();
+	vector<float> unitStream(floats);
+	for (size_t i = 0; i < floats; i++) unitStream[i] = stream[i] * SCALE;
+	vector<uint32_t> packed(count), refNormals(count), refTexCoords(count);
+	SimdMath::setLevel(SimdLevel::Scalar);
+	SimdMath::packNormals(unitStream.data(), count, refNormals.data());
+	SimdMath::packTexCoords(unitStream.data(), count, refTexCoords.data());
+	const double refNormalsMs = measure(REPEATS, [] {}, [&] { SimdMath::packNormals(unitStream.data(), count, packed.data()); });
+	const double refTexCoordsMs = measure(REPEATS, [] {}, [&] { SimdMath::packTexCoords(unitStream.data(), count, packed.data()); });
+
+	size_t refVisibleCount = 0;
+	for (unsigned char v : refVisible) refVisibleCount += v;
+	printf("%zu elementos, %zu cajas visibles, CPU: %s\n", count, refVisibleCount, SimdMath::levelName(SimdMath::detect()));
+	printf("%-8s %-15s %10s  %8s\n", "nivel", "kernel", "mejor(ms)", "vs ref");
+	auto report = [](const char* level, const char* kernel, double ms, double refMs) {
+		printf("%-8s %-15s %10.3f  %7.2fx\n", level, kernel, ms, refMs / ms);
+	};
+	report("glm", "multiplyMat4", refMulMs, refMulMs);
+	report("glm", "transformAabbs", refAabbMs, refAabbMs);
+	report("glm", "cullAabbs", refCullMs, refCullMs);
+	report("glm", "scaleToDouble", refStreamMs, refStreamMs);
+
+	int failures = 0;
+	for (SimdLevel lvl : { SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2 }) {
+		if (lvl > SimdMath::detect()) break;
+		SimdMath::setLevel(lvl);
+		const char* name = SimdMath::levelName(lvl);
+
+		const double mulMs = measure(REPEATS, [] {}, [&] { SimdMath::multiplyMat4(a.data(), b.data(), product.data(), count); });
+		const double aabbMs = measure(REPEATS, [] {}, [&] {
+			SimdMath::transformAabbs(a.data(), localMin.data(), localMax.data(), worldMin.data(), worldMax.data(), count);
+		});
+		const double cullMs = measure(REPEATS, [] {}, [&] { SimdMath::cullAabbs(frustum, boxes, count, visible.data()); });
+		const double streamMs = measure(REPEATS, [] {}, [&] { SimdMath::scaleToDouble(stream.data(), floats, SCALE, scaledDoubles.data()); });
+		SimdMath::scaleFloats(stream.data(), floats, SCALE, scaledFloats.data());
+		glm::vec3 boundsMin, boundsMax;
+		SimdMath::pointBounds(stream.data(), count, boundsMin, boundsMax);
+		report(name, "multiplyMat4", mulMs, refMulMs);
+		report(name, "transformAabbs", aabbMs, refAabbMs);
+		report(name, "cullAabbs", cullMs, refCullMs);
+		report(name, "scaleToDouble", streamMs, refStreamMs);
+
+		size_t packErrors = 0;
+		report(name, "packNormals", measure(REPEATS, [] {}, [&] { SimdMath::packNormals(unitStream.data(), count, packed.data()); }), refNormalsMs);
+		if (packed != refNormals) packErrors++;
+		report(name, "packTexCoords", measure(REPEATS, [] {}, [&] { SimdMath::packTexCoords(unitStream.data(), count, packed.data()); }), refTexCoordsMs);
+		if (packed != refTexCoords) packErrors++;
+
+		// FMA cambia el redondeo del producto de matrices: tolerancia relativa
+		size_t mulErrors = 0, aabbErrors = 0, cullErrors = 0, streamErrors = 0;
+		for (size_t i = 0; i < count; i++) {
+			for (int c = 0; c < 4; c++) {
+				for (int r = 0; r < 4; r++) {
+					if (fabsf(product[i][c][r] - reference[i][c][r]) > 1e-5f * max(1.0f, fabsf(reference[i][c][r]))) {
+						mulErrors++;
+						c = 4;
+						break;
+					}
+				}
+			}
+			if (worldMin[i] != refMin[i] || worldMax[i] != refMax[i]) aabbErrors++;
+			if (visible[i] != refVisible[i]) cullErrors++;
+		}
+		for (size_t i = 0; i < floats; i++) {
+			if (scaledDoubles[i] != refDoubles[i] || scaledFloats[i] != stream[i] * SCALE) streamErrors++;
+		}
+		if (boundsMin != refBoundsMin || boundsMax != refBoundsMax) streamErrors++;
+
+		if (mulErrors + aabbErrors + cullErrors + streamErrors + packErrors > 0) {
+			printf("%-8s ERROR: %zu matrices, %zu cajas, %zu visibilidades, %zu valores de vertices, %zu flujos cuantizados no coinciden\n",
+				name, mulErrors, aabbErrors, cullErrors, streamErrors, packErrors);
+			failures++;
+		}
+	}
+	SimdMath::setLevel(previous);
+	printf(failures ? "Resultados SIMD incorrectos\n" : "Todos los niveles coinciden con la referencia\n");
+	return failures ? 1 : 0;
+}
+
+int Benchmark::runImport(const char* model, int runs, const char* io)
+{
+	vector<ImportIO> modes;
+	for (const ImportIO mode : { ImportIO::Stdio, ImportIO::Mapped, ImportIO::Memory }) {
+		if (!io || strcmp(io, AssimpIO::ioName(mode)) == 0) modes.push_back(mode);
+	}
+	if (modes.empty()) {
+		fprintf(stderr, "Modo de lectura desconocido: %s (stdio, mmap o memory)\n", io);
+		return 1;
+	}
+	runs = max(1, runs);
+
+	JobSystem::init();
+	const bool canReset = resetPeakMemory();
+	if (modes.size() > 1 && !canReset)
+		printf("Aviso: el pico de memoria es de todo el proceso; usa --io para medir cada modo por separado\n");
+
+	printf("%s, %d importaciones por modo\n", model, runs);
+	printf("%-8s %12s %12s %12s %14s %14s\n", "io", "primera(ms)", "mejor(ms)", "media(ms)", "pico RSS(MB)", "sobre base(MB)");
+	int failures = 0;
+	vector<uint64_t> reference;
+	for (const ImportIO mode : modes) {
+		resetPeakMemory();
+		const size_t baseline = procStatusBytes("VmRSS:");
+		double first = 0.0, best = 1e30, total = 0.0;
+		vector<uint64_t> hashes;
+		for (int r = 0; r < runs; r++) {
+			const auto t0 = hrclock::now();
+			ImportedModel imported = importFBX(model, mode);
+			const double ms = elapsedMs(t0);
+			if (r == 0) first = ms;
+			best = min(best, ms);
+			total += ms;
+
+			hashes.clear();
+			for (const auto& meshData : imported.meshes) {
+				hashes.push_back(meshData.contentHash);
+				MemoryTracker::remove(MemTag::MeshCPU, meshData.cpuBytes);
+			}
+			if (hashes.empty()) break;
+		}
+		if (hashes.empty()) {
+			fprintf(stderr, "%s: no se pudo importar %s\n", AssimpIO::ioName(mode), model);
+			failures++;
+			continue;
+		}
+
+		const size_t peak = peakResidentBytes();
+		const double mb = 1024.0 * 1024.0;
+		printf("%-8s %12.2f %12.2f %12.2f %14.1f %14.1f\n", AssimpIO::ioName(mode), first, best, total / runs,
+			peak / mb, baseline && peak > baseline ? (peak - baseline) / mb : 0.0);
+
+		// Todas las formas de leer tienen que dar exactamente las mismas mallas
+		if (reference.empty()) reference = hashes;
+		else if (hashes != reference) {
+			fprintf(stderr, "%s: las mallas no coinciden con %s\n", AssimpIO::ioName(mode), AssimpIO::ioName(modes[0]));
+			failures++;
+		}
+	}
+	JobSystem::shutdown();
+	return failures ? 1 : 0;
+}
+
+int Benchmark::runPicking(size_t triangles)
+{
+	const int RAYS = 10000;
+	const int VALIDATED = 256;     // rayos comprobados contra fuerza bruta
+	const int SCENE_RAYS = 1000;
+	const int SCENE_SIDE = 10;     // 10 x 10 x 10 copias
+	if (triangles < 8) triangles = 8;
+	JobSystem::init();
+
+	MeshData mesh;
+	makeBumpySphere(triangles, mesh.vertices, mesh.triangles);
+	mesh.boundsMin = mesh.boundsMax = mesh.vertices[0];
+	for (const glm::vec3& v : mesh.vertices) {
+		mesh.boundsMin = glm::min(mesh.boundsMin, v);
+		mesh.boundsMax = glm::max(mesh.boundsMax, v);
+	}
+	const auto b0 = hrclock::now();
+	mesh.bvh.build(mesh.vertices, mesh.triangles);
+	const double buildMs = elapsedMs(b0);
+	printf("%zu triangulos, CPU: %s, %d hilos\n", mesh.triangles.size(), SimdMath::levelName(SimdMath::detect()), JobSystem::workerCount());
+	printf("construccion %10.2f ms  %zu nodos, profundidad %d, %.1f MB\n", buildMs, mesh.bvh.nodeCount(), mesh.bvh.depth(),
+		mesh.bvh.bytes() / (1024.0 * 1024.0));
+
+	// Desde una esfera de radio 3 hacia puntos cerca del centro; los que pasan de 1 pueden fallar
+	vector<glm::vec3> origins(RAYS), directions(RAYS);
+	unsigned int seed = 12345;
+	auto random = [&seed]() {
+		seed = seed * 1664525u + 1013904223u;
+		return (seed >> 8) / 16777216.0f;
+	};
+	for (int i = 0; i < RAYS; i++) {
+		const float theta = random() * 3.14159265f, phi = random() * 6.28318531f;
+		origins[i] = glm::vec3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi)) * 3.0f;
+		const glm::vec3 target = (glm::vec3(random(), random(), random()) * 2.0f - 1.0f) * 1.2f;
+		directions[i] = glm::normalize(target - origins[i]);
+	}
+
+	int failures = 0;
+	vector<BvhHit> reference(VALIDATED);
+	vector<char> referenceHit(VALIDATED);
+	const auto r0 = hrclock::now();
+	for (int i = 0; i < VALIDATED; i++) referenceHit[i] = bruteForceRay(mesh.vertices, mesh.triangles, origins[i], directions[i], reference[i]);
+	printf("fuerza bruta %10.3f ms por rayo\n", elapsedMs(r0) / VALIDATED);
+
+	const SimdLevel previous = SimdMath::level();
+	for (SimdLevel lvl : { SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2 }) {
+		if (lvl > SimdMath::detect()) break;
+		SimdMath::setLevel(lvl);
+		size_t hits = 0, errors = 0;
+		double maxUs = 0.0;
+		const auto t0 = hrclock::now();
+		for (int i = 0; i < RAYS; i++) {
+			const auto s0 = hrclock::now();
+			BvhHit hit;
+			const bool found = mesh.bvh.intersect(origins[i], directions[i], numeric_limits<float>::infinity(), hit);
+			maxUs = max(maxUs, elapsedMs(s0) * 1000.0);
+			hits += found;
+			if (i >= VALIDATED) continue;
+			// En una arista compartida los dos triangulos dan la misma distancia
+			if (found != (referenceHit[i] != 0) || (found && hit.triangle != reference[i].triangle
+				&& fabsf(hit.distance - reference[i].distance) > 1e-5f * reference[i].distance)) errors++;
+		}
+		const double totalMs = elapsedMs(t0);
+		printf("%-8s %8.2f us por rayo (max %.2f us)  %zu de %d aciertan\n", SimdMath::levelName(lvl), totalMs * 1000.0 / RAYS, maxUs, hits, RAYS);
+		if (errors) {
+			printf("%-8s ERROR: %zu de %d rayos no coinciden con la fuerza bruta\n", SimdMath::levelName(lvl), errors, VALIDATED);
+			failures++;
+		}
+	}
+	SimdMath::setLevel(previous);
+
+	// Escena con 1000 copias de la malla (sin objetos GL) y rayos desde la camara
+	const MeshHandle handle = Resources::meshes.insert(move(mesh));
+	Scene scene;
+	for (int i = 0; i < SCENE_SIDE * SCENE_SIDE * SCENE_SIDE; i++) {
+		Transform t;
+		t.position = glm::vec3(i % SCENE_SIDE, i / SCENE_SIDE % SCENE_SIDE, i / (SCENE_SIDE * SCENE_SIDE)) * 3.0f;
+		t.rotation = glm::vec3(static_cast<float>(i * 37 % 360), static_cast<float>(i * 11 % 360), 0.0f);
+		t.scale = glm::vec3(0.5f + (i % 4) * 0.25f);
+		scene.spawnMesh(handle, t);
+	}
+	SceneSystems::updateTransforms(scene);
+	SceneSystems::updateBounds(scene);
+
+	const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 1000.0f);
+	const glm::mat4 view = glm::lookAt(glm::vec3(-20.0f, 35.0f, -25.0f), glm::vec3(13.5f), glm::vec3(0.0f, 1.0f, 0.0f));
+	const glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+	size_t sceneHits = 0, sceneErrors = 0;
+	double sceneMaxUs = 0.0, sceneTotalMs = 0.0;
+	for (int i = 0; i < SCENE_RAYS; i++) {
+		glm::vec3 origin, direction;
+		Picking::screenRay(static_cast<int>(random() * 512), static_cast<int>(random() * 512), 512, 512, inverseViewProjection, origin, direction);
+		const auto s0 = hrclock::now();
+		PickHit hit;
+		const bool found = Picking::pick(scene, origin, direction, hit);
+		const double ms = elapsedMs(s0);
+		sceneTotalMs += ms;
+		sceneMaxUs = max(sceneMaxUs, ms * 1000.0);
+		sceneHits += found;
+		if (i >= VALIDATED / 4) continue;
+
+		// Referencia: todas las entidades, sin ordenar ni cortar por las cajas
+		float best = numeric_limits<float>::max();
+		for (size_t e = 0; e < scene.transforms.size(); e++) {
+			const glm::mat4 toLocal = glm::inverse(scene.transforms.at(e).world);
+			BvhHit local;
+			if (Resources::meshes.get(handle)->bvh.intersect(glm::vec3(toLocal * glm::vec4(origin, 1.0f)),
+				glm::vec3(toLocal * glm::vec4(direction, 0.0f)), best, local)) best = local.distance;
+		}
+		const bool referenceFound = best < numeric_limits<float>::max();
+		if (found != referenceFound || (found && fabsf(hit.distance - best) > 1e-4f * best)) sceneErrors++;
+	}
+	printf("escena    %8.2f us por pick (max %.2f us)  %zu de %d aciertan, %d entidades\n", sceneTotalMs * 1000.0 / SCENE_RAYS,
+		sceneMaxUs, sceneHits, SCENE_RAYS, SCENE_SIDE * SCENE_SIDE * SCENE_SIDE);
+	if (sceneErrors) {
+		printf("escena   ERROR: %zu de %d picks no coinciden con la referencia\n", sceneErrors, VALIDATED / 4);
+		failures++;
+	}
+
+	scene.clear();
+	Resources::meshes.remove(handle);
+	JobSystem::shutdown();
+	printf(failures ? "Resultados de picking incorrectos\n" : "Todos los rayos coinciden con la referencia\n");
+	return failures ? 1 : 0;
+}
+
+int Benchmark::runRaster(size_t triangles)
+{
+	const int WIDTH = 512;
+	const int HEIGHT = 512;
+	const int FRAMES = 10;
+	const int SIDE = 4; // 4 x 4 copias de la esfera
+	const int TEXTURE_SIZE = 256;
+	if (triangles < SIDE * SIDE * 8) triangles = SIDE * SIDE * 8;
+	const int maxThreads = max(1, static_cast<int>(thread::hardware_concurrency()));
+	JobSystem::init();
+
+	// UV por angulos repetidas varias veces y una textura de cuadros: la imagen
+	// depende de la interpolacion con perspectiva y del REPEAT
+	MeshData mesh;
+	makeBumpySphere(triangles / (SIDE * SIDE), mesh.vertices, mesh.triangles);
+	mesh.boundsMin = mesh.boundsMax = mesh.vertices[0];
+	for (const glm::vec3& v : mesh.vertices) {
+		mesh.boundsMin = glm::min(mesh.boundsMin, v);
+		mesh.boundsMax = glm::max(mesh.boundsMax, v);
+		const float u = atan2f(v.z, v.x) / 6.28318531f + 0.5f;
+		const float w = acosf(glm::clamp(v.y / glm::length(v), -1.0f, 1.0f)) / 3.14159265f;
+		mesh.texCoordsFloat.push_back(glm::vec2(u * 8.0f, w * 4.0f)); // pasan de HALF_TEXCOORD_LIMIT
+	}
+	DecodedImage checker;
+	checker.width = checker.height = TEXTURE_SIZE;
+	checker.rgba.resize(static_cast<size_t>(TEXTURE_SIZE) * TEXTURE_SIZE * 4);
+	for (int y = 0; y < TEXTURE_SIZE; y++) {
+		for (int x = 0; x < TEXTURE_SIZE; x++) {
+			unsigned char* p = &checker.rgba[(static_cast<size_t>(y) * TEXTURE_SIZE + x) * 4];
+			const bool dark = ((x / 32) ^ (y / 32)) & 1;
+			p[0] = dark ? 40 : 230;
+			p[1] = static_cast<unsigned char>(x);
+			p[2] = static_cast<unsigned char>(y);
+			p[3] = 255;
+		}
+	}
+	const TextureHandle texture = insertTextureCpu(checker);
+	const MaterialHandle material = Resources::materials.insert({ texture });
+	mesh.material = material;
+	const size_t meshTriangles = mesh.triangles.size();
+	const MeshHandle handle = Resources::meshes.insert(move(mesh));
+
+	Scene scene;
+	for (int i = 0; i < SIDE * SIDE; i++) {
+		Transform t;
+		t.position = glm::vec3(i % SIDE - (SIDE - 1) * 0.5f, i / SIDE - (SIDE - 1) * 0.5f, 0.0f) * 1.1f;
+		t.rotation = glm::vec3(static_cast<float>(i * 37 % 360), static_cast<float>(i * 11 % 360), 0.0f);
+		t.scale = glm::vec3(0.6f);
+		scene.spawnMesh(handle, t);
+	}
+	SceneSystems::updateTransforms(scene);
+	SceneSystems::updateBounds(scene);
+
+	Camera camera(45.0f, WIDTH, HEIGHT);
+	SimState pose;
+	pose.zoomLevel = -6.0f;
+	pose.rotationX = 20.0f;
+	camera.setPose(pose);
+	FramePacket packet;
+	SceneSystems::extractDraws(scene, camera.frustum(), camera.view(), packet);
+	JobSystem::shutdown();
+
+	printf("%zu triangulos en %zu draws, %dx%d, tiles de %d, CPU: %s\n", meshTriangles * packet.draws.size(), packet.draws.size(),
+		WIDTH, HEIGHT, SoftwareRenderer::TILE_SIZE, SimdMath::levelName(SimdMath::detect()));
+	printf("threads  %-8s %10s  %10s  %10s  %s\n", "nivel", "mejor(ms)", "media(ms)", "M tri/s", "pixeles pintados");
+
+	// Todas las combinaciones tienen que dar la imagen exacta del primer render
+	int failures = 0;
+	vector<uint32_t> reference;
+	const SimdLevel previous = SimdMath::level();
+	for (int threads : { 1, maxThreads }) {
+		JobSystem::init(threads);
+		SoftwareRenderer renderer(WIDTH, HEIGHT);
+		for (SimdLevel lvl : { SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2 }) {
+			if (lvl > SimdMath::detect()) break;
+			SimdMath::setLevel(lvl);
+			renderer.draw(packet, camera); // el primero hace crecer los bins
+			double best = 1e30, total = 0.0;
+			for (int f = 0; f < FRAMES; f++) {
+				const auto t0 = hrclock::now();
+				renderer.draw(packet, camera);
+				const double ms = elapsedMs(t0);
+				best = min(best, ms);
+				total += ms;
+			}
+
+			vector<uint32_t> image;
+			image.reserve(static_cast<size_t>(WIDTH) * HEIGHT);
+			for (int y = 0; y < HEIGHT; y++) {
+				const uint32_t* row = renderer.pixels() + static_cast<size_t>(y) * (renderer.pitch() / 4);
+				image.insert(image.end(), row, row + WIDTH);
+			}
+			if (reference.empty()) reference = image;
+			size_t differing = 0, painted = 0;
+			for (size_t i = 0; i < image.size(); i++) {
+				differing += image[i] != reference[i];
+				painted += image[i] != image[0]; // la esquina es fondo
+			}
+			printf("%7d  %-8s %10.2f  %10.2f  %10.2f  %zu\n", threads, SimdMath::levelName(lvl), best, total / FRAMES,
+				meshTriangles * packet.draws.size() / (best * 1000.0), painted);
+			if (differing) {
+				printf("%7d  %-8s ERROR: %zu pixeles distintos del primer render\n", threads, SimdMath::levelName(lvl), differing);
+				failures++;
+			}
+		}
+		JobSystem::shutdown();
+	}
+	SimdMath::setLevel(previous);
+
+	scene.clear();
+	Resources::destroyMesh(handle);
+	Resources::destroyTexture(texture);
+	Resources::materials.remove(material);
+	printf(failures ? "Las imagenes no coinciden\n" : "Todas las imagenes coinciden\n");
+	return failures ? 1 : 0;
+}
+
+vector<Benchmark::CameraKey> Benchmark::loadCameraPath(const char* path, int frames)
+{
+	vector<CameraKey> keys;
+	if (path) {
+		FILE* f = fopen(path, "r");
+		if (!f) {
+			fprintf(stderr, "No se puede abrir el recorrido de camara %s\n", path);
+		}
+		else {
+			char line[256];
+			while (fgets(line, sizeof(line), f)) {
+				if (line[0] == '#') continue;
+				CameraKey k;
+				if (sscanf(line, "%d %f %f %f %f %f", &k.frame, &k.rotationX, &k.rotationY, &k.zoomLevel, &k.cameraOffsetX, &k.cameraOffsetY) == 6)
+					keys.push_back(k);
+			}
+			fclose(f);
+		}
+		sort(keys.begin(), keys.end(), [](const CameraKey& a, const CameraKey& b) { return a.frame < b.frame; });
+	}
+	if (keys.empty()) {
+		// Recorrido por defecto: una vuelta alrededor del modelo
+		CameraKey start, end;
+		start.rotationX = end.rotationX = 20.0f;
+		end.frame = max(1, frames - 1);
+		end.rotationY = 360.0f;
+		keys.push_back(start);
+		keys.push_back(end);
+	}
+	return keys;
+}
+
+Benchmark::CameraKey Benchmark::sampleCameraPath(const vector<CameraKey>& path, int frame)
+{
+	if (frame <= path.front().frame) return path.front();
+	if (frame >= path.back().frame) return path.back();
+
+	size_t i = 1;
+	while (path[i].frame < frame) i++;
+	const CameraKey& a = path[i - 1];
+	const CameraKey& b = path[i];
+	const float t = static_cast<float>(frame - a.frame) / (b.frame - a.frame);
+
+	CameraKey k;
+	k.frame = frame;
+	k.rotationX = a.rotationX + (b.rotationX - a.rotationX) * t;
+	k.rotationY = a.rotationY + (b.rotationY - a.rotationY) * t;
+	k.zoomLevel = a.zoomLevel + (b.zoomLevel - a.zoomLevel) * t;
+	k.cameraOffsetX = a.cameraOffsetX + (b.cameraOffsetX - a.cameraOffsetX) * t;
+	k.cameraOffsetY = a.cameraOffsetY + (b.cameraOffsetY - a.cameraOffsetY) * t;
+	return k;
+}
+
+Benchmark::FrameTimeStats Benchmark::computeFrameTimes(vector<double> frameMs)
+{
+	FrameTimeStats stats;
+	if (frameMs.empty()) return stats;
+
+	sort(frameMs.begin(), frameMs.end());
+	// Percentil por rango mas cercano
+	auto percentile = [&frameMs](double p) {
+		const size_t rank = static_cast<size_t>(ceil(p / 100.0 * frameMs.size()));
+		return frameMs[rank > 0 ? rank - 1 : 0];
+	};
+	double sum = 0.0;
+	for (double ms : frameMs) sum += ms;
+
+	stats.minMs = frameMs.front();
+	stats.maxMs = frameMs.back();
+	stats.meanMs = sum / frameMs.size();
+	stats.p50Ms = percentile(50.0);
+	stats.p95Ms = percentile(95.0);
+	stats.p99Ms = percentile(99.0);
+	return stats;
+}
+
+size_t Benchmark::peakMemoryBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return counters.PeakWorkingSetSize;
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+	return static_cast<size_t>(usage.ru_maxrss);
+#else
+	return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+bool Benchmark::writeReport(const HeadlessReport& report, const char* path)
+{
+	FILE* f = path ? fopen(path, "w") : stdout;
+	if (!f) {
+		fprintf(stderr, "No se puede escribir %s\n", path);
+		return false;
+	}
+	const FrameTimeStats& t = report.frameTimes;
+	fprintf(f, "{\n");
+	fprintf(f, "  \"model\": ");
+	writeJsonString(f, report.model);
+	fprintf(f, ",\n  \"renderer\": ");
+	writeJsonString(f, report.renderer);
+	fprintf(f, ",\n");
+	fprintf(f, "  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %d,\n", report.width, report.height, report.frames);
+	fprintf(f, "  \"load_ms\": %.3f,\n", report.loadMs);
+	fprintf(f, "  \"frame_ms\": { \"min\": %.3f, \"mean\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f },\n",
+		t.minMs, t.meanMs, t.p50Ms, t.p95Ms, t.p99Ms, t.maxMs);
+	fprintf(f, "  \"draw_calls_per_frame\": %.1f,\n", report.drawCallsPerFrame);
+	fprintf(f, "  \"triangles_per_frame\": %.0f,\n", report.trianglesPerFrame);
+	fprintf(f, "  \"heap_allocations_per_frame\": %.2f,\n", report.heapAllocationsPerFrame);
+	fprintf(f, "  \"peak_memory_bytes\": %zu,\n", report.peakMemory);
+	fprintf(f, "  \"memory\": ");
+	MemoryTracker::writeJson(f, "  ");
+	fprintf(f, ",\n  \"startup\": ");
+	Startup::writeJson(f, "  ");
+	fprintf(f, "\n");
+	fprintf(f, "}\n");
+	if (f != stdout) fclose(f);
+	return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Benchmarks que se lanzan desde la linea de comandos (sin abrir ventana)
+namespace Benchmark
+{
+	// Escalado del sistema de jobs de 1 a N hilos, comprobando los resultados
+	int runJobSystem();
+
+	// Etapas de carga y de extraccion sobre mallas sinteticas de 1K a maxTriangles
+	// triangulos. Con 'out' escribe tambien los resultados en JSON.
+	int runStages(size_t maxTriangles, const char* out);
+
+	// Recorrido y actualizacion de la escena ECS con 'entities' entidades, con 1 hilo y con todos
+	int runScene(size_t entities);
+
+	// Guarda y vuelve a cargar una escena de 'entities' entidades con SceneFile,
+	// comprobando que queda igual. Devuelve 1 si no coincide.
+	int runSceneFile(size_t entities);
+
+	// Kernels de SimdMath en cada nivel que soporta la CPU: comprueba que coinciden con
+	// glm/Culling (la cuantizacion, con el nivel escalar) y compara tiempos.
+	// Devuelve 1 si algun nivel no coincide.
+	int runSimd(size_t count);
+
+	// importFBX de 'model' con cada forma de leer el fichero (o solo 'io' si no es
+	// nullptr): tiempo de pared de 'runs' importaciones y pico de memoria residente.
+	// La primera solo es en frio para el primer modo. En Linux el pico se reinicia
+	// entre modos; en el resto es del proceso y conviene medir cada modo por separado.
+	// Devuelve 1 si falla la importacion o los modos no dan las mismas mallas.
+	int runImport(const char* model, int runs, const char* io);
+
+	// BVH de una esfera rugosa de 'triangles' triangulos: construccion, rayos en cada
+	// nivel SIMD comparados con fuerza bruta, y Picking::pick en una escena de 1000
+	// copias. Devuelve 1 si algun rayo no da el mismo triangulo que la referencia.
+	int runPicking(size_t triangles);
+
+	// Render por software de 16 copias de una esfera texturizada con 'triangles'
+	// triangulos en total, a 512x512, en cada nivel SIMD con 1 hilo y con todos.
+	// Devuelve 1 si alguna combinacion no da exactamente la misma imagen.
+	int runRaster(size_t triangles);
+
+	// Punto de control de la camara para el modo headless
+	struct CameraKey
+	{
+		int frame = 0;
+		float rotationX = 0.0f;
+		float rotationY = 0.0f;
+		float zoomLevel = -5.0f;
+		float cameraOffsetX = 0.0f;
+		float cameraOffsetY = 0.0f;
+	};
+
+	// Fichero de texto con una linea por punto: "frame rotX rotY zoom offsetX offsetY"
+	// (las lineas que empiezan por # se ignoran). Sin fichero: una vuelta completa.
+	std::vector<CameraKey> loadCameraPath(const char* path, int frames);
+	CameraKey sampleCameraPath(const std::vector<CameraKey>& path, int frame);
+
+	struct FrameTimeStats
+	{
+		double minMs = 0.0, meanMs = 0.0, maxMs = 0.0;
+		double p50Ms = 0.0, p95Ms = 0.0, p99Ms = 0.0;
+	};
+	FrameTimeStats computeFrameTimes(std::vector<double> frameMs);
+
+	// Pico de memoria residente del proceso, 0 si no se puede consultar
+	size_t peakMemoryBytes();
+
+	struct HeadlessReport
+	{
+		std::string model;
+		std::string renderer;
+		int width = 0, height = 0;
+		int frames = 0;
+		double loadMs = 0.0; // de la importacion a la subida, solapada con la creacion de la ventana
+		FrameTimeStats frameTimes;
+		double drawCallsPerFrame = 0.0;
+		double trianglesPerFrame = 0.0;
+		size_t peakMemory = 0;
+		double heapAllocationsPerFrame = 0.0; // operator new por frame sin contar el calentamiento
+	};
+	bool writeReport(const HeadlessReport& report, const char* path);
+}
@@ -0,0 +1,346 @@
+#include "Bvh.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "SimdMath.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+using namespace std;
+
+namespace
+{
+	const int BINS = 16;
+	const uint32_t MAX_LEAF_SIZE = 8;        // por encima siempre se parte
+	const float TRAVERSAL_COST = 1.0f;       // relativo a probar un triangulo
+	const uint32_t PARALLEL_THRESHOLD = 16384; // triangulos a partir de los que los dos hijos van en paralelo
+	const int MAX_BUILD_DEPTH = 48;          // a partir de aqui se parte por la mitad: acota la pila del recorrido
+	const int STACK_SIZE = 256;
+	const float INF = numeric_limits<float>::infinity();
+
+	struct Aabb
+	{
+		glm::vec3 min = glm::vec3(INF);
+		glm::vec3 max = glm::vec3(-INF);
+
+		void grow(const glm::vec3& p) { min = glm::min(min, p); max = glm::max(max, p); }
+		void grow(const Aabb& b) { min = glm::min(min, b.min); max = glm::max(max, b.max); }
+		float area() const
+		{
+			const glm::vec3 d = max - min;
+			return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+		}
+	};
+
+	// Arbol binario temporal; count > 0 en las hojas
+	struct BuildNode
+	{
+		Aabb box;
+		uint32_t child[2] = { 0, 0 };
+		uint32_t first = 0;
+		uint32_t count = 0;
+	};
+
+	struct BuildInput
+	{
+		const Aabb* boxes;
+		const glm::vec3* centroids;
+		uint32_t* ids;
+		bool parallel; // false: los dos hijos seguidos en este hilo
+	};
+
+	void buildRange(const BuildInput& in, vector<BuildNode>& nodes, uint32_t index, uint32_t first, uint32_t count, int depth)
+	{
+		Aabb box, centroidBox;
+		for (uint32_t i = first; i < first + count; i++) {
+			box.grow(in.boxes[in.ids[i]]);
+			centroidBox.grow(in.centroids[in.ids[i]]);
+		}
+		nodes[index].box = box;
+		nodes[index].first = first;
+		nodes[index].count = count;
+		if (count <= 1) return;
+
+		// SAH por cubos en los tres ejes
+		int bestAxis = -1, bestSplit = 0;
+		float bestCost = INF;
+		for (int axis = 0; axis < 3; axis++) {
+			const float extent = centroidBox.max[axis] - centroidBox.min[axis];
+			if (extent <= 0.0f) continue;
+			const float scale = BINS / extent;
+			Aabb bins[BINS];
+			uint32_t counts[BINS] = {};
+			for (uint32_t i = first; i < first + count; i++) {
+				const uint32_t id = in.ids[i];
+				const int b = min(BINS - 1, static_cast<int>((in.centroids[id][axis] - centroidBox.min[axis]) * scale));
+				counts[b]++;
+				bins[b].grow(in.boxes[id]);
+			}
+			float leftArea[BINS - 1];
+			uint32_t leftCount[BINS - 1];
+			Aabb accumulated;
+			uint32_t accumulatedCount = 0;
+			for (int b = 0; b < BINS - 1; b++) {
+				accumulated.grow(bins[b]);
+				accumulatedCount += counts[b];
+				leftArea[b] = accumulated.area();
+				leftCount[b] = accumulatedCount;
+			}
+			accumulated = Aabb();
+			accumulatedCount = 0;
+			for (int b = BINS - 1; b > 0; b--) {
+				accumulated.grow(bins[b]);
+				accumulatedCount += counts[b];
+				if (leftCount[b - 1] == 0 || accumulatedCount == 0) continue;
+				const float cost = leftArea[b - 1] * leftCount[b - 1] + accumulated.area() * accumulatedCount;
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = b;
+				}
+			}
+		}
+
+		uint32_t leftCount = count / 2; // si no hay un corte mejor (centroides iguales o arbol muy hondo)
+		if (bestAxis >= 0 && depth < MAX_BUILD_DEPTH) {
+			const float area = box.area();
+			const float splitCost = TRAVERSAL_COST + (area > 0.0f ? bestCost / area : bestCost);
+			if (count <= MAX_LEAF_SIZE && static_cast<float>(count) <= splitCost) return;
+			const float scale = BINS / (centroidBox.max[bestAxis] - centroidBox.min[bestAxis]);
+			const float origin = centroidBox.min[bestAxis];
+			const glm::vec3* centroids = in.centroids;
+			uint32_t* middle = partition(in.ids + first, in.ids + first + count, [=](uint32_t id) {
+				return min(BINS - 1, static_cast<int>((centroids[id][bestAxis] - origin) * scale)) < bestSplit;
+			});
+			const uint32_t split = static_cast<uint32_t>(middle - (in.ids + first));
+			if (split > 0 && split < count) leftCount = split;
+		}
+		else if (count <= MAX_LEAF_SIZE) {
+			return;
+		}
+
+		nodes[index].count = 0;
+		const uint32_t firsts[2] = { first, first + leftCount };
+		const uint32_t counts[2] = { leftCount, count - leftCount };
+		if (count < PARALLEL_THRESHOLD || !in.parallel) {
+			const uint32_t left = static_cast<uint32_t>(nodes.size());
+			nodes.emplace_back();
+			nodes.emplace_back();
+			nodes[index].child[0] = left;
+			nodes[index].child[1] = left + 1;
+			buildRange(in, nodes, left, firsts[0], counts[0], depth + 1);
+			buildRange(in, nodes, left + 1, firsts[1], counts[1], depth + 1);
+			return;
+		}
+
+		// Cada hijo en su propio vector y luego se copian detras recolocando los indices
+		vector<BuildNode> subtrees[2];
+		JobSystem::parallelFor(2, 1, [&in, &subtrees, &firsts, &counts, depth](size_t begin, size_t end) {
+			for (size_t s = begin; s < end; s++) {
+				subtrees[s].reserve(counts[s] / 2);
+				subtrees[s].emplace_back();
+				buildRange(in, subtrees[s], 0, firsts[s], counts[s], depth + 1);
+			}
+		});
+		for (int s = 0; s < 2; s++) {
+			const uint32_t base = static_cast<uint32_t>(nodes.size());
+			nodes[index].child[s] = base;
+			for (BuildNode node : subtrees[s]) {
+				if (node.count == 0) {
+					node.child[0] += base;
+					node.child[1] += base;
+				}
+				nodes.push_back(node);
+			}
+		}
+	}
+
+	// Sube nietos hasta tener 4 hijos (primero los de mas superficie). Devuelve la profundidad
+	int collapse(const vector<BuildNode>& tree, uint32_t index, vector<MeshBvh::Node>& out, uint32_t outIndex)
+	{
+		uint32_t kids[4];
+		int n = 0;
+		if (tree[index].count > 0) {
+			kids[n++] = index; // raiz que es hoja
+		}
+		else {
+			kids[n++] = tree[index].child[0];
+			kids[n++] = tree[index].child[1];
+		}
+		while (n < 4) {
+			int widest = -1;
+			float widestArea = -1.0f;
+			for (int k = 0; k < n; k++) {
+				if (tree[kids[k]].count > 0) continue;
+				const float area = tree[kids[k]].box.area();
+				if (area > widestArea) {
+					widestArea = area;
+					widest = k;
+				}
+			}
+			if (widest < 0) break;
+			const BuildNode& inner = tree[kids[widest]];
+			kids[widest] = inner.child[0];
+			kids[n++] = inner.child[1];
+		}
+
+		// Los huecos son una caja en +infinito: ningun rayo la corta
+		MeshBvh::Node node;
+		fill(begin(node.bounds), end(node.bounds), INF);
+		fill(begin(node.child), end(node.child), 0u);
+		fill(begin(node.count), end(node.count), 0u);
+		int depth = 1;
+		for (int k = 0; k < n; k++) {
+			const BuildNode& kid = tree[kids[k]];
+			for (int c = 0; c < 3; c++) {
+				node.bounds[c * 4 + k] = kid.box.min[c];
+				node.bounds[12 + c * 4 + k] = kid.box.max[c];
+			}
+			if (kid.count > 0) {
+				node.child[k] = kid.first;
+				node.count[k] = kid.count;
+				continue;
+			}
+			const uint32_t childIndex = static_cast<uint32_t>(out.size());
+			out.emplace_back();
+			node.child[k] = childIndex;
+			depth = max(depth, 1 + collapse(tree, kids[k], out, childIndex));
+		}
+		out[outIndex] = node;
+		return depth;
+	}
+}
+
+void MeshBvh::build(const vector<glm::vec3>& vertices, const vector<vector<unsigned int>>& triangles, bool parallel)
+{
+	PROFILE_FUNCTION();
+	clear();
+
+	vector<Aabb> boxes;
+	vector<glm::vec3> centroids;
+	vector<uint32_t> source; // indice en 'triangles' de cada triangulo valido
+	boxes.reserve(triangles.size());
+	centroids.reserve(triangles.size());
+	source.reserve(triangles.size());
+	for (size_t i = 0; i < triangles.size(); i++) {
+		const auto& t = triangles[i];
+		if (t.size() != 3 || t[0] >= vertices.size() || t[1] >= vertices.size() || t[2] >= vertices.size()) continue;
+		Aabb box;
+		for (const unsigned int index : t) box.grow(vertices[index]);
+		boxes.push_back(box);
+		centroids.push_back((box.min + box.max) * 0.5f);
+		source.push_back(static_cast<uint32_t>(i));
+	}
+	if (boxes.empty()) return;
+
+	const uint32_t count = static_cast<uint32_t>(boxes.size());
+	vector<uint32_t> ids(count);
+	iota(ids.begin(), ids.end(), 0u);
+	vector<BuildNode> tree;
+	tree.reserve(count / 2);
+	tree.emplace_back();
+	buildRange({ boxes.data(), centroids.data(), ids.data(), parallel }, tree, 0, 0, count, 0);
+
+	_nodes.reserve(tree.size() / 3 + 1);
+	_nodes.emplace_back();
+	_depth = collapse(tree, 0, _nodes, 0);
+
+	// Triangulos en el orden de las hojas
+	_triangles.resize(static_cast<size_t>(count) * 3);
+	_triangleIds.resize(count);
+	for (uint32_t i = 0; i < count; i++) {
+		const uint32_t original = source[ids[i]];
+		const auto& t = triangles[original];
+		const glm::vec3 v0 = vertices[t[0]];
+		_triangles[i * 3] = v0;
+		_triangles[i * 3 + 1] = vertices[t[1]] - v0;
+		_triangles[i * 3 + 2] = vertices[t[2]] - v0;
+		_triangleIds[i] = original;
+	}
+}
+
+void MeshBvh::clear()
+{
+	_nodes = vector<Node>();
+	_triangles = vector<glm::vec3>();
+	_triangleIds = vector<uint32_t>();
+	_depth = 0;
+}
+
+size_t MeshBvh::bytes() const
+{
+	return _nodes.capacity() * sizeof(Node) + _triangles.capacity() * sizeof(glm::vec3) + _triangleIds.capacity() * sizeof(uint32_t);
+}
+
+bool MeshBvh::intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, BvhHit& hit) const
+{
+	if (_nodes.empty()) return false;
+
+	// Sin componentes a 0 en la inversa: evita 0 * infinito en la prueba de cajas
+	const float o[3] = { origin.x, origin.y, origin.z };
+	float inv[3];
+	for (int c = 0; c < 3; c++) {
+		const float d = fabsf(direction[c]) < 1e-20f ? copysignf(1e-20f, direction[c]) : direction[c];
+		inv[c] = 1.0f / d;
+	}
+
+	struct Entry
+	{
+		uint32_t node;
+		float distance;
+	};
+	Entry stack[STACK_SIZE];
+	int top = 0;
+	stack[top++] = { 0, 0.0f };
+	// Con maxDistance infinito las cajas de relleno (en +infinito) contarian como cortadas
+	float best = min(maxDistance, numeric_limits<float>::max());
+	bool found = false;
+
+	while (top > 0) {
+		const Entry entry = stack[--top];
+		if (entry.distance > best) continue; // se ha encontrado algo mas cerca desde que se apilo
+		const Node& node = _nodes[entry.node];
+		float tNear[4];
+		const int mask = SimdMath::rayAabb4(o, inv, node.bounds, best, tNear);
+
+		Entry inner[4];
+		int innerCount = 0;
+		for (int k = 0; k < 4; k++) {
+			if (!(mask & (1 << k))) continue;
+			if (node.count[k] == 0) {
+				inner[innerCount++] = { node.child[k], tNear[k] };
+				continue;
+			}
+			// Moller-Trumbore sin descartar caras traseras. Las comparaciones van negadas
+			// para que un NaN (matriz de mundo degenerada) no cuente como corte
+			for (uint32_t i = node.child[k]; i < node.child[k] + node.count[k]; i++) {
+				const glm::vec3& v0 = _triangles[i * 3];
+				const glm::vec3& e1 = _triangles[i * 3 + 1];
+				const glm::vec3& e2 = _triangles[i * 3 + 2];
+				const glm::vec3 p = glm::cross(direction, e2);
+				const float det = glm::dot(e1, p);
+				if (fabsf(det) < 1e-12f) continue;
+				const float invDet = 1.0f / det;
+				const glm::vec3 s = origin - v0;
+				const float u = glm::dot(s, p) * invDet;
+				if (!(u >= 0.0f && u <= 1.0f)) continue;
+				const glm::vec3 q = glm::cross(s, e1);
+				const float v = glm::dot(direction, q) * invDet;
+				if (!(v >= 0.0f && u + v <= 1.0f)) continue;
+				const float t = glm::dot(e2, q) * invDet;
+				if (!(t >= 0.0f && t < best)) continue;
+				best = t;
+				found = true;
+				hit.distance = t;
+				hit.triangle = _triangleIds[i];
+				hit.u = u;
+				hit.v = v;
+			}
+		}
+
+		// El mas cercano arriba de la pila
+		sort(inner, inner + innerCount, [](const Entry& a, const Entry& b) { return a.distance > b.distance; });
+		for (int k = 0; k < innerCount && top < STACK_SIZE; k++) stack[top++] = inner[k];
+	}
+	return found;
+}
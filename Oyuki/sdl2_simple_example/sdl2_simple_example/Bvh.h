@@ -0,0 +1,53 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Triangulo mas cercano que corta un rayo, en el espacio de la malla
+struct BvhHit
+{
+	float distance = 0.0f; // en unidades de la direccion del rayo (origen + direccion * distance)
+	uint32_t triangle = 0; // indice en MeshData::triangles
+	float u = 0.0f;        // baricentricas del punto: v0 * (1 - u - v) + v1 * u + v2 * v
+	float v = 0.0f;
+};
+
+// BVH de los triangulos de una malla para lanzar rayos (picking).
+// Se construye como arbol binario con SAH por cubos (16 por eje) y luego se
+// aplana a 4 hijos por nodo con las cajas en SoA, asi cada nodo se recorre con
+// una sola prueba SIMD de rayo contra 4 cajas (SimdMath::rayAabb4).
+// Las hojas apuntan a una copia de los triangulos (v0 y dos aristas) en el
+// orden del arbol; los subarboles grandes se construyen en paralelo.
+class MeshBvh {
+
+public:
+	struct Node
+	{
+		float bounds[24]; // minX[4], minY[4], minZ[4], maxX[4], maxY[4], maxZ[4]
+		uint32_t child[4]; // nodo interno, o primer triangulo si count > 0
+		uint32_t count[4]; // triangulos de la hoja; 0 en nodos internos y huecos
+	};
+
+private:
+	std::vector<Node> _nodes;
+	std::vector<glm::vec3> _triangles; // v0, v1 - v0, v2 - v0 por triangulo
+	std::vector<uint32_t> _triangleIds;
+	int _depth = 0;
+
+public:
+	// Ignora las caras que no son triangulos (puntos y lineas).
+	// parallel = false no lanza jobs (para hilos que no son workers, ver importFBX)
+	void build(const std::vector<glm::vec3>& vertices, const std::vector<std::vector<unsigned int>>& triangles, bool parallel = true);
+	void clear();
+
+	bool empty() const { return _nodes.empty(); }
+	size_t nodeCount() const { return _nodes.size(); }
+	size_t triangleCount() const { return _triangleIds.size(); }
+	int depth() const { return _depth; }
+	size_t bytes() const;
+
+	// Las dos caras cuentan. Si corta mas cerca que maxDistance rellena hit.
+	// direction no tiene por que ser unitaria (p. ej. un rayo de mundo pasado a local)
+	bool intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, BvhHit& hit) const;
+};
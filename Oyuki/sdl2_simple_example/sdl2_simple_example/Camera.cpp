@@ -0,0 +1,106 @@
+#include "Camera.h"
+#include "Picking.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+Camera::Camera(float fovDegrees, int width, int height, float nearPlane, float farPlane)
+	: _fovDegrees(fovDegrees), _near(nearPlane), _far(farPlane), _width(width > 0 ? width : 1), _height(height > 0 ? height : 1) {}
+
+void Camera::viewChanged() {
+	_viewDirty = true;
+	_combinedDirty = true;
+	_version++;
+}
+
+void Camera::projectionChanged() {
+	_projectionDirty = true;
+	_combinedDirty = true;
+	_version++;
+	_projectionVersion++;
+}
+
+void Camera::setPose(const SimState& pose) {
+	if (sameState(pose, _pose)) return;
+	_pose = pose;
+	viewChanged();
+}
+
+void Camera::orbit(float degreesX, float degreesY) {
+	PendingInput input;
+	input.rotateX = degreesX;
+	input.rotateY = degreesY;
+	apply(input);
+}
+
+void Camera::pan(float x, float y) {
+	PendingInput input;
+	input.panX = x;
+	input.panY = y;
+	apply(input);
+}
+
+void Camera::zoom(float delta) {
+	PendingInput input;
+	input.zoom = delta;
+	apply(input);
+}
+
+void Camera::apply(const PendingInput& input) {
+	setPose(applyInput(_pose, input));
+}
+
+void Camera::setViewport(int width, int height) {
+	// Minimizada SDL da 0: conservamos la ultima proyeccion valida
+	if (width <= 0 || height <= 0 || (width == _width && height == _height)) return;
+	_width = width;
+	_height = height;
+	projectionChanged();
+}
+
+void Camera::setFov(float degrees) {
+	if (degrees == _fovDegrees) return;
+	_fovDegrees = degrees;
+	projectionChanged();
+}
+
+const glm::mat4& Camera::view() const {
+	if (_viewDirty) {
+		_view = computeViewMatrix(_pose);
+		_viewDirty = false;
+	}
+	return _view;
+}
+
+const glm::mat4& Camera::projection() const {
+	if (_projectionDirty) {
+		_projection = glm::perspective(glm::radians(_fovDegrees), static_cast<float>(_width) / _height, _near, _far);
+		_projectionDirty = false;
+	}
+	return _projection;
+}
+
+void Camera::updateCombined() const {
+	if (!_combinedDirty) return;
+	_viewProjection = projection() * view();
+	_inverseViewProjection = glm::inverse(_viewProjection);
+	_frustum = extractFrustum(_viewProjection);
+	_combinedDirty = false;
+}
+
+const glm::mat4& Camera::viewProjection() const {
+	updateCombined();
+	return _viewProjection;
+}
+
+const glm::mat4& Camera::inverseViewProjection() const {
+	updateCombined();
+	return _inverseViewProjection;
+}
+
+const Frustum& Camera::frustum() const {
+	updateCombined();
+	return _frustum;
+}
+
+void Camera::screenRay(int x, int y, glm::vec3& origin, glm::vec3& direction) const {
+	Picking::screenRay(x, y, _width, _height, inverseViewProjection(), origin, direction);
+}
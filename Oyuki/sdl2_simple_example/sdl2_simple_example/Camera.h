@@ -0,0 +1,69 @@
+#pragma once
+#include "Culling.h"
+#include "Simulation.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+
+// Camara orbital con las matrices en cache.
+// Los cambios solo marcan lo que queda sucio (la vista o la proyeccion) y las
+// matrices y el frustum se recalculan la primera vez que se piden despues.
+// version() sube con cada cambio real: quien dependa de la camara (culling,
+// uniforms) guarda la version con la que trabajo y se lo salta si no ha cambiado.
+// Un redimensionado solo toca la proyeccion.
+// No es thread-safe: cada hilo usa su propia camara.
+class Camera {
+
+	SimState _pose;
+	float _fovDegrees = 45.0f;
+	float _near = 0.1f;
+	float _far = 100.0f;
+	int _width = 1;
+	int _height = 1;
+
+	uint64_t _version = 1;
+	uint64_t _projectionVersion = 1;
+
+	mutable bool _viewDirty = true;
+	mutable bool _projectionDirty = true;
+	mutable bool _combinedDirty = true; // viewProjection, su inversa y el frustum
+	mutable glm::mat4 _view = glm::mat4(1.0f);
+	mutable glm::mat4 _projection = glm::mat4(1.0f);
+	mutable glm::mat4 _viewProjection = glm::mat4(1.0f);
+	mutable glm::mat4 _inverseViewProjection = glm::mat4(1.0f);
+	mutable Frustum _frustum;
+
+	void viewChanged();
+	void projectionChanged();
+	void updateCombined() const;
+
+public:
+	Camera(float fovDegrees, int width, int height, float nearPlane = 0.1f, float farPlane = 100.0f);
+
+	// Pose completa (la de la simulacion); si es igual a la actual no ensucia nada
+	void setPose(const SimState& pose);
+	const SimState& pose() const { return _pose; }
+
+	// Controles con los mismos limites que la simulacion (applyInput)
+	void orbit(float degreesX, float degreesY);
+	void pan(float x, float y);
+	void zoom(float delta);
+	void apply(const PendingInput& input);
+
+	void setViewport(int width, int height);
+	void setFov(float degrees);
+	int width() const { return _width; }
+	int height() const { return _height; }
+	float fov() const { return _fovDegrees; }
+
+	const glm::mat4& view() const;
+	const glm::mat4& projection() const;
+	const glm::mat4& viewProjection() const;
+	const glm::mat4& inverseViewProjection() const;
+	const Frustum& frustum() const;
+
+	uint64_t version() const { return _version; }                     // vista o proyeccion
+	uint64_t projectionVersion() const { return _projectionVersion; } // solo proyeccion
+
+	// Rayo en mundo desde el pixel (x, y) del viewport, con y hacia abajo como SDL
+	void screenRay(int x, int y, glm::vec3& origin, glm::vec3& direction) const;
+};
@@ -0,0 +1,51 @@
+#include "Culling.h"
+#include <cmath>
+
+Frustum extractFrustum(const glm::mat4& m)
+{
+	// glm guarda por columnas: la fila i es (m[0][i], m[1][i], m[2][i], m[3][i])
+	const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+	const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+	const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+	const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+	Frustum f;
+	f.planes[0] = row3 + row0; // izquierda
+	f.planes[1] = row3 - row0; // derecha
+	f.planes[2] = row3 + row1; // abajo
+	f.planes[3] = row3 - row1; // arriba
+	f.planes[4] = row3 + row2; // cerca
+	f.planes[5] = row3 - row2; // lejos
+	for (auto& p : f.planes) {
+		const float len = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+		if (len > 0.0f) p = p / len;
+	}
+	return f;
+}
+
+void transformBounds(const glm::mat4& model, const glm::vec3& localMin, const glm::vec3& localMax,
+	glm::vec3& worldMin, glm::vec3& worldMax)
+{
+	// Metodo de Arvo: cada columna de la matriz contribuye con su minimo y su maximo
+	worldMin = worldMax = glm::vec3(model[3][0], model[3][1], model[3][2]);
+	for (int c = 0; c < 3; c++) {
+		for (int r = 0; r < 3; r++) {
+			const float a = model[c][r] * localMin[c];
+			const float b = model[c][r] * localMax[c];
+			worldMin[r] += a < b ? a : b;
+			worldMax[r] += a < b ? b : a;
+		}
+	}
+}
+
+bool isVisible(const Frustum& frustum, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	for (const auto& p : frustum.planes) {
+		// Vertice de la caja mas adelantado en la direccion de la normal
+		const float x = p.x >= 0.0f ? boundsMax.x : boundsMin.x;
+		const float y = p.y >= 0.0f ? boundsMax.y : boundsMin.y;
+		const float z = p.z >= 0.0f ? boundsMax.z : boundsMin.z;
+		if (p.x * x + p.y * y + p.z * z + p.w < 0.0f) return false;
+	}
+	return true;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// Frustum de la camara como 6 planos (ax + by + cz + d >= 0 dentro)
+struct Frustum
+{
+	glm::vec4 planes[6];
+};
+
+// Extrae los planos de proyeccion * vista (metodo de Gribb-Hartmann)
+Frustum extractFrustum(const glm::mat4& viewProjection);
+
+// AABB local transformada por una matriz de modelo (sigue siendo una AABB)
+void transformBounds(const glm::mat4& model, const glm::vec3& localMin, const glm::vec3& localMax,
+	glm::vec3& worldMin, glm::vec3& worldMax);
+
+bool isVisible(const Frustum& frustum, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
@@ -0,0 +1,27 @@
+#include "FixedTimestep.h"
+#include <cmath>
+
+FixedTimestep::FixedTimestep(double stepSeconds, int maxStepsPerFrame)
+	: _step(stepSeconds), _maxSteps(maxStepsPerFrame) {}
+
+int FixedTimestep::advance() {
+	const auto now = clock::now();
+	if (!_started) {
+		_last = now;
+		_started = true;
+	}
+	_accumulator += std::chrono::duration<double>(now - _last).count();
+	_last = now;
+
+	int steps = 0;
+	while (_accumulator >= _step && steps < _maxSteps) {
+		_accumulator -= _step;
+		steps++;
+	}
+
+	// Si un frame muy lento deja mas tiempo del que podemos recuperar, lo
+	// descartamos para no entrar en una espiral de pasos cada vez mas largos.
+	if (steps == _maxSteps && _accumulator >= _step) _accumulator = std::fmod(_accumulator, _step);
+
+	return steps;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <chrono>
+
+// Reloj de paso fijo: acumula el tiempo real de cada frame y lo reparte en
+// pasos de simulacion de duracion constante. El resto que queda se expresa
+// como alpha [0,1) para interpolar entre los dos ultimos estados simulados.
+class FixedTimestep {
+
+	using clock = std::chrono::steady_clock;
+
+	clock::time_point _last;
+	double _step = 0.0;
+	double _accumulator = 0.0;
+	int _maxSteps = 0;
+	bool _started = false;
+
+public:
+	FixedTimestep(double stepSeconds, int maxStepsPerFrame);
+
+	// Devuelve cuantos pasos fijos hay que simular este frame (como mucho maxSteps).
+	int advance();
+
+	double step() const { return _step; }
+	double alpha() const { return _accumulator / _step; }
+};
@@ -0,0 +1,117 @@
+#include "FrameArena.h"
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+using namespace std;
+
+namespace
+{
+	mutex registryMutex;
+	vector<unique_ptr<LinearArena>> arenas;
+	thread_local LinearArena* localArena = nullptr;
+}
+
+LinearArena::LinearArena(size_t capacity) {
+	addBlock(max<size_t>(capacity, 256));
+}
+
+LinearArena::~LinearArena() {
+	for (const auto& block : _blocks) {
+		MemoryTracker::remove(MemTag::Arenas, block.size);
+		::operator delete(block.data);
+	}
+}
+
+void LinearArena::addBlock(size_t size) {
+	_blocks.push_back({ static_cast<char*>(::operator new(size)), size });
+	MemoryTracker::add(MemTag::Arenas, size);
+}
+
+void* LinearArena::do_allocate(size_t bytes, size_t alignment) {
+	for (;;) {
+		Block& block = _blocks[_current];
+		const uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+		const uintptr_t aligned = (base + _offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+		const size_t end = static_cast<size_t>(aligned - base) + bytes;
+		if (end <= block.size) {
+			_used += end - _offset;
+			_offset = end;
+			_peak = max(_peak, _used);
+			return reinterpret_cast<void*>(aligned);
+		}
+
+		// No cabe: siguiente bloque ya reservado o uno nuevo el doble de grande
+		_used += block.size - _offset;
+		if (_current + 1 == _blocks.size()) addBlock(max(block.size * 2, bytes + alignment));
+		_current++;
+		_offset = 0;
+	}
+}
+
+LinearArena::Marker LinearArena::mark() const {
+	return { _current, _offset, _used };
+}
+
+void LinearArena::rewind(const Marker& marker) {
+	_current = marker.block;
+	_offset = marker.offset;
+	_used = marker.used;
+}
+
+void LinearArena::reset() {
+	if (_blocks.size() > 1) {
+		const size_t total = capacity();
+		for (const auto& block : _blocks) {
+			MemoryTracker::remove(MemTag::Arenas, block.size);
+			::operator delete(block.data);
+		}
+		_blocks.clear();
+		addBlock(total);
+	}
+	_current = 0;
+	_offset = 0;
+	_used = 0;
+}
+
+size_t LinearArena::capacity() const {
+	size_t total = 0;
+	for (const auto& block : _blocks) total += block.size;
+	return total;
+}
+
+LinearArena& FrameArena::local() {
+	if (!localArena) {
+		lock_guard<mutex> lock(registryMutex);
+		arenas.push_back(make_unique<LinearArena>(DEFAULT_CAPACITY));
+		localArena = arenas.back().get();
+	}
+	return *localArena;
+}
+
+void FrameArena::resetAll() {
+	lock_guard<mutex> lock(registryMutex);
+	for (auto& arena : arenas) arena->reset();
+}
+
+size_t FrameArena::totalCapacity() {
+	lock_guard<mutex> lock(registryMutex);
+	size_t total = 0;
+	for (const auto& arena : arenas) total += arena->capacity();
+	return total;
+}
+
+size_t FrameArena::totalPeak() {
+	lock_guard<mutex> lock(registryMutex);
+	size_t total = 0;
+	for (const auto& arena : arenas) total += arena->peak();
+	return total;
+}
+
+ScratchScope::ScratchScope(LinearArena& arena) : _arena(arena), _marker(arena.mark()) {}
+
+ScratchScope::~ScratchScope() {
+	_arena.rewind(_marker);
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// Asignador lineal: reservar es mover un puntero y deallocate no hace nada.
+// La memoria se devuelve de golpe con reset() o volviendo a una marca.
+// Si el bloque se llena pide otro al heap; reset() los funde en uno solo del
+// tamano total, asi que tras los primeros frames ya no vuelve a reservar.
+class LinearArena : public std::pmr::memory_resource {
+
+	struct Block
+	{
+		char* data;
+		size_t size;
+	};
+
+	std::vector<Block> _blocks;
+	size_t _current = 0;   // bloque en uso
+	size_t _offset = 0;    // dentro del bloque en uso
+	size_t _used = 0;      // bytes servidos desde el ultimo reset
+	size_t _peak = 0;
+
+	void addBlock(size_t size);
+
+public:
+	struct Marker
+	{
+		size_t block;
+		size_t offset;
+		size_t used;
+	};
+
+	explicit LinearArena(size_t capacity);
+	~LinearArena();
+	LinearArena(const LinearArena&) = delete;
+	LinearArena& operator=(const LinearArena&) = delete;
+
+	Marker mark() const;
+	void rewind(const Marker& marker);
+
+	// Invalida todo lo reservado. Nadie puede estar usando la arena.
+	void reset();
+
+	size_t used() const { return _used; }
+	size_t peak() const { return _peak; }
+	size_t capacity() const;
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void*, size_t, size_t) override {}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+// Una arena por hilo para datos que solo viven durante el frame
+// (listas de visibles, claves de orden, lineas de debug...)
+namespace FrameArena
+{
+	const size_t DEFAULT_CAPACITY = 1 << 20;
+
+	// Arena del hilo actual; se crea en el primer uso
+	LinearArena& local();
+
+	// Al final del frame, cuando ya no queda ningun job en marcha
+	void resetAll();
+
+	size_t totalCapacity();
+	size_t totalPeak();
+}
+
+// Memoria temporal que se libera al salir del ambito (la arena vuelve a la marca).
+// Sirve tambien en la carga: ScratchScope scratch; std::pmr::vector<T> v(scratch.resource());
+class ScratchScope {
+
+	LinearArena& _arena;
+	LinearArena::Marker _marker;
+
+public:
+	explicit ScratchScope(LinearArena& arena = FrameArena::local());
+	~ScratchScope();
+	ScratchScope(const ScratchScope&) = delete;
+	ScratchScope& operator=(const ScratchScope&) = delete;
+
+	std::pmr::memory_resource* resource() { return &_arena; }
+};
@@ -0,0 +1,219 @@
+#include "GpuTimer.h"
+#include "Profiler.h"
+#include <GL/glew.h>
+#include <imgui.h>
+#include <cstring>
+#include <stdio.h>
+#include <vector>
+using namespace std;
+
+namespace
+{
+	const int FRAMES_IN_FLIGHT = 4;
+	const int MAX_PASSES = 16;
+
+	struct PassQueries
+	{
+		const char* name = nullptr;
+		int depth = 0;
+		bool closed = false;
+	};
+
+	struct FrameQueries
+	{
+		GLuint queries[MAX_PASSES * 2] = {};
+		PassQueries passes[MAX_PASSES];
+		int passCount = 0;
+		bool pending = false;
+	};
+
+	struct PassResult
+	{
+		const char* name;
+		int depth;
+		double ms;
+		double averageMs;
+	};
+
+	bool supported = false;
+	FrameQueries frames[FRAMES_IN_FLIGHT];
+	int currentFrame = 0;
+	int openPasses[MAX_PASSES];
+	int openCount = 0;
+	int droppedFrames = 0;
+	vector<PassResult> results;
+	vector<GpuPassSample> samples;
+
+	// Diferencia entre el reloj de la GPU y Profiler::now(), se recalibra cada cierto tiempo
+	int64_t clockOffset = 0;
+	int framesSinceCalibration = 0;
+
+	void calibrate()
+	{
+		GLint64 gpuNow = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+		clockOffset = static_cast<int64_t>(Profiler::now()) - gpuNow;
+		framesSinceCalibration = 0;
+	}
+
+	PassResult* findResult(const char* name)
+	{
+		for (auto& r : results) if (strcmp(r.name, name) == 0) return &r;
+		return nullptr;
+	}
+
+	// Lee los resultados si ya estan; si no, se descarta el frame sin esperar
+	void collect(FrameQueries& frame)
+	{
+		if (!frame.pending) return;
+		frame.pending = false;
+		if (frame.passCount == 0) return;
+
+		// Las pasadas anidadas cierran fuera de orden: comprobamos todos los finales
+		for (int i = 0; i < frame.passCount; i++) {
+			if (!frame.passes[i].closed) continue;
+			GLint ready = 0;
+			glGetQueryObjectiv(frame.queries[i * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &ready);
+			if (!ready) {
+				droppedFrames++;
+				return;
+			}
+		}
+
+		for (int i = 0; i < frame.passCount; i++) {
+			if (!frame.passes[i].closed) continue;
+			GLuint64 begin = 0, end = 0;
+			glGetQueryObjectui64v(frame.queries[i * 2], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+			const double ms = (end - begin) / 1000000.0;
+			samples.push_back({ frame.passes[i].name, frame.passes[i].depth,
+				static_cast<uint64_t>(begin + clockOffset), static_cast<uint64_t>(end + clockOffset) });
+
+			PassResult* r = findResult(frame.passes[i].name);
+			if (!r) {
+				results.push_back({ frame.passes[i].name, frame.passes[i].depth, ms, ms });
+				continue;
+			}
+			r->ms = ms;
+			r->depth = frame.passes[i].depth;
+			r->averageMs = r->averageMs * 0.9 + ms * 0.1;
+		}
+	}
+}
+
+void GpuTimer::init()
+{
+	supported = (GLEW_VERSION_3_3 || GLEW_ARB_timer_query) != 0;
+	if (!supported) {
+		fprintf(stderr, "GpuTimer: timer queries no disponibles, tiempos de GPU desactivados\n");
+		return;
+	}
+	for (auto& frame : frames) glGenQueries(MAX_PASSES * 2, frame.queries);
+
+	// Algun driver anuncia la extension pero devuelve 0 bits de contador
+	GLint bits = 0;
+	glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+	if (bits == 0) {
+		fprintf(stderr, "GpuTimer: el contador de timestamps tiene 0 bits, tiempos de GPU desactivados\n");
+		shutdown();
+		return;
+	}
+	calibrate();
+}
+
+void GpuTimer::shutdown()
+{
+	if (!supported) return;
+	for (auto& frame : frames) {
+		glDeleteQueries(MAX_PASSES * 2, frame.queries);
+		frame = FrameQueries();
+	}
+	supported = false;
+}
+
+bool GpuTimer::available()
+{
+	return supported;
+}
+
+void GpuTimer::beginPass(const char* name)
+{
+	if (!supported) return;
+	FrameQueries& frame = frames[currentFrame];
+	if (frame.passCount >= MAX_PASSES || openCount >= MAX_PASSES) return;
+
+	const int index = frame.passCount++;
+	frame.passes[index].name = name;
+	frame.passes[index].depth = openCount;
+	frame.passes[index].closed = false;
+	openPasses[openCount++] = index;
+	glQueryCounter(frame.queries[index * 2], GL_TIMESTAMP);
+}
+
+void GpuTimer::endPass()
+{
+	if (!supported || openCount == 0) return;
+	FrameQueries& frame = frames[currentFrame];
+	const int index = openPasses[--openCount];
+	frame.passes[index].closed = true;
+	glQueryCounter(frame.queries[index * 2 + 1], GL_TIMESTAMP);
+}
+
+void GpuTimer::endFrame()
+{
+	if (!supported) return;
+	FrameQueries& finished = frames[currentFrame];
+	finished.pending = true;
+	openCount = 0;
+
+	currentFrame = (currentFrame + 1) % FRAMES_IN_FLIGHT;
+	samples.clear();
+	collect(frames[currentFrame]);
+	frames[currentFrame].passCount = 0;
+
+	if (++framesSinceCalibration >= 120) calibrate();
+}
+
+const vector<GpuPassSample>& GpuTimer::lastSamples()
+{
+	return samples;
+}
+
+double GpuTimer::passMs(const char* name)
+{
+	const PassResult* r = findResult(name);
+	return r ? r->ms : -1.0;
+}
+
+void GpuTimer::drawImGui()
+{
+	if (!ImGui::Begin("Profiler")) {
+		ImGui::End();
+		return;
+	}
+	if (ImGui::CollapsingHeader("GPU", ImGuiTreeNodeFlags_DefaultOpen)) {
+		if (!supported) {
+			ImGui::TextDisabled("Timer queries no disponibles en este driver");
+		}
+		else {
+			double total = 0.0;
+			for (const auto& r : results) {
+				ImGui::Text("%*s%-16s %7.3f ms  (media %7.3f)", r.depth * 2, "", r.name, r.ms, r.averageMs);
+				if (r.depth == 0) total += r.ms;
+			}
+			ImGui::Text("Total GPU: %.3f ms", total);
+			if (droppedFrames) ImGui::TextDisabled("Frames sin resultado a tiempo: %d", droppedFrames);
+		}
+	}
+	ImGui::End();
+}
+
+GpuZone::GpuZone(const char* name) : _active(GpuTimer::available())
+{
+	if (_active) GpuTimer::beginPass(name);
+}
+
+GpuZone::~GpuZone()
+{
+	if (_active) GpuTimer::endPass();
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Pasada resuelta, con los timestamps pasados al reloj de Profiler::now()
+struct GpuPassSample
+{
+	const char* name;
+	int depth;
+	uint64_t begin;
+	uint64_t end;
+};
+
+// Tiempos de GPU por pasada con queries de timestamp (GL_ARB_timer_query).
+// Las queries de cada frame se leen FRAMES_IN_FLIGHT frames despues, cuando
+// ya estan disponibles, asi que nunca se bloquea esperando a la GPU.
+// Si el driver no soporta timer queries (algunos GL por software) todo queda
+// desactivado y GPU_SCOPE no hace nada.
+namespace GpuTimer
+{
+	void init();     // Despues de glewInit
+	void shutdown();
+	bool available();
+
+	void beginPass(const char* name);
+	void endPass();
+	void endFrame(); // Despues del swap
+
+	// Tiempo del ultimo resultado leido de una pasada, -1 si no hay datos
+	double passMs(const char* name);
+	// Pasadas que se han podido leer en el ultimo endFrame
+	const std::vector<GpuPassSample>& lastSamples();
+
+	// Se anade a la ventana "Profiler" junto a las zonas de CPU
+	void drawImGui();
+}
+
+class GpuZone {
+	bool _active;
+public:
+	explicit GpuZone(const char* name);
+	~GpuZone();
+};
+
+#define GPU_SCOPE_CONCAT_INNER(a, b) a##b
+#define GPU_SCOPE_CONCAT(a, b) GPU_SCOPE_CONCAT_INNER(a, b)
+#define GPU_SCOPE(name) GpuZone GPU_SCOPE_CONCAT(_gpuZone, __LINE__)(name)
@@ -0,0 +1,386 @@
+#include "HotReload.h"
+#include "Scene.h"
+#include "FrameArena.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
+#include "Redraw.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+using hrclock = chrono::steady_clock;
+
+namespace
+{
+	// Un editor puede escribir el fichero en varias veces: esperamos a que se quede quieto
+	const auto SETTLE_TIME = chrono::milliseconds(200);
+	const auto POLL_INTERVAL = chrono::milliseconds(500);
+
+	struct Source
+	{
+		string path;
+		string directory;
+		string fileName;
+		bool isModel = false;
+		vector<MeshHandle> meshes;
+		TextureHandle texture;
+
+		// Sondeo sin inotify
+		filesystem::file_time_type lastWrite;
+		uintmax_t lastSize = 0;
+
+		// Solo el hilo principal
+		bool dirty = false;
+		bool loading = false;
+		hrclock::time_point changedAt;
+
+		// Los escribe el hilo de carga; el principal los lee cuando ready esta a true
+		atomic<bool> ready{ false };
+		ImportedModel model;
+		DecodedImage image;
+	};
+
+	vector<unique_ptr<Source>> sources;
+	bool running = false;
+
+	// Objetos viejos que aun puede usar el paquete del frame en vuelo
+	vector<MeshData> retiredMeshes;
+	vector<Texture> retiredTextures;
+
+	thread loader;
+	mutex loaderMutex;
+	condition_variable loaderWake;
+	deque<Source*> requests;
+	bool loaderRunning = false;
+
+#ifdef __linux__
+	int inotifyFd = -1;
+	vector<pair<int, string>> watchedDirectories; // descriptor de inotify -> directorio
+#endif
+	hrclock::time_point lastPoll;
+
+	void readFileState(Source& source, filesystem::file_time_type& write, uintmax_t& size)
+	{
+		error_code error;
+		write = filesystem::last_write_time(source.path, error);
+		size = error ? 0 : filesystem::file_size(source.path, error);
+	}
+
+	void markChanged(Source& source)
+	{
+		source.dirty = true;
+		source.changedAt = hrclock::now();
+	}
+
+	void loaderLoop()
+	{
+		Profiler::setThreadName("HotReload");
+		for (;;) {
+			Source* source;
+			{
+				unique_lock<mutex> lock(loaderMutex);
+				loaderWake.wait(lock, [] { return !requests.empty() || !loaderRunning; });
+				if (requests.empty()) return;
+				source = requests.front();
+				requests.pop_front();
+			}
+			PROFILE_SCOPE("HotReload");
+			// Sin mmap: si el editor trunca el fichero mientras lo leemos, un mapeo daria SIGBUS.
+			// En serie: este hilo no es worker y sus jobs acabarian en el hilo principal a mitad de frame
+			if (source->isModel) source->model = importFBX(source->path.c_str(), ImportIO::Stdio, ImportJobs::Serial);
+			else source->image = decodeImage(source->path.c_str());
+			source->ready.store(true, memory_order_release);
+			Redraw::wake(); // el bucle puede estar parado esperando eventos
+		}
+	}
+
+	void discardImported(ImportedModel& model)
+	{
+		for (const auto& meshData : model.meshes) MemoryTracker::remove(MemTag::MeshCPU, meshData.cpuBytes);
+		model.meshes.clear();
+	}
+
+	void freeRetired()
+	{
+		for (auto& meshData : retiredMeshes) cleanupMeshData(meshData);
+		retiredMeshes.clear();
+		for (auto& texture : retiredTextures) Resources::releaseTexture(texture);
+		retiredTextures.clear();
+	}
+
+	void pollChanges()
+	{
+#ifdef __linux__
+		if (inotifyFd >= 0) {
+			alignas(inotify_event) char buffer[4096];
+			for (;;) {
+				const ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+				if (length <= 0) break; // EAGAIN: no hay mas eventos
+				for (ssize_t offset = 0; offset < length;) {
+					const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+					offset += sizeof(inotify_event) + event->len;
+					if (event->len == 0) continue;
+					for (const auto& watched : watchedDirectories) {
+						if (watched.first != event->wd) continue;
+						for (auto& source : sources) {
+							if (source->directory == watched.second && source->fileName == event->name) markChanged(*source);
+						}
+					}
+				}
+			}
+			return;
+		}
+#endif
+		const auto now = hrclock::now();
+		if (now - lastPoll < POLL_INTERVAL) return;
+		lastPoll = now;
+		for (auto& source : sources) {
+			filesystem::file_time_type write;
+			uintmax_t size;
+			readFileState(*source, write, size);
+			if (write == source->lastWrite && size == source->lastSize) continue;
+			source->lastWrite = write;
+			source->lastSize = size;
+			markChanged(*source);
+		}
+	}
+
+	void applyModel(Source& source, Scene& scene)
+	{
+		ImportedModel& model = source.model;
+		if (model.meshes.empty()) {
+			fprintf(stderr, "HotReload: no se pudo importar %s, se mantiene la version anterior\n", source.path.c_str());
+			return;
+		}
+
+		MaterialHandle material;
+		for (const MeshHandle handle : source.meshes) {
+			if (const MeshData* meshData = Resources::meshes.get(handle)) {
+				material = meshData->material;
+				break;
+			}
+		}
+
+		size_t maxIndices = 0;
+		for (const auto& meshData : model.meshes) maxIndices = max(maxIndices, meshData.triangles.size() * 3);
+		LinearArena scratch(maxIndices * sizeof(unsigned int) + 64);
+
+		int uploaded = 0;
+		const size_t oldCount = source.meshes.size();
+		for (size_t i = 0; i < model.meshes.size(); i++) {
+			MeshData& fresh = model.meshes[i];
+			MeshData* slot = i < oldCount ? Resources::meshes.get(source.meshes[i]) : nullptr;
+			if (slot && slot->contentHash == fresh.contentHash) {
+				MemoryTracker::remove(MemTag::MeshCPU, fresh.cpuBytes);
+				continue;
+			}
+
+			LoadToBuffers(fresh, scratch);
+			uploaded++;
+			fresh.material = slot ? slot->material : material;
+			if (slot) {
+				// Mismo slot y mismo handle: la escena no se entera salvo por las bounds
+				retiredMeshes.push_back(move(*slot));
+				*slot = move(fresh);
+				scene.refreshMeshBounds(source.meshes[i]);
+			}
+			else {
+				const MeshHandle handle = Resources::meshes.insert(move(fresh));
+				if (i < oldCount) source.meshes[i] = handle;
+				else source.meshes.push_back(handle);
+				scene.spawnMesh(handle);
+			}
+		}
+
+		// Mallas que ya no estan en el fichero: sus entidades dejan de dibujarse
+		for (size_t i = model.meshes.size(); i < oldCount; i++) {
+			if (MeshData* slot = Resources::meshes.get(source.meshes[i])) {
+				retiredMeshes.push_back(move(*slot));
+				Resources::meshes.remove(source.meshes[i]);
+			}
+		}
+		if (model.meshes.size() < oldCount) source.meshes.resize(model.meshes.size());
+
+		printf("HotReload: %s recargado, %d de %zu mallas subidas\n", source.path.c_str(), uploaded, model.meshes.size());
+		model.meshes.clear();
+	}
+
+	void applyTexture(Source& source)
+	{
+		if (source.image.rgba.empty()) {
+			fprintf(stderr, "HotReload: no se pudo decodificar %s, se mantiene la version anterior\n", source.path.c_str());
+			return;
+		}
+		Texture* slot = Resources::textures.get(source.texture);
+		const Texture fresh = createTexture(source.image);
+		if (slot) {
+			retiredTextures.push_back(*slot);
+			*slot = fresh;
+		}
+		else {
+			source.texture = Resources::textures.insert(fresh);
+		}
+		source.image = DecodedImage();
+		printf("HotReload: %s recargada\n", source.path.c_str());
+	}
+
+	void addSource(unique_ptr<Source> source)
+	{
+		const filesystem::path path(source->path);
+		source->directory = path.has_parent_path() ? path.parent_path().string() : string(".");
+		source->fileName = path.filename().string();
+		readFileState(*source, source->lastWrite, source->lastSize);
+		sources.push_back(move(source));
+	}
+}
+
+void HotReload::watchModel(const char* path, const vector<MeshHandle>& meshes)
+{
+	auto source = make_unique<Source>();
+	source->path = path;
+	source->isModel = true;
+	source->meshes = meshes;
+	addSource(move(source));
+}
+
+void HotReload::watchTexture(const char* path, TextureHandle texture)
+{
+	auto source = make_unique<Source>();
+	source->path = path;
+	source->texture = texture;
+	addSource(move(source));
+}
+
+void HotReload::start()
+{
+	if (running) return;
+	running = true;
+	lastPoll = hrclock::now();
+
+#ifdef __linux__
+	// Se vigila el directorio y no el fichero: muchos editores guardan con un rename
+	inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotifyFd >= 0) {
+		for (const auto& source : sources) {
+			bool watched = false;
+			for (const auto& entry : watchedDirectories) watched = watched || entry.second == source->directory;
+			if (watched) continue;
+			const int wd = inotify_add_watch(inotifyFd, source->directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+			if (wd >= 0) watchedDirectories.emplace_back(wd, source->directory);
+		}
+		if (watchedDirectories.empty() && !sources.empty()) {
+			close(inotifyFd);
+			inotifyFd = -1;
+		}
+	}
+	if (inotifyFd < 0) fprintf(stderr, "HotReload: inotify no disponible, se consultaran las fechas de los ficheros\n");
+#endif
+
+	loaderRunning = true;
+	loader = thread(loaderLoop);
+}
+
+void HotReload::stop()
+{
+	if (!running) return;
+	{
+		lock_guard<mutex> lock(loaderMutex);
+		loaderRunning = false;
+		requests.clear();
+	}
+	loaderWake.notify_all();
+	loader.join();
+
+	for (auto& source : sources) {
+		discardImported(source->model);
+		source->image = DecodedImage();
+		source->ready.store(false);
+		source->loading = false;
+		source->dirty = false;
+	}
+	freeRetired();
+
+#ifdef __linux__
+	if (inotifyFd >= 0) close(inotifyFd);
+	inotifyFd = -1;
+	watchedDirectories.clear();
+#endif
+	running = false;
+}
+
+bool HotReload::usingInotify()
+{
+#ifdef __linux__
+	return inotifyFd >= 0;
+#else
+	return false;
+#endif
+}
+
+void HotReload::update(Scene& scene)
+{
+	if (!running) return;
+	PROFILE_FUNCTION();
+
+	// Lo retirado en la llamada anterior ya se ha dibujado por ultima vez
+	freeRetired();
+	for (auto& source : sources) {
+		if (source->loading && source->ready.load(memory_order_acquire)) {
+			source->ready.store(false, memory_order_relaxed);
+			source->loading = false;
+			if (source->isModel) applyModel(*source, scene);
+			else applyTexture(*source);
+			// Los draws en cache apuntan a los VAO y texturas que se acaban de retirar
+			scene.markChanged();
+		}
+	}
+	poll();
+}
+
+void HotReload::poll()
+{
+	if (!running) return;
+	pollChanges();
+
+	const auto now = hrclock::now();
+	for (auto& source : sources) {
+		if (source->dirty && !source->loading && now - source->changedAt >= SETTLE_TIME) {
+			source->dirty = false;
+			source->loading = true;
+			{
+				lock_guard<mutex> lock(loaderMutex);
+				requests.push_back(source.get());
+			}
+			loaderWake.notify_one();
+		}
+	}
+}
+
+bool HotReload::busy()
+{
+	for (const auto& source : sources) {
+		if (source->dirty || source->loading) return true;
+	}
+	return false;
+}
+
+bool HotReload::readyToApply()
+{
+	for (const auto& source : sources) {
+		if (source->loading && source->ready.load(memory_order_acquire)) return true;
+	}
+	return false;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Resources.h"
+#include <vector>
+
+class Scene;
+
+// Recarga en caliente de modelos y texturas.
+// Los cambios se detectan con inotify en Linux y mirando la fecha de los
+// ficheros cada medio segundo en el resto. Cuando un fichero deja de cambiar,
+// un hilo propio lo vuelve a importar/decodificar y update() cambia el
+// contenido de los slots del pool entre dos frames: los handles no cambian.
+// Solo se suben las mallas cuyo contenido es distinto (contentHash), y los
+// objetos de OpenGL viejos se borran un frame despues, cuando ya no hay
+// ningun paquete de frame que los use.
+namespace HotReload
+{
+	// Registrar fuentes no arranca nada; se puede hacer antes de start()
+	void watchModel(const char* path, const std::vector<MeshHandle>& meshes);
+	void watchTexture(const char* path, TextureHandle texture);
+
+	void start();
+	// Espera a la carga en curso y libera todo lo pendiente. Antes de Resources::destroyAll.
+	void stop();
+	bool usingInotify();
+
+	// Una vez por frame, entre frames (sin jobs que lean Resources ni la escena)
+	void update(Scene& scene);
+	// Solo detecta cambios y lanza las cargas, sin tocar la escena ni Resources:
+	// es lo que se hace en los despertares del modo bajo demanda, sin dibujar
+	void poll();
+	bool busy();         // algun fichero cambiado o cargandose
+	bool readyToApply(); // alguna carga terminada: el siguiente update() la aplica
+}
@@ -0,0 +1,312 @@
+#include "Input.h"
+#include "Profiler.h"
+#include <SDL2/SDL_hints.h>
+#include <SDL2/SDL_mouse.h>
+#include <SDL2/SDL_timer.h>
+#include <imgui.h>
+#include <imgui_impl_sdl2.h>
+#include <algorithm>
+#include <stdio.h>
+using namespace std;
+
+namespace
+{
+	const float ORBIT_SPEED = 0.5f; // grados por pixel
+	const float PAN_SPEED = 0.05f;
+	const float ZOOM_SPEED = 0.5f;
+	const int MAX_KEYS = 16;
+	const int PRESENT_HISTORY = 64;
+	const int LATENCY_BUCKETS = 256; // 1 ms por cubo, el ultimo es "o mas"
+
+	// Eventos de camara de un frame, del primero al ultimo
+	struct EventSpan
+	{
+		Uint32 oldest = 0;
+		Uint32 newest = 0;
+		size_t events = 0;
+		size_t coalesced = 0;
+	};
+
+	bool relativeAllowed = true;
+	MouseDrag currentDrag = MouseDrag::None;
+	bool relativeActive = false;
+	PendingInput accumulated;
+	SDL_Keycode pressed[MAX_KEYS];
+	int pressedCount = 0;
+	int mouseX = 0, mouseY = 0;
+	bool objectClick = false;
+	int objectClickX = 0, objectClickY = 0;
+	size_t eventCount = 0;
+	bool resizePending = false;
+	int resizeWidth = 0, resizeHeight = 0;
+
+	EventSpan pending;  // recibidos desde el ultimo latch()
+	EventSpan latched;  // los que lleva el frame que se va a presentar
+	bool motionPending = false;
+
+	Uint32 presentTicks[PRESENT_HISTORY] = {};
+	size_t presentCount = 0;
+
+	size_t histogram[LATENCY_BUCKETS] = {};
+	InputLatencyStats stats;
+	double totalMs = 0.0;
+	size_t totalFrames = 0;
+	FILE* logFile = nullptr;
+
+	void beginDrag(MouseDrag drag)
+	{
+		currentDrag = drag;
+		// Arrastrar un objeto necesita la posicion absoluta del cursor
+		if (relativeAllowed && drag != MouseDrag::Object && SDL_SetRelativeMouseMode(SDL_TRUE) == 0) relativeActive = true;
+	}
+
+	void endDrag()
+	{
+		currentDrag = MouseDrag::None;
+		if (relativeActive) SDL_SetRelativeMouseMode(SDL_FALSE);
+		relativeActive = false;
+	}
+
+	void cameraEvent(Uint32 timestamp, bool motion)
+	{
+		if (pending.events == 0) pending.oldest = timestamp;
+		pending.newest = timestamp;
+		pending.events++;
+		// Varios movimientos en el mismo frame acaban en una sola actualizacion de la camara
+		if (motion && motionPending) pending.coalesced++;
+		motionPending = motionPending || motion;
+	}
+
+	double percentile(double fraction)
+	{
+		const size_t target = static_cast<size_t>(fraction * stats.frames + 0.5);
+		size_t seen = 0;
+		for (int i = 0; i < LATENCY_BUCKETS; i++) {
+			seen += histogram[i];
+			if (seen >= max<size_t>(target, 1)) return i;
+		}
+		return LATENCY_BUCKETS - 1;
+	}
+}
+
+void Input::init(bool relativeMouse, const char* logPath)
+{
+	relativeAllowed = relativeMouse;
+	// En Windows el modo relativo sin warp lee raw input: sin aceleracion ni recorte en el borde
+	SDL_SetHint(SDL_HINT_MOUSE_RELATIVE_MODE_WARP, "0");
+	if (logPath) {
+		logFile = fopen(logPath, "w");
+		if (logFile) fprintf(logFile, "frame,events,coalesced,oldest_ms,newest_ms,present_ms,latency_ms,latency_frames\n");
+		else fprintf(stderr, "Input: no se puede escribir %s\n", logPath);
+	}
+}
+
+void Input::shutdown()
+{
+	endDrag();
+	if (logFile) fclose(logFile);
+	logFile = nullptr;
+	const InputLatencyStats s = latencyStats();
+	if (s.frames == 0) return;
+	printf("Input: %zu frames con eventos de camara (%zu eventos, %zu combinados)\n", s.frames, s.events, s.coalesced);
+	printf("Input: latencia hasta el swap media %.1f ms, p50 %.0f ms, p95 %.0f ms, max %.0f ms; %.2f frames de media, max %d\n",
+		s.meanMs, s.p50Ms, s.p95Ms, s.maxMs, s.meanFrames, s.maxFrames);
+}
+
+bool Input::pump()
+{
+	PROFILE_FUNCTION();
+	SDL_Event event;
+	while (SDL_PollEvent(&event)) {
+		// Los SDL_USEREVENT solo despiertan el bucle parado (Redraw::wake), no son actividad
+		if (event.type >= SDL_USEREVENT) continue;
+		eventCount++;
+		ImGui_ImplSDL2_ProcessEvent(&event);
+		switch (event.type) {
+		case SDL_QUIT:
+			return false;
+		case SDL_WINDOWEVENT:
+			// Si se pierde el foco a mitad de arrastre no llegara el boton soltado
+			if (event.window.event == SDL_WINDOWEVENT_FOCUS_LOST) endDrag();
+			// Varios en el mismo frame (arrastrando el borde) se quedan en el ultimo
+			if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+				resizePending = true;
+				resizeWidth = event.window.data1;
+				resizeHeight = event.window.data2;
+			}
+			break;
+		case SDL_KEYDOWN:
+			if (event.key.repeat || pressedCount == MAX_KEYS) break;
+			pressed[pressedCount++] = event.key.keysym.sym;
+			break;
+		case SDL_MOUSEBUTTONDOWN:
+			mouseX = event.button.x;
+			mouseY = event.button.y;
+			// Los clics sobre una ventana de ImGui son suyos
+			if (currentDrag != MouseDrag::None || ImGui::GetIO().WantCaptureMouse) break;
+			if (event.button.button == SDL_BUTTON_RIGHT) beginDrag(MouseDrag::Orbit);
+			else if (event.button.button == SDL_BUTTON_LEFT) {
+				beginDrag(SDL_GetModState() & KMOD_ALT ? MouseDrag::Pan : MouseDrag::Object);
+				if (currentDrag == MouseDrag::Object) {
+					objectClick = true;
+					objectClickX = mouseX;
+					objectClickY = mouseY;
+				}
+			}
+			break;
+		case SDL_MOUSEBUTTONUP:
+			if (event.button.button == SDL_BUTTON_RIGHT && currentDrag == MouseDrag::Orbit) endDrag();
+			if (event.button.button == SDL_BUTTON_LEFT && (currentDrag == MouseDrag::Pan || currentDrag == MouseDrag::Object)) endDrag();
+			break;
+		case SDL_MOUSEWHEEL:
+			accumulated.zoom += event.wheel.y * ZOOM_SPEED;
+			cameraEvent(event.wheel.timestamp, false);
+			break;
+		case SDL_MOUSEMOTION:
+			if (!relativeActive) {
+				mouseX = event.motion.x;
+				mouseY = event.motion.y;
+			}
+			// xrel/yrel ya es el desplazamiento de este evento: no hace falta SDL_GetMouseState
+			if (currentDrag == MouseDrag::Orbit) {
+				accumulated.rotateY += event.motion.xrel * ORBIT_SPEED;
+				accumulated.rotateX += event.motion.yrel * ORBIT_SPEED;
+				cameraEvent(event.motion.timestamp, true);
+			}
+			else if (currentDrag == MouseDrag::Pan) {
+				accumulated.panX += event.motion.xrel * PAN_SPEED;
+				accumulated.panY += event.motion.yrel * PAN_SPEED;
+				cameraEvent(event.motion.timestamp, true);
+			}
+			break;
+		}
+	}
+	return true;
+}
+
+bool Input::keyPressed(SDL_Keycode key)
+{
+	for (int i = 0; i < pressedCount; i++) {
+		if (pressed[i] == key) return true;
+	}
+	return false;
+}
+
+size_t Input::events()
+{
+	return eventCount;
+}
+
+MouseDrag Input::drag()
+{
+	return currentDrag;
+}
+
+void Input::mousePosition(int& x, int& y)
+{
+	x = mouseX;
+	y = mouseY;
+}
+
+bool Input::consumeObjectClick(int& x, int& y)
+{
+	if (!objectClick) return false;
+	objectClick = false;
+	x = objectClickX;
+	y = objectClickY;
+	return true;
+}
+
+bool Input::consumeResize(int& width, int& height)
+{
+	if (!resizePending) return false;
+	resizePending = false;
+	width = resizeWidth;
+	height = resizeHeight;
+	return true;
+}
+
+void Input::take(PendingInput& into)
+{
+	into.rotateX += accumulated.rotateX;
+	into.rotateY += accumulated.rotateY;
+	into.panX += accumulated.panX;
+	into.panY += accumulated.panY;
+	into.zoom += accumulated.zoom;
+	accumulated = PendingInput();
+	pressedCount = 0;
+}
+
+const PendingInput& Input::peek()
+{
+	return accumulated;
+}
+
+void Input::latch()
+{
+	latched = pending;
+	pending = EventSpan();
+	motionPending = false;
+}
+
+void Input::presented()
+{
+	const Uint32 now = SDL_GetTicks();
+	presentTicks[presentCount % PRESENT_HISTORY] = now;
+	presentCount++;
+	if (latched.events == 0) return;
+
+	// Frames: este swap mas los que ya se habian hecho cuando llego el primer evento
+	const Uint32 latency = now - latched.oldest;
+	int frames = 1;
+	const size_t history = min<size_t>(presentCount - 1, PRESENT_HISTORY - 1);
+	for (size_t i = 1; i <= history; i++) {
+		if (static_cast<Sint32>(presentTicks[(presentCount - 1 - i) % PRESENT_HISTORY] - latched.oldest) <= 0) break;
+		frames++;
+	}
+
+	histogram[min<Uint32>(latency, LATENCY_BUCKETS - 1)]++;
+	stats.frames++;
+	stats.events += latched.events;
+	stats.coalesced += latched.coalesced;
+	stats.maxMs = max(stats.maxMs, static_cast<double>(latency));
+	stats.maxFrames = max(stats.maxFrames, frames);
+	totalMs += latency;
+	totalFrames += frames;
+
+	if (logFile) {
+		fprintf(logFile, "%zu,%zu,%zu,%u,%u,%u,%u,%d\n", presentCount, latched.events, latched.coalesced,
+			latched.oldest, latched.newest, now, latency, frames);
+	}
+	latched = EventSpan();
+}
+
+InputLatencyStats Input::latencyStats()
+{
+	InputLatencyStats s = stats;
+	if (s.frames == 0) return s;
+	s.meanMs = totalMs / s.frames;
+	s.meanFrames = static_cast<double>(totalFrames) / s.frames;
+	s.p50Ms = percentile(0.5);
+	s.p95Ms = percentile(0.95);
+	return s;
+}
+
+void Input::drawImGui()
+{
+	if (!ImGui::Begin("Input")) {
+		ImGui::End();
+		return;
+	}
+	const InputLatencyStats s = latencyStats();
+	ImGui::Text("Raton relativo: %s", relativeActive ? "si" : (relativeAllowed ? "no (sin arrastre)" : "desactivado"));
+	if (s.frames == 0) {
+		ImGui::TextDisabled("Sin eventos de camara todavia");
+	}
+	else {
+		ImGui::Text("Latencia hasta el swap: media %.1f ms, p95 %.0f ms, max %.0f ms", s.meanMs, s.p95Ms, s.maxMs);
+		ImGui::Text("En frames: media %.2f, max %d", s.meanFrames, s.maxFrames);
+		ImGui::Text("Eventos: %zu (%zu combinados en %zu frames)", s.events, s.coalesced, s.frames);
+	}
+	ImGui::End();
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "Simulation.h"
+#include <SDL2/SDL_events.h>
+#include <cstddef>
+
+// Que esta haciendo el arrastre de raton en curso
+enum class MouseDrag { None, Orbit, Pan, Object };
+
+// Latencia de input a pantalla de los eventos de camara ya presentados
+struct InputLatencyStats
+{
+	size_t frames = 0;    // frames presentados con algun evento de camara
+	size_t events = 0;    // eventos de camara recibidos
+	size_t coalesced = 0; // de ellos, movimientos sumados a otro del mismo frame
+	double meanMs = 0.0;
+	double p50Ms = 0.0;
+	double p95Ms = 0.0;
+	double maxMs = 0.0;
+	double meanFrames = 0.0;
+	int maxFrames = 0;
+};
+
+// Input del raton y el teclado con la menor latencia posible.
+// pump() vacia la cola de SDL y suma el movimiento relativo (xrel/yrel) de
+// todos los eventos del frame en un solo PendingInput; durante un arrastre el
+// raton va en modo relativo (sin limite en el borde de la ventana y con raw
+// input en Windows). El bucle principal lo vuelca a la simulacion con take() y,
+// justo antes de dibujar, vuelve a llamar a pump() y aplica peek() sobre la
+// camara del frame (late latch).
+// Cada evento de camara guarda su timestamp de SDL: latch() fija los que entran
+// en el frame y presented() mide cuanto han tardado en llegar al swap.
+namespace Input
+{
+	// relativeMouse = false deja el cursor libre (escritorio remoto, VMs...).
+	// logPath: CSV con una linea por frame presentado con eventos de camara
+	void init(bool relativeMouse, const char* logPath = nullptr);
+	void shutdown(); // Cierra el log e imprime el resumen de latencia
+
+	// Procesa todos los eventos pendientes. Devuelve false si se ha pedido salir
+	bool pump();
+
+	// Eventos procesados desde el arranque: si cambia, ha habido actividad
+	size_t events();
+	// Tecla pulsada en algun pump() desde el ultimo take()
+	bool keyPressed(SDL_Keycode key);
+	MouseDrag drag();
+	// Ultima posicion del cursor en la ventana (no cambia en modo relativo)
+	void mousePosition(int& x, int& y);
+	// Clic que ha empezado un arrastre de objeto; se consume al leerlo
+	bool consumeObjectClick(int& x, int& y);
+	// Nuevo tamano de la ventana si ha cambiado; se consume al leerlo
+	bool consumeResize(int& width, int& height);
+
+	// Suma lo acumulado a 'into' y lo vacia
+	void take(PendingInput& into);
+	// Lo acumulado desde el ultimo take(), sin consumirlo
+	const PendingInput& peek();
+
+	// Se ha fijado la camara del frame que se va a presentar
+	void latch();
+	// Justo despues del swap del frame fijado con latch()
+	void presented();
+
+	InputLatencyStats latencyStats();
+	// Se anade como ventana "Input"
+	void drawImGui();
+}
@@ -0,0 +1,217 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+namespace
+{
+	// Deque de Chase-Lev de capacidad fija. Solo el dueno llama a push/pop.
+	class WorkStealingDeque
+	{
+		static const int64_t CAPACITY = 4096;
+		static const int64_t MASK = CAPACITY - 1;
+
+		alignas(64) atomic<int64_t> _top{ 0 };
+		alignas(64) atomic<int64_t> _bottom{ 0 };
+		Job _jobs[CAPACITY];
+
+	public:
+		bool push(const Job& job)
+		{
+			const int64_t b = _bottom.load(memory_order_relaxed);
+			const int64_t t = _top.load(memory_order_acquire);
+			if (b - t >= CAPACITY) return false;
+			_jobs[b & MASK] = job;
+			atomic_thread_fence(memory_order_release);
+			_bottom.store(b + 1, memory_order_relaxed);
+			return true;
+		}
+
+		bool pop(Job& out)
+		{
+			const int64_t b = _bottom.load(memory_order_relaxed) - 1;
+			_bottom.store(b, memory_order_relaxed);
+			atomic_thread_fence(memory_order_seq_cst);
+			int64_t t = _top.load(memory_order_relaxed);
+
+			if (t > b) {
+				_bottom.store(b + 1, memory_order_relaxed);
+				return false;
+			}
+			out = _jobs[b & MASK];
+			if (t == b) {
+				// Ultimo elemento: competimos con los ladrones
+				const bool won = _top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+				_bottom.store(b + 1, memory_order_relaxed);
+				return won;
+			}
+			return true;
+		}
+
+		bool steal(Job& out)
+		{
+			int64_t t = _top.load(memory_order_acquire);
+			atomic_thread_fence(memory_order_seq_cst);
+			const int64_t b = _bottom.load(memory_order_acquire);
+			if (t >= b) return false;
+
+			out = _jobs[t & MASK];
+			return _top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+		}
+	};
+
+	vector<unique_ptr<WorkStealingDeque>> queues;
+	vector<thread> threads;
+	atomic<bool> running{ false };
+
+	// Cola compartida para hilos que no son workers (carga de assets, etc.)
+	mutex externalMutex;
+	deque<Job> externalJobs;
+
+	mutex sleepMutex;
+	condition_variable wakeUp;
+	atomic<int> sleepers{ 0 };
+	atomic<uint64_t> submitted{ 0 }; // sube con cada submit: quien va a dormir ve si ha llegado algo
+
+	thread_local int currentWorker = -1;
+	thread_local unsigned int stealSeed = 0;
+
+	void execute(Job& job)
+	{
+		job.function(job);
+		if (job.counter) job.counter->pending.fetch_sub(1, memory_order_release);
+	}
+
+	bool findJob(Job& out)
+	{
+		const int self = currentWorker;
+		if (self >= 0 && queues[self]->pop(out)) return true;
+
+		const int count = static_cast<int>(queues.size());
+		if (count > 0) {
+			stealSeed = stealSeed * 1103515245u + 12345u;
+			const int start = static_cast<int>((stealSeed >> 16) % count);
+			for (int i = 0; i < count; i++) {
+				const int victim = (start + i) % count;
+				if (victim != self && queues[victim]->steal(out)) return true;
+			}
+		}
+
+		lock_guard<mutex> lock(externalMutex);
+		if (externalJobs.empty()) return false;
+		out = externalJobs.front();
+		externalJobs.pop_front();
+		return true;
+	}
+
+	void workerLoop(int index)
+	{
+		currentWorker = index;
+		stealSeed = static_cast<unsigned int>(index) * 2654435761u;
+		const string name = "Worker " + to_string(index);
+		Profiler::setThreadName(name.c_str());
+		int idleRounds = 0;
+		Job job;
+		while (running.load(memory_order_acquire)) {
+			const uint64_t seen = submitted.load(memory_order_seq_cst);
+			if (findJob(job)) {
+				execute(job);
+				idleRounds = 0;
+				continue;
+			}
+			if (++idleRounds < 64) {
+				this_thread::yield();
+				continue;
+			}
+			// Sin trabajo durante un rato: dormimos hasta el siguiente submit, sin
+			// despertar cada poco (con el bucle parado el proceso no gasta CPU).
+			// Si ha habido un submit desde 'seen' puede que findJob no lo viera: no se duerme
+			unique_lock<mutex> lock(sleepMutex);
+			sleepers.fetch_add(1, memory_order_seq_cst);
+			wakeUp.wait(lock, [seen] { return submitted.load(memory_order_seq_cst) != seen || !running.load(memory_order_acquire); });
+			sleepers.fetch_sub(1, memory_order_relaxed);
+			idleRounds = 0;
+		}
+	}
+}
+
+void JobSystem::init(int workers)
+{
+	if (running.load()) shutdown();
+	if (workers <= 0) workers = static_cast<int>(thread::hardware_concurrency());
+	if (workers <= 0) workers = 1;
+
+	queues.clear();
+	for (int i = 0; i < workers; i++) queues.push_back(make_unique<WorkStealingDeque>());
+
+	currentWorker = 0; // El hilo que inicializa (el principal) es el worker 0
+	running.store(true, memory_order_release);
+	for (int i = 1; i < workers; i++) threads.emplace_back(workerLoop, i);
+}
+
+void JobSystem::shutdown()
+{
+	running.store(false, memory_order_release);
+	{
+		lock_guard<mutex> lock(sleepMutex); // nadie entre comprobar running y dormirse
+	}
+	wakeUp.notify_all();
+	for (auto& t : threads) t.join();
+	threads.clear();
+	queues.clear();
+	currentWorker = -1;
+}
+
+int JobSystem::workerCount()
+{
+	return queues.empty() ? 1 : static_cast<int>(queues.size());
+}
+
+int JobSystem::workerIndex()
+{
+	return currentWorker;
+}
+
+void JobSystem::submit(const Job& job)
+{
+	if (!running.load(memory_order_acquire)) {
+		// Sin sistema de jobs ejecutamos en el momento
+		Job inlineJob = job;
+		execute(inlineJob);
+		return;
+	}
+
+	const int self = currentWorker;
+	if (self >= 0) {
+		if (!queues[self]->push(job)) {
+			Job inlineJob = job;
+			execute(inlineJob);
+			return;
+		}
+	}
+	else {
+		lock_guard<mutex> lock(externalMutex);
+		externalJobs.push_back(job);
+	}
+	submitted.fetch_add(1, memory_order_seq_cst);
+	if (sleepers.load(memory_order_seq_cst) > 0) {
+		// Con el mutex: un worker que ya ha mirado submitted pero aun no duerme no pierde el aviso
+		lock_guard<mutex> lock(sleepMutex);
+		wakeUp.notify_one();
+	}
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+	Job job;
+	while (!counter.done()) {
+		if (running.load(memory_order_acquire) && findJob(job)) execute(job);
+		else this_thread::yield();
+	}
+}
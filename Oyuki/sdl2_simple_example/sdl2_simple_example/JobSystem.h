@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+// Sistema de jobs con robo de trabajo (work stealing).
+// Hay un worker por nucleo: el hilo principal es el worker 0 y el resto son
+// hilos propios. Cada worker tiene su deque lock-free (Chase-Lev): el dueno
+// mete y saca por abajo y los demas roban por arriba.
+// Las dependencias se expresan con JobCounter: run() lo incrementa, el job lo
+// decrementa al terminar y wait() ejecuta otros jobs mientras no llegue a 0.
+
+struct JobCounter
+{
+	std::atomic<int> pending{ 0 };
+	bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+struct Job
+{
+	static const size_t PAYLOAD_SIZE = 48;
+
+	void (*function)(Job&) = nullptr;
+	JobCounter* counter = nullptr;
+	alignas(16) unsigned char payload[PAYLOAD_SIZE];
+};
+
+namespace JobSystem
+{
+	// workers = 0 usa hardware_concurrency
+	void init(int workers = 0);
+	void shutdown();
+
+	int workerCount();
+	// Indice del worker que ejecuta el codigo, -1 si es un hilo externo
+	int workerIndex();
+
+	void submit(const Job& job);
+	// Bloquea hasta que el contador llegue a 0, ejecutando jobs mientras tanto
+	void wait(JobCounter& counter);
+
+	template<class F>
+	void run(JobCounter& counter, const F& f)
+	{
+		static_assert(sizeof(F) <= Job::PAYLOAD_SIZE, "Captura demasiado grande para un Job");
+		static_assert(std::is_trivially_copyable<F>::value, "Las capturas de un Job deben ser copiables con memcpy");
+
+		Job job;
+		job.function = [](Job& j) { (*reinterpret_cast<F*>(j.payload))(); };
+		job.counter = &counter;
+		std::memcpy(job.payload, &f, sizeof(F));
+		counter.pending.fetch_add(1, std::memory_order_relaxed);
+		submit(job);
+	}
+
+	// Divide [0, count) en bloques de 'grain' elementos y llama f(begin, end) en paralelo
+	template<class F>
+	void parallelFor(size_t count, size_t grain, const F& f)
+	{
+		if (count == 0) return;
+		if (grain == 0) grain = 1;
+		if (count <= grain || workerCount() == 1) {
+			f(size_t(0), count);
+			return;
+		}
+		JobCounter counter;
+		const F* fn = &f;
+		for (size_t begin = 0; begin < count; begin += grain) {
+			const size_t end = begin + grain < count ? begin + grain : count;
+			run(counter, [fn, begin, end]() { (*fn)(begin, end); });
+		}
+		wait(counter);
+	}
+}
@@ -0,0 +1,134 @@
+#include "MappedFile.h"
+#include <algorithm>
+#include <utility>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	*this = move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this == &other) return *this;
+	close();
+	_data = exchange(other._data, nullptr);
+	_size = exchange(other._size, size_t(0));
+#ifdef _WIN32
+	_file = exchange(other._file, nullptr);
+	_mapping = exchange(other._mapping, nullptr);
+#else
+	_fd = exchange(other._fd, -1);
+#endif
+	return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const char* path) {
+	close();
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		return false;
+	}
+	_file = file;
+	_size = static_cast<size_t>(size.QuadPart);
+	if (_size == 0) return true; // No se puede proyectar un fichero vacio
+
+	_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mapping) _data = static_cast<const unsigned char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!_data) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close() {
+	if (_data) UnmapViewOfFile(_data);
+	if (_mapping) CloseHandle(_mapping);
+	if (_file) CloseHandle(_file);
+	_data = nullptr;
+	_mapping = nullptr;
+	_file = nullptr;
+	_size = 0;
+}
+
+bool MappedFile::isOpen() const {
+	return _file != nullptr;
+}
+
+void MappedFile::advise(MapAccess) const {
+	// Windows no tiene equivalente de madvise para una vista ya creada
+}
+
+void MappedFile::prefetch(size_t offset, size_t size) const {
+	if (!_data || offset >= _size) return;
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = const_cast<unsigned char*>(_data + offset);
+	range.NumberOfBytes = min(size, _size - offset);
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+bool MappedFile::open(const char* path) {
+	close();
+	const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return false;
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		::close(fd);
+		return false;
+	}
+	_fd = fd;
+	_size = static_cast<size_t>(info.st_size);
+	if (_size == 0) return true; // mmap de 0 bytes falla
+
+	void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED) {
+		close();
+		return false;
+	}
+	_data = static_cast<const unsigned char*>(data);
+	return true;
+}
+
+void MappedFile::close() {
+	if (_data) munmap(const_cast<unsigned char*>(_data), _size);
+	if (_fd >= 0) ::close(_fd);
+	_data = nullptr;
+	_fd = -1;
+	_size = 0;
+}
+
+bool MappedFile::isOpen() const {
+	return _fd >= 0;
+}
+
+void MappedFile::advise(MapAccess access) const {
+	if (!_data) return;
+	const int advice = access == MapAccess::Sequential ? MADV_SEQUENTIAL : access == MapAccess::Random ? MADV_RANDOM : MADV_NORMAL;
+	madvise(const_cast<unsigned char*>(_data), _size, advice);
+}
+
+void MappedFile::prefetch(size_t offset, size_t size) const {
+	if (!_data || offset >= _size) return;
+	// madvise necesita una direccion alineada a pagina
+	const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	const size_t begin = offset / page * page;
+	const size_t end = min(_size, offset + size);
+	madvise(const_cast<unsigned char*>(_data + begin), end - begin, MADV_WILLNEED);
+}
+
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+
+// Fichero de solo lectura proyectado en memoria (mmap / MapViewOfFile).
+// Las paginas se leen del disco la primera vez que se tocan; advise() y
+// prefetch() le dicen al sistema como se va a leer para que adelante la lectura.
+enum class MapAccess { Normal, Sequential, Random };
+
+class MappedFile {
+
+	const unsigned char* _data = nullptr;
+	size_t _size = 0;
+#ifdef _WIN32
+	void* _file = nullptr;
+	void* _mapping = nullptr;
+#else
+	int _fd = -1;
+#endif
+
+public:
+	MappedFile() = default;
+	~MappedFile() { close(); }
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	// false si no existe o no se puede proyectar (un fichero vacio se abre con data() nulo)
+	bool open(const char* path);
+	void close();
+	bool isOpen() const;
+
+	const unsigned char* data() const { return _data; }
+	size_t size() const { return _size; }
+
+	void advise(MapAccess access) const;
+	// Pide al sistema que vaya leyendo [offset, offset + size) en segundo plano
+	void prefetch(size_t offset, size_t size) const;
+};
@@ -0,0 +1,150 @@
+#include "MemoryTracker.h"
+#include <imgui.h>
+#include <atomic>
+#include <cstdlib>
+using namespace std;
+
+namespace
+{
+	struct TagCounters
+	{
+		atomic<int64_t> current{ 0 };
+		atomic<int64_t> peak{ 0 };
+		atomic<int64_t> allocations{ 0 };
+		atomic<int64_t> frees{ 0 };
+	};
+
+	TagCounters tags[static_cast<int>(MemTag::COUNT)];
+
+	// Cabecera delante de cada bloque de ImGui para saber su tamano al liberarlo
+	const size_t IMGUI_HEADER = alignof(max_align_t) > sizeof(size_t) ? alignof(max_align_t) : sizeof(size_t);
+
+	void* imguiAlloc(size_t size, void*)
+	{
+		char* block = static_cast<char*>(malloc(size + IMGUI_HEADER));
+		if (!block) return nullptr;
+		*reinterpret_cast<size_t*>(block) = size;
+		MemoryTracker::add(MemTag::ImGui, size);
+		return block + IMGUI_HEADER;
+	}
+
+	void imguiFree(void* ptr, void*)
+	{
+		if (!ptr) return;
+		char* block = static_cast<char*>(ptr) - IMGUI_HEADER;
+		MemoryTracker::remove(MemTag::ImGui, *reinterpret_cast<size_t*>(block));
+		free(block);
+	}
+
+	void formatBytes(char* out, size_t outSize, int64_t bytes)
+	{
+		if (bytes >= 1024 * 1024) snprintf(out, outSize, "%.2f MB", bytes / (1024.0 * 1024.0));
+		else if (bytes >= 1024) snprintf(out, outSize, "%.1f KB", bytes / 1024.0);
+		else snprintf(out, outSize, "%lld B", static_cast<long long>(bytes));
+	}
+}
+
+void MemoryTracker::add(MemTag tag, size_t bytes)
+{
+	TagCounters& t = tags[static_cast<int>(tag)];
+	const int64_t now = t.current.fetch_add(static_cast<int64_t>(bytes), memory_order_relaxed) + static_cast<int64_t>(bytes);
+	t.allocations.fetch_add(1, memory_order_relaxed);
+	int64_t peak = t.peak.load(memory_order_relaxed);
+	while (now > peak && !t.peak.compare_exchange_weak(peak, now, memory_order_relaxed)) {}
+}
+
+void MemoryTracker::remove(MemTag tag, size_t bytes)
+{
+	TagCounters& t = tags[static_cast<int>(tag)];
+	t.current.fetch_sub(static_cast<int64_t>(bytes), memory_order_relaxed);
+	t.frees.fetch_add(1, memory_order_relaxed);
+}
+
+MemTagStats MemoryTracker::stats(MemTag tag)
+{
+	const TagCounters& t = tags[static_cast<int>(tag)];
+	MemTagStats s;
+	s.currentBytes = t.current.load(memory_order_relaxed);
+	s.peakBytes = t.peak.load(memory_order_relaxed);
+	s.allocations = t.allocations.load(memory_order_relaxed);
+	s.frees = t.frees.load(memory_order_relaxed);
+	return s;
+}
+
+const char* MemoryTracker::tagName(MemTag tag)
+{
+	switch (tag) {
+	case MemTag::MeshCPU: return "Mallas (CPU)";
+	case MemTag::Importer: return "Importador";
+	case MemTag::ImGui: return "ImGui";
+	case MemTag::Arenas: return "Arenas de frame";
+	case MemTag::GpuBuffers: return "Buffers GL";
+	case MemTag::Textures: return "Texturas";
+	case MemTag::RenderTargets: return "Render targets";
+	default: return "?";
+	}
+}
+
+bool MemoryTracker::isGpu(MemTag tag)
+{
+	return tag == MemTag::GpuBuffers || tag == MemTag::Textures || tag == MemTag::RenderTargets;
+}
+
+void MemoryTracker::installImGuiAllocator()
+{
+	ImGui::SetAllocatorFunctions(imguiAlloc, imguiFree, nullptr);
+}
+
+void MemoryTracker::writeJson(FILE* f, const char* indent)
+{
+	fprintf(f, "{\n");
+	for (int i = 0; i < static_cast<int>(MemTag::COUNT); i++) {
+		const MemTag tag = static_cast<MemTag>(i);
+		const MemTagStats s = stats(tag);
+		fprintf(f, "%s  \"%s\": { \"gpu\": %s, \"current_bytes\": %lld, \"peak_bytes\": %lld, \"allocations\": %lld, \"frees\": %lld }%s\n",
+			indent, tagName(tag), isGpu(tag) ? "true" : "false",
+			static_cast<long long>(s.currentBytes), static_cast<long long>(s.peakBytes),
+			static_cast<long long>(s.allocations), static_cast<long long>(s.frees),
+			i + 1 < static_cast<int>(MemTag::COUNT) ? "," : "");
+	}
+	fprintf(f, "%s}", indent);
+}
+
+void MemoryTracker::drawImGui()
+{
+	if (!ImGui::Begin("Memoria")) {
+		ImGui::End();
+		return;
+	}
+
+	int64_t totalCpu = 0, totalGpu = 0;
+	char current[32], peak[32];
+	if (ImGui::BeginTable("##memoria", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+		ImGui::TableSetupColumn("Etiqueta");
+		ImGui::TableSetupColumn("Actual");
+		ImGui::TableSetupColumn("Pico");
+		ImGui::TableSetupColumn("Reservas");
+		ImGui::TableSetupColumn("Vivas");
+		ImGui::TableHeadersRow();
+		for (int i = 0; i < static_cast<int>(MemTag::COUNT); i++) {
+			const MemTag tag = static_cast<MemTag>(i);
+			const MemTagStats s = stats(tag);
+			(isGpu(tag) ? totalGpu : totalCpu) += s.currentBytes;
+			formatBytes(current, sizeof(current), s.currentBytes);
+			formatBytes(peak, sizeof(peak), s.peakBytes);
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::Text("%s%s", tagName(tag), isGpu(tag) ? " (VRAM)" : "");
+			ImGui::TableNextColumn(); ImGui::TextUnformatted(current);
+			ImGui::TableNextColumn(); ImGui::TextUnformatted(peak);
+			ImGui::TableNextColumn(); ImGui::Text("%lld", static_cast<long long>(s.allocations));
+			ImGui::TableNextColumn(); ImGui::Text("%lld", static_cast<long long>(s.allocations - s.frees));
+		}
+		ImGui::EndTable();
+	}
+
+	formatBytes(current, sizeof(current), totalCpu);
+	formatBytes(peak, sizeof(peak), totalGpu);
+	ImGui::Text("Total CPU: %s   VRAM estimada: %s", current, peak);
+	ImGui::End();
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdio.h>
+#include <vector>
+
+// Contabilidad de memoria por subsistema.
+// Cada etiqueta guarda bytes actuales, pico y numero de reservas/liberaciones.
+// Las etiquetas de GPU son una estimacion de VRAM a partir del tamano de los
+// buffers y texturas que creamos (el driver puede reservar algo mas).
+enum class MemTag { MeshCPU, Importer, ImGui, Arenas, GpuBuffers, Textures, RenderTargets, COUNT };
+
+struct MemTagStats
+{
+	int64_t currentBytes = 0;
+	int64_t peakBytes = 0;
+	int64_t allocations = 0;
+	int64_t frees = 0;
+};
+
+namespace MemoryTracker
+{
+	void add(MemTag tag, size_t bytes);
+	void remove(MemTag tag, size_t bytes);
+
+	MemTagStats stats(MemTag tag);
+	const char* tagName(MemTag tag);
+	bool isGpu(MemTag tag);
+
+	// Bytes que ocupa de verdad un vector (capacidad, no tamano)
+	template<class T>
+	size_t vectorBytes(const std::vector<T>& v) { return v.capacity() * sizeof(T); }
+
+	// Hace que ImGui reserve a traves del tracker. Antes de ImGui::CreateContext.
+	void installImGuiAllocator();
+
+	// Objeto JSON con una entrada por etiqueta
+	void writeJson(FILE* f, const char* indent);
+
+	// Ventana de ImGui "Memoria"
+	void drawImGui();
+}
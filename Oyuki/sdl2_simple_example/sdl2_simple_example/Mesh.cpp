@@ -0,0 +1,383 @@
+#include "Mesh.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "MemoryTracker.h"
+#include "FrameArena.h"
+#include "Resources.h"
+#include "SimdMath.h"
+#include "Pak.h"
+#include <assimp/cimport.h>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <IL/il.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdio.h>
+using namespace std;
+
+void convertVertices(const aiMesh* mesh, float scaleFactor, MeshData& meshData)
+{
+	// Cada atributo se dimensiona una vez y se convierte entero como un flujo de floats
+	// (aiVector3D son xyz seguidos), sin comprobar en cada vrtex si existe
+	const unsigned int count = mesh->mNumVertices;
+	meshData.vertices.resize(count);
+	meshData.normals.resize(mesh->HasNormals() ? count : 0);
+	meshData.texCoords.clear();
+	meshData.texCoordsFloat.clear();
+	if (count == 0) {
+		meshData.boundsMin = meshData.boundsMax = glm::vec3(0.0f);
+		return;
+	}
+
+	SimdMath::scaleFloats(&mesh->mVertices[0].x, count * 3, scaleFactor, &meshData.vertices[0].x);
+	if (!meshData.normals.empty()) SimdMath::packNormals(&mesh->mNormals[0].x, count, meshData.normals.data());
+	// Coordenadas de textura (si estn disponibles); la z se descarta.
+	// En half float solo si todas caben en HALF_TEXCOORD_LIMIT
+	if (mesh->HasTextureCoords(0)) {
+		const float* uvw = &mesh->mTextureCoords[0][0].x;
+		glm::vec3 uvMin, uvMax;
+		SimdMath::pointBounds(uvw, count, uvMin, uvMax);
+		const glm::vec3 extent = glm::max(glm::abs(uvMin), glm::abs(uvMax));
+		if (extent.x <= HALF_TEXCOORD_LIMIT && extent.y <= HALF_TEXCOORD_LIMIT) {
+			meshData.texCoords.resize(count);
+			SimdMath::packTexCoords(uvw, count, meshData.texCoords.data());
+		}
+		else {
+			meshData.texCoordsFloat.resize(count);
+			for (unsigned int i = 0; i < count; i++) meshData.texCoordsFloat[i] = glm::vec2(uvw[i * 3], uvw[i * 3 + 1]);
+		}
+	}
+
+	// AABB sobre los vrtexs originales; una escala negativa intercambia min y max
+	glm::vec3 bmin, bmax;
+	SimdMath::pointBounds(&mesh->mVertices[0].x, count, bmin, bmax);
+	meshData.boundsMin = glm::min(bmin * scaleFactor, bmax * scaleFactor);
+	meshData.boundsMax = glm::max(bmin * scaleFactor, bmax * scaleFactor);
+}
+
+void convertFaces(const aiMesh* mesh, MeshData& meshData)
+{
+	// ndexs de triangles (3 per triangle)
+	meshData.triangles.reserve(meshData.triangles.size() + mesh->mNumFaces);
+	for (unsigned int f = 0; f < mesh->mNumFaces; f++) 
+	{
+		const aiFace& face = mesh->mFaces[f];
+		if (face.mNumIndices != 3) {
+			printf("Advertencia: Face %u no es un tringulo (tiene %u ndices)\n",
+				f, face.mNumIndices);
+			continue;
+		}
+		meshData.triangles.emplace_back(face.mIndices, face.mIndices + 3);
+	}
+}
+
+void flattenIndices(const MeshData& meshData, pmr::vector<unsigned int>& allIndices)
+{
+	allIndices.clear();
+	allIndices.reserve(meshData.triangles.size() * 3);
+	for (const auto& triangle : meshData.triangles) {
+		allIndices.insert(allIndices.end(), triangle.begin(), triangle.end());
+	}
+}
+
+size_t meshCpuBytes(const MeshData& meshData)
+{
+	size_t bytes = MemoryTracker::vectorBytes(meshData.vertices) + MemoryTracker::vectorBytes(meshData.colors)
+		+ MemoryTracker::vectorBytes(meshData.normals) + MemoryTracker::vectorBytes(meshData.texCoords)
+		+ MemoryTracker::vectorBytes(meshData.texCoordsFloat)
+		+ MemoryTracker::vectorBytes(meshData.triangles) + meshData.bvh.bytes();
+	for (const auto& triangle : meshData.triangles) bytes += MemoryTracker::vectorBytes(triangle);
+	return bytes;
+}
+
+glm::vec2 texCoordAt(const MeshData& meshData, size_t i)
+{
+	if (i < meshData.texCoordsFloat.size()) return meshData.texCoordsFloat[i];
+	if (i < meshData.texCoords.size()) {
+		const uint32_t packed = meshData.texCoords[i];
+		return glm::vec2(SimdMath::halfToFloat(packed & 0xFFFFu), SimdMath::halfToFloat(packed >> 16));
+	}
+	return glm::vec2(0.0f);
+}
+
+namespace
+{
+	// FNV-1a sobre palabras de 64 bits (el resto byte a byte)
+	void hashBytes(uint64_t& hash, const void* data, size_t size)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			uint64_t word;
+			memcpy(&word, bytes + i, sizeof(word));
+			hash = (hash ^ word) * 0x100000001B3ull;
+		}
+		for (; i < size; i++) hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+	}
+}
+
+uint64_t meshContentHash(const MeshData& meshData)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	hashBytes(hash, meshData.vertices.data(), meshData.vertices.size() * sizeof(glm::vec3));
+	hashBytes(hash, meshData.normals.data(), meshData.normals.size() * sizeof(uint32_t));
+	hashBytes(hash, meshData.texCoords.data(), meshData.texCoords.size() * sizeof(uint32_t));
+	hashBytes(hash, meshData.texCoordsFloat.data(), meshData.texCoordsFloat.size() * sizeof(glm::vec2));
+	for (const auto& triangle : meshData.triangles) hashBytes(hash, triangle.data(), triangle.size() * sizeof(unsigned int));
+	// Los tamanos tambien cuentan: mismos bytes repartidos de otra forma no es la misma malla
+	const uint64_t sizes[] = { meshData.vertices.size(), meshData.normals.size(), meshData.texCoords.size(),
+		meshData.texCoordsFloat.size(), meshData.triangles.size() };
+	hashBytes(hash, sizes, sizeof(sizes));
+	return hash;
+}
+
+uint64_t imageContentHash(const DecodedImage& image)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	hashBytes(hash, image.rgba.data(), image.rgba.size());
+	const int sizes[] = { image.width, image.height };
+	hashBytes(hash, sizes, sizeof(sizes));
+	return hash;
+}
+
+void LoadToBuffers(MeshData& meshData, LinearArena& scratch) 
+{
+	PROFILE_FUNCTION();
+	glGenVertexArrays(1, &meshData.vao);
+	glGenBuffers(1, &meshData.vbo);
+	glGenBuffers(1, &meshData.ebo);
+	glGenBuffers(1, &meshData.normalVBO);
+	glGenBuffers(1, &meshData.textureVBO);
+
+	glBindVertexArray(meshData.vao);
+
+	// Cargar vrtices
+	glBindBuffer(GL_ARRAY_BUFFER, meshData.vbo);
+	glBufferData(GL_ARRAY_BUFFER, meshData.vertices.size() * sizeof(glm::vec3),
+		meshData.vertices.data(), GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+
+	// Cargar normales
+	if (!meshData.normals.empty()) {
+		glBindBuffer(GL_ARRAY_BUFFER, meshData.normalVBO);
+		glBufferData(GL_ARRAY_BUFFER, meshData.normals.size() * sizeof(uint32_t), meshData.normals.data(), GL_STATIC_DRAW);
+		glEnableVertexAttribArray(1); // Asegrate de usar el ndice correcto
+		glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(uint32_t), (void*)0);
+	}
+
+	//Texturas
+	if (!meshData.texCoords.empty()) {
+		glBindBuffer(GL_ARRAY_BUFFER, meshData.textureVBO);
+		glBufferData(GL_ARRAY_BUFFER, meshData.texCoords.size() * sizeof(uint32_t), meshData.texCoords.data(), GL_STATIC_DRAW);
+		glEnableVertexAttribArray(2); // Atributo 2 para texturas
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(uint32_t), (void*)0); // u, v en half float
+	}
+	else if (!meshData.texCoordsFloat.empty()) {
+		glBindBuffer(GL_ARRAY_BUFFER, meshData.textureVBO);
+		glBufferData(GL_ARRAY_BUFFER, meshData.texCoordsFloat.size() * sizeof(glm::vec2), meshData.texCoordsFloat.data(), GL_STATIC_DRAW);
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0); // UVs de tiling, en float
+	}
+
+	// Cargar ndices
+	ScratchScope scope(scratch);
+	pmr::vector<unsigned int> allIndices(scope.resource());
+	flattenIndices(meshData, allIndices);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshData.ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshData.triangles.size() * sizeof(unsigned int) * 3,
+		allIndices.data(), GL_STATIC_DRAW);
+
+	meshData.gpuBytes = meshData.vertices.size() * sizeof(glm::vec3)
+		+ (meshData.normals.size() + meshData.texCoords.size()) * sizeof(uint32_t)
+		+ meshData.texCoordsFloat.size() * sizeof(glm::vec2)
+		+ meshData.triangles.size() * sizeof(unsigned int) * 3;
+	MemoryTracker::add(MemTag::GpuBuffers, meshData.gpuBytes);
+	Profiler::addCounter(Counter::BytesUploaded, meshData.gpuBytes);
+
+	glBindVertexArray(0);
+}
+
+void cleanupMeshData(MeshData& meshData) {
+	// Sin VAO la malla no llego a subirse (render por software) y puede no haber contexto
+	if (meshData.vao) {
+		glDeleteBuffers(1, &meshData.vbo);
+		glDeleteBuffers(1, &meshData.ebo);
+		glDeleteBuffers(1, &meshData.normalVBO);
+		glDeleteBuffers(1, &meshData.colorVBO);  // Nuevo: eliminar VBO de colores
+		glDeleteBuffers(1, &meshData.textureVBO);
+		glDeleteVertexArrays(1, &meshData.vao);
+	}
+
+	if (meshData.gpuBytes) MemoryTracker::remove(MemTag::GpuBuffers, meshData.gpuBytes);
+	if (meshData.cpuBytes) MemoryTracker::remove(MemTag::MeshCPU, meshData.cpuBytes);
+	meshData.gpuBytes = meshData.cpuBytes = 0;
+}
+
+ImportedModel importFBX(const char* file, ImportIO io, ImportJobs jobs)
+{
+	PROFILE_FUNCTION();
+	// Por defecto Assimp lee de un mmap (o del Pak montado) en vez de con fread
+	const struct aiScene* scene = AssimpIO::import(file,
+		aiProcess_Triangulate | aiProcess_GenNormals, io);
+	const float scaleFactor = 1.0f;
+	if (!scene) {
+		fprintf(stderr, "Error en carregar el fitxer: %s\n", aiGetErrorString());
+		return {};
+	}
+	aiMemoryInfo importInfo;
+	aiGetMemoryRequirements(scene, &importInfo);
+	MemoryTracker::add(MemTag::Importer, importInfo.total);
+
+	ImportedModel model;
+	vector<MeshData>& MayaTotal = model.meshes;
+	MayaTotal.resize(scene->mNumMeshes);
+
+	// La conversion de cada malla es independiente: una malla por job.
+	// En serie, cada malla de una en una en este hilo
+	auto convert = [scene, &MayaTotal, scaleFactor, jobs](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+		{
+			PROFILE_SCOPE("ConvertMesh");
+			convertVertices(scene->mMeshes[i], scaleFactor, MayaTotal[i]);
+			convertFaces(scene->mMeshes[i], MayaTotal[i]);
+			MayaTotal[i].bvh.build(MayaTotal[i].vertices, MayaTotal[i].triangles, jobs == ImportJobs::Parallel);
+			MayaTotal[i].cpuBytes = meshCpuBytes(MayaTotal[i]);
+			MayaTotal[i].contentHash = meshContentHash(MayaTotal[i]);
+			MemoryTracker::add(MemTag::MeshCPU, MayaTotal[i].cpuBytes);
+		}
+	};
+	if (jobs == ImportJobs::Parallel) JobSystem::parallelFor(scene->mNumMeshes, 1, convert);
+	else convert(0, scene->mNumMeshes);
+
+	// Ya esta todo convertido: la escena de Assimp se libera antes de la subida
+	aiReleaseImport(scene);
+	MemoryTracker::remove(MemTag::Importer, importInfo.total);
+	return model;
+}
+
+vector<MeshHandle> uploadModel(ImportedModel& model)
+{
+	PROFILE_FUNCTION();
+	// Una arena para todas las subidas, con sitio para los indices de la malla mas grande
+	size_t maxIndices = 0;
+	for (const auto& meshData : model.meshes) maxIndices = max(maxIndices, meshData.triangles.size() * 3);
+	LinearArena scratch(maxIndices * sizeof(unsigned int) + 64);
+	vector<MeshHandle> handles;
+	handles.reserve(model.meshes.size());
+	for (auto& meshData : model.meshes) {
+		LoadToBuffers(meshData, scratch);
+		handles.push_back(Resources::meshes.insert(move(meshData)));
+	}
+	model.meshes.clear();
+	return handles;
+}
+
+vector<MeshHandle> insertModelCpu(ImportedModel& model)
+{
+	vector<MeshHandle> handles;
+	handles.reserve(model.meshes.size());
+	for (auto& meshData : model.meshes) handles.push_back(Resources::meshes.insert(move(meshData)));
+	model.meshes.clear();
+	return handles;
+}
+
+vector<MeshHandle> LoadFBX(const char* file)
+{
+	ImportedModel model = importFBX(file);
+	return uploadModel(model);
+}
+
+DecodedImage decodeImage(const char* path)
+{
+	PROFILE_FUNCTION();
+	// Desde el archivo DevIL decodifica directamente del mapeo (o de lo descomprimido),
+	// que se prepara antes de coger el cerrojo de DevIL
+	vector<unsigned char> packed;
+	PakView view;
+	const PakEntry* entry = Pak::mounted() ? Pak::find(path) : nullptr;
+	if (entry && !Pak::read(*entry, packed, view)) {
+		fprintf(stderr, "Pak: entrada corrupta %s\n", path);
+		return DecodedImage();
+	}
+
+	// DevIL no es thread-safe (la imagen activa es global): una decodificacion a la vez
+	static once_flag ilInitialized;
+	static mutex ilMutex;
+	call_once(ilInitialized, [] { ilInit(); });
+	lock_guard<mutex> lock(ilMutex);
+
+	ILuint imageID;
+	ilGenImages(1, &imageID);
+	ilBindImage(imageID);
+
+	DecodedImage image;
+	// IL_TYPE_UNKNOWN: el formato se deduce de la cabecera, como con la extension en disco
+	const ILboolean loaded = entry ? ilLoadL(IL_TYPE_UNKNOWN, view.data, static_cast<ILuint>(view.size))
+		: ilLoadImage((const wchar_t*)path);  // Cargamos la imagen usando la ruta
+	if (!loaded) {
+		ilDeleteImages(1, &imageID);
+		return image; // Si falla, terminamos aqu
+	}
+
+	ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
+	image.width = ilGetInteger(IL_IMAGE_WIDTH);
+	image.height = ilGetInteger(IL_IMAGE_HEIGHT);
+	const unsigned char* imageData = ilGetData();
+	image.rgba.assign(imageData, imageData + static_cast<size_t>(image.width) * image.height * 4);
+	ilDeleteImages(1, &imageID);
+	return image;
+}
+
+Texture createTexture(const DecodedImage& image)
+{
+	PROFILE_FUNCTION();
+	if (image.rgba.empty()) return Texture();
+	const int width = image.width;
+	const int height = image.height;
+	GLuint textureID;
+
+	//ilLoadImage((const wchar_t* )textureID);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.rgba.data());
+	// Sin mipmaps: la textura ocupa exactamente width * height * RGBA8
+	MemoryTracker::add(MemTag::Textures, static_cast<size_t>(width) * height * 4);
+	Profiler::addCounter(Counter::BytesUploaded, static_cast<int64_t>(width) * height * 4);
+
+	Texture texture;
+	texture.id = textureID;
+	texture.width = width;
+	texture.height = height;
+	texture.contentHash = imageContentHash(image);
+	return texture;
+}
+
+TextureHandle uploadTexture(const DecodedImage& image)
+{
+	const Texture texture = createTexture(image);
+	return texture.id ? Resources::textures.insert(texture) : TextureHandle();
+}
+
+TextureHandle insertTextureCpu(DecodedImage& image)
+{
+	if (image.rgba.empty()) return TextureHandle();
+	Texture texture;
+	texture.width = image.width;
+	texture.height = image.height;
+	texture.contentHash = imageContentHash(image);
+	texture.pixels = move(image.rgba);
+	MemoryTracker::add(MemTag::Textures, texture.pixels.size());
+	return Resources::textures.insert(move(texture));
+}
+
+TextureHandle LoadText(const char* Path)
+{
+	return uploadTexture(decodeImage(Path));
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "ResourcePool.h"
+#include "AssimpIO.h"
+#include "Bvh.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+struct aiMesh;
+class LinearArena;
+struct Material;
+struct Texture;
+
+struct MeshData // Estructura para almacenar los datos de un modelo 3D
+{
+	// Los atributos ya estan en el formato de los VBO
+	std::vector<glm::vec3> vertices;
+	std::vector<std::vector<unsigned int>> triangles;
+	std::vector<glm::dvec3> colors;
+	std::vector<uint32_t> normals;   // snorm 10:10:10:2 (GL_INT_2_10_10_10_REV)
+	// Coordenadas de textura: solo una de las dos tiene datos (ver HALF_TEXCOORD_LIMIT)
+	std::vector<uint32_t> texCoords;        // u, v en half float
+	std::vector<glm::vec2> texCoordsFloat; // u, v en float, si alguna se sale del limite
+	glm::vec3 boundsMin = glm::vec3(0.0f); // AABB en espacio local
+	glm::vec3 boundsMax = glm::vec3(0.0f);
+	MeshBvh bvh; // para el picking; vacio si la malla no viene de importFBX
+	GLuint vao = 0;
+	GLuint vbo = 0;
+	GLuint ebo = 0;
+	GLuint normalVBO = 0;
+	GLuint textureVBO = 0;
+	GLuint colorVBO = 0;
+	Handle<Material> material;
+	size_t cpuBytes = 0; // registrado en MemoryTracker (MeshCPU / GpuBuffers)
+	size_t gpuBytes = 0;
+	uint64_t contentHash = 0; // de los atributos e indices; la recarga en caliente no resube si no cambia
+};
+
+// Un half float tiene 10 bits de mantisa: hasta 2.0 el paso es como mucho 1/1024
+// (un cuarto de texel en una textura de 256), pero con UVs de tiling crece
+// (1/512 hasta 4, 1/256 hasta 8...) y la textura se mueve a saltos. Si alguna
+// coordenada de la malla pasa de este valor (en absoluto) se guardan en float
+const float HALF_TEXCOORD_LIMIT = 2.0f;
+// u, v del vertice i en float, esten en half o en float; (0, 0) si no tiene
+glm::vec2 texCoordAt(const MeshData& meshData, size_t i);
+
+// Etapas de LoadFBX por separado (tambien las usan los benchmarks)
+void convertVertices(const aiMesh* mesh, float scaleFactor, MeshData& meshData);
+void convertFaces(const aiMesh* mesh, MeshData& meshData);
+void flattenIndices(const MeshData& meshData, std::pmr::vector<unsigned int>& indices);
+size_t meshCpuBytes(const MeshData& meshData);
+uint64_t meshContentHash(const MeshData& meshData);
+
+// 'scratch' guarda los datos temporales de la subida (indices aplanados)
+void LoadToBuffers(MeshData& meshData, LinearArena& scratch);
+void cleanupMeshData(MeshData& meshData);
+
+// La carga va en dos partes: la de CPU (leer y convertir) no toca OpenGL y
+// puede ir en cualquier hilo; la subida tiene que ir en el hilo del contexto.
+struct ImportedModel
+{
+	std::vector<MeshData> meshes; // vacio si el fichero no se pudo importar
+};
+// Parallel reparte las mallas (y el BVH de cada una) en jobs y espera con
+// JobSystem::wait. Desde un hilo que no es worker (el cargador de HotReload) hay
+// que usar Serial: sus jobs irian a la cola externa, la que el hilo principal
+// vacia mientras espera a los del frame, y su wait podria coger jobs del frame
+enum class ImportJobs { Parallel, Serial };
+ImportedModel importFBX(const char* file, ImportIO io = ImportIO::Mapped, ImportJobs jobs = ImportJobs::Parallel);
+// Las mallas quedan en Resources::meshes; devuelve sus handles
+std::vector<Handle<MeshData>> uploadModel(ImportedModel& model);
+// Para el render por software: las mallas entran en Resources::meshes sin subirse (vao 0)
+std::vector<Handle<MeshData>> insertModelCpu(ImportedModel& model);
+
+struct DecodedImage
+{
+	std::vector<unsigned char> rgba;
+	int width = 0;
+	int height = 0;
+};
+// DevIL se inicializa en la primera llamada; rgba vacio si no se puede cargar
+DecodedImage decodeImage(const char* path);
+uint64_t imageContentHash(const DecodedImage& image);
+// Crea la textura de OpenGL sin meterla en Resources (id 0 si la imagen esta vacia)
+Texture createTexture(const DecodedImage& image);
+// Handle nulo si la imagen esta vacia
+Handle<Texture> uploadTexture(const DecodedImage& image);
+// La textura se queda en CPU (Texture::pixels, id 0), para el render por software;
+// se lleva los pixeles de 'image'. Handle nulo si la imagen esta vacia
+Handle<Texture> insertTextureCpu(DecodedImage& image);
+
+// importFBX + uploadModel y decodeImage + uploadTexture seguidos
+std::vector<Handle<MeshData>> LoadFBX(const char* file);
+Handle<Texture> LoadText(const char* Path);
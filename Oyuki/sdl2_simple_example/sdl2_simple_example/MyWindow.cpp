@@ -5,23 +5,32 @@
 #include <imgui_impl_sdl2.h>
 #include <imgui_impl_opengl3.h>
 #include "MyWindow.h"
+#include "Profiler.h"
+#include "GpuTimer.h"
+#include "TraceCapture.h"
+#include "MemoryTracker.h"
+#include "Input.h"
+#include "Redraw.h"
 using namespace std;
 
-MyWindow::MyWindow(const std::string& title, int w, int h) : _width(w), _height(h) {
+MyWindow::MyWindow(const std::string& title, int w, int h, bool hidden) : _width(w), _height(h) {
 
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
     SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
     SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
-    _window = SDL_CreateWindow(title.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, w, h, SDL_WINDOW_OPENGL);
+    const Uint32 flags = SDL_WINDOW_OPENGL | (hidden ? SDL_WINDOW_HIDDEN : SDL_WINDOW_RESIZABLE);
+    _window = SDL_CreateWindow(title.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, w, h, flags);
     if (!_window) throw exception(SDL_GetError());
 
     _ctx = SDL_GL_CreateContext(_window);
     if (!_ctx) throw exception(SDL_GetError());
     if (SDL_GL_MakeCurrent(_window, _ctx) != 0) throw exception(SDL_GetError());
-    if (SDL_GL_SetSwapInterval(1) != 0) throw exception(SDL_GetError());
+    // Sin ventana visible no esperamos al vsync (y algunos drivers offscreen no lo soportan)
+    if (SDL_GL_SetSwapInterval(hidden ? 0 : 1) != 0 && !hidden) throw exception(SDL_GetError());
 
+    MemoryTracker::installImGuiAllocator();
     ImGui::CreateContext();
     ImGui_ImplSDL2_InitForOpenGL(_window, _ctx);
     ImGui_ImplOpenGL3_Init("#version 130");
@@ -38,10 +47,12 @@ MyWindow::~MyWindow() {
 }
 
 void MyWindow::swapBuffers() const {
+    PROFILE_SCOPE("SwapBuffers");
     SDL_GL_SwapWindow(static_cast<SDL_Window*>(_window));
 }
 
 void MyWindow::draw() {
+    PROFILE_SCOPE("ImGui");
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplSDL2_NewFrame();
     ImGui::NewFrame();
@@ -58,8 +69,18 @@ void MyWindow::draw() {
         ImGui::EndMainMenuBar();
     }
 
+    Profiler::drawImGui();
+    GpuTimer::drawImGui();
+    TraceCapture::drawImGui();
+    MemoryTracker::drawImGui();
+    Input::drawImGui();
+    Redraw::drawImGui();
+
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    {
+        GPU_SCOPE("ImGui");
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    }
 
     swapBuffers();
 }
@@ -15,8 +15,11 @@ public:
 	int width() const { return _width; }
 	int height() const { return _height; }
 	double aspectRatio() const { return static_cast<double>(_width) / _height; }
+	// Tras un SDL_WINDOWEVENT_SIZE_CHANGED
+	void resized(int w, int h) { _width = w; _height = h; }
 
-	MyWindow(const std::string& title, int w, int h);
+	// hidden: ventana oculta y sin vsync, para el modo headless
+	MyWindow(const std::string& title, int w, int h, bool hidden = false);
 	~MyWindow();
 
 	void swapBuffers() const;
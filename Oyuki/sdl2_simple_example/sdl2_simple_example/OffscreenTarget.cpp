@@ -0,0 +1,41 @@
+#include "OffscreenTarget.h"
+#include "MemoryTracker.h"
+#include <exception>
+using namespace std;
+
+OffscreenTarget::OffscreenTarget(int w, int h) : _width(w), _height(h) {
+	glGenRenderbuffers(1, &_color);
+	glBindRenderbuffer(GL_RENDERBUFFER, _color);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+
+	glGenRenderbuffers(1, &_depth);
+	glBindRenderbuffer(GL_RENDERBUFFER, _depth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &_fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _color);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depth);
+	const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE) throw exception("Offscreen framebuffer incomplete");
+	// RGBA8 + DEPTH24 (que los drivers guardan en 32 bits)
+	MemoryTracker::add(MemTag::RenderTargets, static_cast<size_t>(w) * h * 8);
+}
+
+OffscreenTarget::~OffscreenTarget() {
+	glDeleteFramebuffers(1, &_fbo);
+	glDeleteRenderbuffers(1, &_depth);
+	glDeleteRenderbuffers(1, &_color);
+	MemoryTracker::remove(MemTag::RenderTargets, static_cast<size_t>(_width) * _height * 8);
+}
+
+void OffscreenTarget::bind() const {
+	glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+	glViewport(0, 0, _width, _height);
+}
+
+void OffscreenTarget::unbind() {
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
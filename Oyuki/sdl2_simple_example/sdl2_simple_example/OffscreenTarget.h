@@ -0,0 +1,26 @@
+#pragma once
+#include <GL/glew.h>
+
+// Framebuffer propio (color RGBA8 + depth24) para renderizar sin depender del
+// framebuffer de la ventana, p.ej. en modo headless con un contexto surfaceless.
+class OffscreenTarget {
+
+	GLuint _fbo = 0;
+	GLuint _color = 0;
+	GLuint _depth = 0;
+	int _width = 0;
+	int _height = 0;
+
+public:
+	OffscreenTarget(int w, int h);
+	~OffscreenTarget();
+
+	OffscreenTarget(const OffscreenTarget&) = delete;
+	OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+	int width() const { return _width; }
+	int height() const { return _height; }
+
+	void bind() const;
+	static void unbind();
+};
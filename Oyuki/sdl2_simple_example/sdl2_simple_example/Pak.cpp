@@ -0,0 +1,348 @@
+#include "Pak.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <lz4.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <stdio.h>
+using namespace std;
+
+using hrclock = chrono::high_resolution_clock;
+
+namespace
+{
+	// Cada job descomprime unos cuantos bloques para no pagar un job por 64 KB
+	const size_t BLOCKS_PER_JOB = 4;
+
+	PakArchive archive;
+
+	uint64_t align8(uint64_t value)
+	{
+		return (value + 7) & ~uint64_t(7);
+	}
+
+	string normalizeName(const char* path)
+	{
+		string name(path);
+		replace(name.begin(), name.end(), '\\', '/');
+		return name;
+	}
+
+	bool writeAt(FILE* f, uint64_t& position, const void* data, size_t size)
+	{
+		if (size && fwrite(data, 1, size, f) != size) return false;
+		position += size;
+		return true;
+	}
+
+	bool padTo8(FILE* f, uint64_t& position)
+	{
+		static const unsigned char zeros[8] = {};
+		return writeAt(f, position, zeros, static_cast<size_t>(align8(position) - position));
+	}
+
+	// Comprime 'size' bytes por bloques en paralelo. Deja en 'stored' la tabla de
+	// tamanos seguida de los bloques; false si comprimido no ahorra lo suficiente.
+	bool compressBlocks(const unsigned char* data, size_t size, uint32_t blockSize, uint32_t blockCount, vector<unsigned char>& stored)
+	{
+		const size_t bound = static_cast<size_t>(LZ4_compressBound(static_cast<int>(blockSize)));
+		vector<unsigned char> scratch(bound * blockCount);
+		vector<uint32_t> sizes(blockCount);
+		unsigned char* out = scratch.data();
+		uint32_t* outSizes = sizes.data();
+		JobSystem::parallelFor(blockCount, BLOCKS_PER_JOB, [data, size, blockSize, bound, out, outSizes](size_t begin, size_t end) {
+			for (size_t b = begin; b < end; b++) {
+				const size_t offset = b * blockSize;
+				const int length = static_cast<int>(min<size_t>(blockSize, size - offset));
+				const int compressed = LZ4_compress_default(reinterpret_cast<const char*>(data + offset),
+					reinterpret_cast<char*>(out + b * bound), length, static_cast<int>(bound));
+				if (compressed <= 0 || compressed >= length) {
+					memcpy(out + b * bound, data + offset, length);
+					outSizes[b] = static_cast<uint32_t>(length) | PakEntry::RAW_BLOCK;
+				}
+				else {
+					outSizes[b] = static_cast<uint32_t>(compressed);
+				}
+			}
+		});
+
+		size_t total = blockCount * sizeof(uint32_t);
+		for (const uint32_t s : sizes) total += s & ~PakEntry::RAW_BLOCK;
+		if (total > size - size / 8) return false;
+
+		stored.resize(total);
+		memcpy(stored.data(), sizes.data(), blockCount * sizeof(uint32_t));
+		size_t position = blockCount * sizeof(uint32_t);
+		for (uint32_t b = 0; b < blockCount; b++) {
+			const size_t length = sizes[b] & ~PakEntry::RAW_BLOCK;
+			memcpy(stored.data() + position, out + b * bound, length);
+			position += length;
+		}
+		return true;
+	}
+}
+
+bool PakArchive::open(const char* path) {
+	close();
+	if (!_file.open(path)) return false;
+	const unsigned char* data = _file.data();
+	const size_t size = _file.size();
+	const PakHeader* header = reinterpret_cast<const PakHeader*>(data);
+	const bool valid = size >= sizeof(PakHeader) && header->magic == PakHeader::MAGIC && header->version == PakHeader::VERSION
+		&& header->blockSize > 0 && header->indexOffset <= size
+		&& header->entryCount <= (size - header->indexOffset) / sizeof(PakEntry)
+		&& header->namesOffset >= header->indexOffset + header->entryCount * sizeof(PakEntry) && header->namesOffset <= size;
+	if (!valid) {
+		fprintf(stderr, "Pak: %s no es un archivo valido\n", path);
+		_file.close();
+		return false;
+	}
+	_header = header;
+	_entries = reinterpret_cast<const PakEntry*>(data + header->indexOffset);
+	_names = reinterpret_cast<const char*>(data + header->namesOffset);
+	// Las entradas se leen salteadas; el indice se consulta en cada busqueda
+	_file.advise(MapAccess::Random);
+	_file.prefetch(header->indexOffset, size - header->indexOffset);
+	return true;
+}
+
+void PakArchive::close() {
+	_file.close();
+	_header = nullptr;
+	_entries = nullptr;
+	_names = nullptr;
+}
+
+string PakArchive::name(const PakEntry& entry) const {
+	const size_t namesSize = _file.size() - _header->namesOffset;
+	if (entry.nameOffset > namesSize || entry.nameLength > namesSize - entry.nameOffset) return string();
+	return string(_names + entry.nameOffset, entry.nameLength);
+}
+
+const PakEntry* PakArchive::find(const string& name) const {
+	if (!_header) return nullptr;
+	const uint64_t hash = Pak::hashName(name);
+	const PakEntry* end = _entries + _header->entryCount;
+	const PakEntry* it = lower_bound(_entries, end, hash, [](const PakEntry& e, uint64_t h) { return e.hash < h; });
+	for (; it != end && it->hash == hash; ++it) {
+		if (it->nameLength == name.size() && this->name(*it) == name) return it;
+	}
+	return nullptr;
+}
+
+bool PakArchive::read(const PakEntry& entry, vector<unsigned char>& storage, PakView& view) const {
+	PROFILE_FUNCTION();
+	const size_t fileSize = _file.size();
+	if (entry.offset > fileSize || entry.storedSize > fileSize - entry.offset) return false;
+	const unsigned char* stored = _file.data() + entry.offset;
+	_file.prefetch(static_cast<size_t>(entry.offset), static_cast<size_t>(entry.storedSize));
+
+	if (!(entry.flags & PakEntry::COMPRESSED)) {
+		if (entry.storedSize != entry.size) return false;
+		view.data = stored;
+		view.size = static_cast<size_t>(entry.size);
+		return true;
+	}
+
+	const uint32_t blockSize = _header->blockSize;
+	const uint32_t blockCount = entry.blockCount;
+	if (blockCount != (entry.size + blockSize - 1) / blockSize) return false;
+	const size_t tableBytes = blockCount * sizeof(uint32_t);
+	if (tableBytes > entry.storedSize) return false;
+
+	// Posicion de cada bloque dentro de la entrada: los jobs empiezan a la vez
+	vector<uint64_t> offsets(blockCount + 1);
+	offsets[0] = tableBytes;
+	for (uint32_t b = 0; b < blockCount; b++) {
+		uint32_t storedLength;
+		memcpy(&storedLength, stored + b * sizeof(uint32_t), sizeof(uint32_t));
+		offsets[b + 1] = offsets[b] + (storedLength & ~PakEntry::RAW_BLOCK);
+	}
+	if (offsets[blockCount] != entry.storedSize) return false;
+
+	storage.resize(static_cast<size_t>(entry.size));
+	unsigned char* out = storage.data();
+	const uint64_t* blockOffsets = offsets.data();
+	const size_t size = storage.size();
+	atomic<bool> corrupt{ false };
+	atomic<bool>* failed = &corrupt;
+	JobSystem::parallelFor(blockCount, BLOCKS_PER_JOB, [stored, out, size, blockSize, blockOffsets, failed](size_t begin, size_t end) {
+		for (size_t b = begin; b < end; b++) {
+			const size_t offset = b * blockSize;
+			const int length = static_cast<int>(min<size_t>(blockSize, size - offset));
+			const int storedLength = static_cast<int>(blockOffsets[b + 1] - blockOffsets[b]);
+			uint32_t tableValue;
+			memcpy(&tableValue, stored + b * sizeof(uint32_t), sizeof(uint32_t));
+			const char* src = reinterpret_cast<const char*>(stored + blockOffsets[b]);
+			if (tableValue & PakEntry::RAW_BLOCK) {
+				if (storedLength != length) failed->store(true, memory_order_relaxed);
+				else memcpy(out + offset, src, length);
+			}
+			else if (LZ4_decompress_safe(src, reinterpret_cast<char*>(out + offset), storedLength, length) != length) {
+				failed->store(true, memory_order_relaxed);
+			}
+		}
+	});
+	if (corrupt.load()) {
+		storage.clear();
+		return false;
+	}
+	view.data = storage.data();
+	view.size = storage.size();
+	return true;
+}
+
+uint64_t Pak::hashName(const string& name)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (const char c : name) {
+		hash ^= static_cast<unsigned char>(c == '\\' ? '/' : c);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+void Pak::collect(const char* root, vector<PakInput>& inputs)
+{
+	error_code error;
+	const filesystem::path rootPath(root);
+	if (!filesystem::is_directory(rootPath, error)) {
+		inputs.push_back({ rootPath.filename().generic_string(), rootPath.string() });
+		return;
+	}
+	for (filesystem::recursive_directory_iterator it(rootPath, error), end; !error && it != end; it.increment(error)) {
+		if (!it->is_regular_file(error)) continue;
+		inputs.push_back({ it->path().lexically_relative(rootPath).generic_string(), it->path().string() });
+	}
+}
+
+bool Pak::write(const char* path, const vector<PakInput>& inputs, uint32_t blockSize)
+{
+	PROFILE_FUNCTION();
+	const auto t0 = hrclock::now();
+
+	// Indice en orden de hash; los datos se escriben en el orden de entrada
+	vector<size_t> order(inputs.size());
+	vector<PakEntry> entries(inputs.size());
+	for (size_t i = 0; i < inputs.size(); i++) {
+		order[i] = i;
+		entries[i] = PakEntry();
+		entries[i].hash = hashName(inputs[i].name);
+	}
+	sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		return entries[a].hash != entries[b].hash ? entries[a].hash < entries[b].hash : inputs[a].name < inputs[b].name;
+	});
+	for (size_t i = 1; i < order.size(); i++) {
+		if (normalizeName(inputs[order[i]].name.c_str()) == normalizeName(inputs[order[i - 1]].name.c_str())) {
+			fprintf(stderr, "Pak: entrada repetida %s\n", inputs[order[i]].name.c_str());
+			return false;
+		}
+	}
+
+	FILE* f = fopen(path, "wb");
+	if (!f) {
+		fprintf(stderr, "Pak: no se puede crear %s\n", path);
+		return false;
+	}
+	PakHeader header = {};
+	header.magic = PakHeader::MAGIC;
+	header.version = PakHeader::VERSION;
+	header.entryCount = static_cast<uint32_t>(inputs.size());
+	header.blockSize = blockSize;
+	uint64_t position = 0;
+	bool ok = writeAt(f, position, &header, sizeof(header));
+
+	uint64_t originalBytes = 0;
+	vector<unsigned char> stored;
+	for (size_t i = 0; ok && i < inputs.size(); i++) {
+		MappedFile input;
+		if (!input.open(inputs[i].path.c_str())) {
+			fprintf(stderr, "Pak: no se puede leer %s\n", inputs[i].path.c_str());
+			ok = false;
+			break;
+		}
+		input.advise(MapAccess::Sequential);
+		PakEntry& entry = entries[i];
+		entry.size = input.size();
+		entry.blockCount = static_cast<uint32_t>((entry.size + blockSize - 1) / blockSize);
+		ok = padTo8(f, position);
+		entry.offset = position;
+		if (entry.size && compressBlocks(input.data(), input.size(), blockSize, entry.blockCount, stored)) {
+			entry.flags = PakEntry::COMPRESSED;
+			ok = ok && writeAt(f, position, stored.data(), stored.size());
+		}
+		else {
+			ok = ok && writeAt(f, position, input.data(), input.size());
+		}
+		entry.storedSize = position - entry.offset;
+		originalBytes += entry.size;
+	}
+
+	string names;
+	vector<PakEntry> index;
+	index.reserve(entries.size());
+	for (const size_t i : order) {
+		PakEntry entry = entries[i];
+		const string name = normalizeName(inputs[i].name.c_str());
+		entry.nameOffset = static_cast<uint32_t>(names.size());
+		entry.nameLength = static_cast<uint32_t>(name.size());
+		names += name;
+		index.push_back(entry);
+	}
+	ok = ok && padTo8(f, position);
+	header.indexOffset = position;
+	ok = ok && writeAt(f, position, index.data(), index.size() * sizeof(PakEntry));
+	header.namesOffset = position;
+	ok = ok && writeAt(f, position, names.data(), names.size());
+	// La cabecera definitiva al final: un archivo a medias no pasa la validacion
+	ok = ok && fseek(f, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, f) == 1;
+	ok = fclose(f) == 0 && ok;
+	if (!ok) {
+		fprintf(stderr, "Pak: error al escribir %s\n", path);
+		::remove(path);
+		return false;
+	}
+
+	const double ms = chrono::duration<double, milli>(hrclock::now() - t0).count();
+	printf("Pak: %s, %zu entradas, %.2f MB -> %.2f MB en %.1f ms\n", path, inputs.size(),
+		originalBytes / (1024.0 * 1024.0), position / (1024.0 * 1024.0), ms);
+	return true;
+}
+
+bool Pak::mount(const char* path)
+{
+	if (!archive.open(path)) return false;
+	printf("Pak: %s montado, %zu entradas\n", path, archive.entryCount());
+	return true;
+}
+
+void Pak::unmount()
+{
+	archive.close();
+}
+
+bool Pak::mounted()
+{
+	return archive.isOpen();
+}
+
+const PakEntry* Pak::find(const char* path)
+{
+	if (!archive.isOpen()) return nullptr;
+	const string name = normalizeName(path);
+	for (size_t start = 0; start < name.size();) {
+		if (const PakEntry* entry = archive.find(name.substr(start))) return entry;
+		const size_t slash = name.find('/', start);
+		if (slash == string::npos) break;
+		start = slash + 1;
+	}
+	return nullptr;
+}
+
+bool Pak::read(const PakEntry& entry, vector<unsigned char>& storage, PakView& view)
+{
+	return archive.read(entry, storage, view);
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Archivo de assets empaquetados (.pak): un solo fichero proyectado en memoria
+// con un indice ordenado por hash del nombre.
+// Formato (little endian, cada seccion alineada a 8 bytes):
+//   PakHeader
+//   datos de cada entrada: tal cual, o una tabla con un uint32 por bloque (lo
+//     que ocupa comprimido; el bit alto indica que el bloque se guardo sin
+//     comprimir porque no ganaba nada) seguida de los bloques LZ4
+//   PakEntry[entryCount] ordenadas por hash
+//   nombres de las entradas seguidos, sin terminador
+struct PakHeader
+{
+	static const uint32_t MAGIC = 0x4B50594F; // "OYPK"
+	static const uint32_t VERSION = 1;
+
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t blockSize;
+	uint64_t indexOffset;
+	uint64_t namesOffset;
+};
+
+struct PakEntry
+{
+	static const uint32_t COMPRESSED = 1;
+	static const uint32_t RAW_BLOCK = 0x80000000u;
+
+	uint64_t hash;       // Pak::hashName del nombre
+	uint64_t offset;     // desde el principio del archivo
+	uint64_t size;       // tamano original
+	uint64_t storedSize; // lo que ocupa en el archivo (tabla de bloques incluida)
+	uint32_t blockCount;
+	uint32_t flags;
+	uint32_t nameOffset; // dentro de la tabla de nombres
+	uint32_t nameLength;
+};
+
+// Bytes de una entrada. Si no esta comprimida apunta directamente al mapeo.
+struct PakView
+{
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+};
+
+class PakArchive {
+
+	MappedFile _file;
+	const PakHeader* _header = nullptr;
+	const PakEntry* _entries = nullptr;
+	const char* _names = nullptr;
+
+public:
+	// false si no existe o la cabecera/indice no son validos
+	bool open(const char* path);
+	void close();
+	bool isOpen() const { return _header != nullptr; }
+
+	size_t entryCount() const { return _header ? _header->entryCount : 0; }
+	const PakEntry& entry(size_t i) const { return _entries[i]; }
+	std::string name(const PakEntry& entry) const;
+
+	// Busqueda binaria por hash y comparacion del nombre; nullptr si no esta
+	const PakEntry* find(const std::string& name) const;
+
+	// Sin comprimir no copia nada; si esta comprimida se descomprime en 'storage'
+	// con un job por grupo de bloques. false si los datos estan corruptos.
+	// Se puede llamar desde varios hilos a la vez.
+	bool read(const PakEntry& entry, std::vector<unsigned char>& storage, PakView& view) const;
+};
+
+struct PakInput
+{
+	std::string name; // el separador es siempre '/'
+	std::string path; // en disco
+};
+
+namespace Pak
+{
+	const uint32_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+	// FNV-1a de 64 bits con '\' tratado como '/'
+	uint64_t hashName(const std::string& name);
+
+	// Los ficheros de 'root' (recursivo, nombres relativos a root) o el propio fichero
+	void collect(const char* root, std::vector<PakInput>& inputs);
+	// Crea el archivo. Una entrada se comprime si ahorra al menos 1/8; si no, se
+	// guarda tal cual y se lee sin copias.
+	bool write(const char* path, const std::vector<PakInput>& inputs, uint32_t blockSize = DEFAULT_BLOCK_SIZE);
+
+	// Archivo global del que leen importFBX y decodeImage. Antes de empezar a cargar.
+	bool mount(const char* path);
+	void unmount();
+	bool mounted();
+
+	// Prueba la ruta entera y despues quitando directorios del principio, para que
+	// "C:/Assets/modelos/casa.fbx" encuentre la entrada "modelos/casa.fbx"
+	const PakEntry* find(const char* path);
+	bool read(const PakEntry& entry, std::vector<unsigned char>& storage, PakView& view);
+}
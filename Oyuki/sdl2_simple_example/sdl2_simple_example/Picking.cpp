@@ -0,0 +1,124 @@
+#include "Picking.h"
+#include "FrameArena.h"
+#include "Profiler.h"
+#include "SimdMath.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+using namespace std;
+
+namespace
+{
+	struct Candidate
+	{
+		size_t pos;     // en scene.bounds
+		float distance; // entrada en la caja
+	};
+}
+
+void Picking::screenRay(int x, int y, int width, int height, const glm::mat4& inverseViewProjection,
+	glm::vec3& origin, glm::vec3& direction)
+{
+	// Centro del pixel en NDC, de z = -1 (plano cercano) a z = 1 (lejano)
+	const float ndcX = (x + 0.5f) / width * 2.0f - 1.0f;
+	const float ndcY = 1.0f - (y + 0.5f) / height * 2.0f;
+	glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+	glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+	nearPoint /= nearPoint.w;
+	farPoint /= farPoint.w;
+	origin = glm::vec3(nearPoint);
+	direction = glm::normalize(glm::vec3(farPoint - nearPoint));
+}
+
+bool Picking::pick(const Scene& scene, const glm::vec3& origin, const glm::vec3& direction, PickHit& hit)
+{
+	PROFILE_FUNCTION();
+	const ComponentStore<Bounds>& bounds = scene.bounds;
+	const float o[3] = { origin.x, origin.y, origin.z };
+	float inv[3];
+	for (int c = 0; c < 3; c++) {
+		const float d = fabsf(direction[c]) < 1e-20f ? copysignf(1e-20f, direction[c]) : direction[c];
+		inv[c] = 1.0f / d;
+	}
+
+	// Fase amplia: cajas de mundo de 4 en 4 (el relleno es una caja en +infinito)
+	ScratchScope scratch;
+	pmr::vector<Candidate> candidates(scratch.resource());
+	const float far = numeric_limits<float>::max();
+	float boxes[24];
+	for (size_t base = 0; base < bounds.size(); base += 4) {
+		const size_t n = min<size_t>(4, bounds.size() - base);
+		fill(begin(boxes), end(boxes), numeric_limits<float>::infinity());
+		for (size_t k = 0; k < n; k++) {
+			const Bounds& b = bounds.at(base + k);
+			for (int c = 0; c < 3; c++) {
+				boxes[c * 4 + k] = b.worldMin[c];
+				boxes[12 + c * 4 + k] = b.worldMax[c];
+			}
+		}
+		float tNear[4];
+		const int mask = SimdMath::rayAabb4(o, inv, boxes, far, tNear);
+		for (size_t k = 0; k < n; k++) {
+			if (mask & (1 << k)) candidates.push_back({ base + k, tNear[k] });
+		}
+	}
+	sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.distance < b.distance; });
+
+	// Fase fina: de la caja mas cercana a la mas lejana mientras pueda haber algo delante
+	float best = far;
+	bool found = false;
+	for (const Candidate& candidate : candidates) {
+		if (candidate.distance > best) break;
+		const Entity entity = bounds.entityAt(candidate.pos);
+		const MeshRenderer* renderer = scene.renderers.get(entity);
+		const MeshData* mesh = renderer ? Resources::meshes.get(renderer->mesh) : nullptr;
+		const Transform* transform = scene.transforms.get(entity);
+		if (!mesh || !transform) continue;
+
+		if (mesh->bvh.empty()) {
+			best = candidate.distance;
+			found = true;
+			hit = PickHit();
+			hit.entity = entity;
+			hit.distance = candidate.distance;
+			hit.point = origin + direction * candidate.distance;
+			hit.normal = -direction;
+			continue;
+		}
+
+		// En local la direccion deja de ser unitaria, pero la distancia del rayo es la misma
+		const glm::mat4 toLocal = glm::inverse(transform->world);
+		const glm::vec3 localOrigin = glm::vec3(toLocal * glm::vec4(origin, 1.0f));
+		const glm::vec3 localDirection = glm::vec3(toLocal * glm::vec4(direction, 0.0f));
+		BvhHit local;
+		if (!mesh->bvh.intersect(localOrigin, localDirection, best, local)) continue;
+
+		best = local.distance;
+		found = true;
+		hit.entity = entity;
+		hit.distance = local.distance;
+		hit.point = origin + direction * local.distance;
+		hit.triangle = local.triangle;
+		hit.exact = true;
+
+		// Normal de la cara con la inversa traspuesta, girada hacia el rayo
+		const auto& t = mesh->triangles[local.triangle];
+		const glm::vec3 v0 = mesh->vertices[t[0]];
+		const glm::vec3 faceNormal = glm::mat3(glm::transpose(toLocal)) * glm::cross(mesh->vertices[t[1]] - v0, mesh->vertices[t[2]] - v0);
+		const float length = glm::length(faceNormal);
+		hit.normal = length > 0.0f ? faceNormal / length : -direction;
+		if (glm::dot(hit.normal, direction) > 0.0f) hit.normal = -hit.normal;
+	}
+	return found;
+}
+
+bool Picking::rayPlane(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& planePoint,
+	const glm::vec3& planeNormal, glm::vec3& point)
+{
+	const float denominator = glm::dot(direction, planeNormal);
+	if (fabsf(denominator) < 1e-6f) return false;
+	const float t = glm::dot(planePoint - origin, planeNormal) / denominator;
+	if (t < 0.0f) return false;
+	point = origin + direction * t;
+	return true;
+}
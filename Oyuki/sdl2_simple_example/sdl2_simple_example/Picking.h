@@ -0,0 +1,33 @@
+#pragma once
+#include "Scene.h"
+#include <glm/glm.hpp>
+
+struct PickHit
+{
+	Entity entity;
+	float distance = 0.0f;      // en unidades de mundo si la direccion es unitaria
+	glm::vec3 point = glm::vec3(0.0f);  // en mundo
+	glm::vec3 normal = glm::vec3(0.0f); // en mundo, unitaria y hacia el rayo
+	uint32_t triangle = 0;      // en MeshData::triangles; solo si exact
+	bool exact = false;         // false: la malla no tiene BVH y se ha usado su caja
+};
+
+// Picking con rayos contra la escena.
+// Las cajas de todas las entidades se prueban de 4 en 4; las que corta el
+// rayo se ordenan por distancia de entrada y se baja al BVH de su malla (con
+// el rayo pasado a espacio local) hasta que la siguiente caja empieza mas
+// lejos que el mejor triangulo. Lee las bounds y las matrices de mundo:
+// solo entre frames, cuando ningun job esta actualizando la escena.
+namespace Picking
+{
+	// Rayo en mundo desde el pixel (x, y) de la ventana, con y hacia abajo como SDL.
+	// inverseViewProjection: inversa de proyeccion * vista (Camera la tiene en cache)
+	void screenRay(int x, int y, int width, int height, const glm::mat4& inverseViewProjection,
+		glm::vec3& origin, glm::vec3& direction);
+
+	bool pick(const Scene& scene, const glm::vec3& origin, const glm::vec3& direction, PickHit& hit);
+
+	// Punto del plano (punto, normal) que corta el rayo; false si es paralelo o queda detras
+	bool rayPlane(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& planePoint,
+		const glm::vec3& planeNormal, glm::vec3& point);
+}
@@ -0,0 +1,333 @@
+#include "Profiler.h"
+#include "FrameArena.h"
+#include <imgui.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace
+{
+	struct ZoneEvent
+	{
+		const char* name;
+		uint64_t begin;
+		uint64_t end;
+		int depth;
+	};
+
+	// Ring buffer de un productor (el hilo dueno) y un consumidor (endFrame)
+	struct ThreadBuffer
+	{
+		static const uint32_t CAPACITY = 16384;
+
+		string name;
+		int index = 0;
+		bool inUse = true; // false: su hilo termino y el siguiente hilo nuevo lo reutiliza
+		ZoneEvent events[CAPACITY];
+		atomic<uint32_t> head{ 0 };
+		atomic<uint32_t> tail{ 0 };
+		atomic<uint32_t> dropped{ 0 };
+	};
+
+	struct FrameRecord
+	{
+		uint64_t begin = 0;
+		uint64_t end = 0;
+		vector<ProfileRecord> zones;
+		int64_t counters[static_cast<int>(Counter::COUNT)] = {};
+	};
+
+	const int HISTORY_SIZE = 300;
+	const size_t ZONES_PER_FRAME = 512; // reserva inicial de cada frame del historial
+
+	mutex registryMutex;
+	vector<unique_ptr<ThreadBuffer>> threads;
+
+	// Al terminar el hilo su buffer queda libre: cada init/shutdown del JobSystem
+	// crea hilos nuevos y sin reutilizar los buffers no dejarian de crecer
+	struct LocalBuffer
+	{
+		ThreadBuffer* buffer = nullptr;
+		~LocalBuffer()
+		{
+			if (!buffer) return;
+			lock_guard<mutex> lock(registryMutex);
+			buffer->inUse = false;
+		}
+	};
+	thread_local LocalBuffer local;
+	thread_local int localDepth = 0;
+
+	FrameRecord history[HISTORY_SIZE];
+	int historyHead = 0;   // siguiente posicion a escribir
+	int historyCount = 0;
+	uint64_t frameBegin = 0;
+	FrameRecord lastFrame;
+	atomic<int64_t> counters[static_cast<int>(Counter::COUNT)];
+
+	bool paused = false;
+	int selectedFrame = 0; // 0 = el mas reciente
+
+	ThreadBuffer& threadBuffer()
+	{
+		if (!local.buffer) {
+			lock_guard<mutex> lock(registryMutex);
+			// Los eventos que dejo el hilo anterior se siguen leyendo en endFrame
+			for (auto& buffer : threads) {
+				if (buffer->inUse) continue;
+				local.buffer = buffer.get();
+				break;
+			}
+			if (!local.buffer) {
+				threads.push_back(make_unique<ThreadBuffer>());
+				local.buffer = threads.back().get();
+				local.buffer->index = static_cast<int>(threads.size()) - 1;
+			}
+			local.buffer->inUse = true;
+			local.buffer->name = "Thread " + to_string(local.buffer->index);
+		}
+		return *local.buffer;
+	}
+
+	const FrameRecord& frameAt(int age)
+	{
+		return history[(historyHead - 1 - age + HISTORY_SIZE * 2) % HISTORY_SIZE];
+	}
+
+	double toMs(uint64_t ns) { return ns / 1000000.0; }
+
+	ImU32 zoneColor(const char* name)
+	{
+		// Color estable por nombre de zona
+		uint32_t h = 2166136261u;
+		for (const char* c = name; *c; c++) h = (h ^ static_cast<uint8_t>(*c)) * 16777619u;
+		return IM_COL32(90 + (h & 0x7F), 90 + ((h >> 8) & 0x7F), 90 + ((h >> 16) & 0x7F), 255);
+	}
+}
+
+atomic<bool> Profiler::enabled{ true };
+
+uint64_t Profiler::now()
+{
+	return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+		chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Profiler::setThreadName(const char* name)
+{
+	ThreadBuffer& buffer = threadBuffer();
+	lock_guard<mutex> lock(registryMutex);
+	buffer.name = name;
+}
+
+string Profiler::threadName(int thread)
+{
+	lock_guard<mutex> lock(registryMutex);
+	if (thread < 0 || thread >= static_cast<int>(threads.size())) return string();
+	return threads[thread]->name;
+}
+
+void Profiler::addCounter(Counter counter, int64_t value)
+{
+	counters[static_cast<int>(counter)].fetch_add(value, memory_order_relaxed);
+}
+
+const char* Profiler::counterName(Counter counter)
+{
+	switch (counter) {
+	case Counter::DrawCalls: return "Draw calls";
+	case Counter::Triangles: return "Triangulos";
+	case Counter::BytesUploaded: return "Bytes subidos";
+	case Counter::HeapAllocations: return "Reservas heap";
+	case Counter::CullPasses: return "Pasadas de culling";
+	case Counter::CameraUploads: return "Subidas de camara";
+	default: return "?";
+	}
+}
+
+void Profiler::record(const char* name, uint64_t begin, uint64_t end, int depth)
+{
+	ThreadBuffer& buffer = threadBuffer();
+	const uint32_t head = buffer.head.load(memory_order_relaxed);
+	if (head - buffer.tail.load(memory_order_acquire) >= ThreadBuffer::CAPACITY) {
+		buffer.dropped.fetch_add(1, memory_order_relaxed);
+		return;
+	}
+	buffer.events[head % ThreadBuffer::CAPACITY] = { name, begin, end, depth };
+	buffer.head.store(head + 1, memory_order_release);
+}
+
+void Profiler::endFrame()
+{
+	const uint64_t frameEnd = now();
+
+	lastFrame.zones.clear();
+	{
+		lock_guard<mutex> lock(registryMutex);
+		for (auto& buffer : threads) {
+			const uint32_t head = buffer->head.load(memory_order_acquire);
+			uint32_t tail = buffer->tail.load(memory_order_relaxed);
+			for (; tail != head; tail++) {
+				const ZoneEvent& e = buffer->events[tail % ThreadBuffer::CAPACITY];
+				lastFrame.zones.push_back({ e.name, e.begin, e.end, e.depth, buffer->index });
+			}
+			buffer->tail.store(tail, memory_order_release);
+		}
+	}
+
+	if (frameBegin == 0) {
+		frameBegin = lastFrame.zones.empty() ? frameEnd : lastFrame.zones.front().begin;
+		// Todo el historial de una vez, para que los frames siguientes no reserven memoria
+		for (auto& frame : history) frame.zones.reserve(max(ZONES_PER_FRAME, lastFrame.zones.size()));
+	}
+	lastFrame.begin = frameBegin;
+	lastFrame.end = frameEnd;
+	for (int i = 0; i < static_cast<int>(Counter::COUNT); i++)
+		lastFrame.counters[i] = counters[i].exchange(0, memory_order_relaxed);
+
+	// En pausa seguimos vaciando los buffers pero congelamos el historial
+	if (!paused) {
+		FrameRecord& frame = history[historyHead];
+		frame.begin = lastFrame.begin;
+		frame.end = lastFrame.end;
+		frame.zones.assign(lastFrame.zones.begin(), lastFrame.zones.end());
+		copy(begin(lastFrame.counters), end(lastFrame.counters), frame.counters);
+		historyHead = (historyHead + 1) % HISTORY_SIZE;
+		historyCount = min(historyCount + 1, HISTORY_SIZE);
+	}
+	frameBegin = frameEnd;
+}
+
+const vector<ProfileRecord>& Profiler::lastFrameZones()
+{
+	return lastFrame.zones;
+}
+
+uint64_t Profiler::lastFrameBegin()
+{
+	return lastFrame.begin;
+}
+
+uint64_t Profiler::lastFrameEnd()
+{
+	return lastFrame.end;
+}
+
+int64_t Profiler::lastCounter(Counter counter)
+{
+	return lastFrame.counters[static_cast<int>(counter)];
+}
+
+void Profiler::drawImGui()
+{
+	if (!ImGui::Begin("Profiler")) {
+		ImGui::End();
+		return;
+	}
+
+	bool on = enabled.load(memory_order_relaxed);
+	if (ImGui::Checkbox("Activo", &on)) enabled.store(on, memory_order_relaxed);
+	ImGui::SameLine();
+	if (ImGui::Checkbox("Pausa", &paused) && !paused) selectedFrame = 0;
+
+	if (historyCount == 0) {
+		ImGui::End();
+		return;
+	}
+
+	// Historial de duracion de frames (de mas antiguo a mas reciente)
+	static float frameTimes[HISTORY_SIZE];
+	for (int i = 0; i < historyCount; i++) {
+		const FrameRecord& f = frameAt(historyCount - 1 - i);
+		frameTimes[i] = static_cast<float>(toMs(f.end - f.begin));
+	}
+	ImGui::PlotHistogram("##frames", frameTimes, historyCount, 0, "ms por frame", 0.0f, 50.0f, ImVec2(ImGui::GetContentRegionAvail().x, 60.0f));
+	if (paused) {
+		int index = historyCount - 1 - selectedFrame;
+		if (ImGui::SliderInt("Frame", &index, 0, historyCount - 1)) selectedFrame = historyCount - 1 - index;
+	}
+	selectedFrame = min(selectedFrame, historyCount - 1);
+
+	const FrameRecord& frame = frameAt(selectedFrame);
+	const double frameMs = toMs(frame.end - frame.begin);
+	ImGui::Text("Frame: %.3f ms  (%d zonas)", frameMs, static_cast<int>(frame.zones.size()));
+	for (int i = 0; i < static_cast<int>(Counter::COUNT); i++) {
+		if (i > 0) ImGui::SameLine();
+		ImGui::Text("%s: %lld ", counterName(static_cast<Counter>(i)), static_cast<long long>(frame.counters[i]));
+	}
+
+	// Flame graph: una franja por hilo, una fila por nivel de profundidad
+	int threadCount;
+	{
+		lock_guard<mutex> lock(registryMutex);
+		threadCount = static_cast<int>(threads.size());
+	}
+	ScratchScope scratch;
+	pmr::vector<int> maxDepth(threadCount, -1, scratch.resource());
+	for (const auto& z : frame.zones) maxDepth[z.thread] = max(maxDepth[z.thread], z.depth);
+
+	const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+	const float width = ImGui::GetContentRegionAvail().x;
+	const double span = max<double>(1.0, static_cast<double>(frame.end - frame.begin));
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+	for (int t = 0; t < threadCount; t++) {
+		if (maxDepth[t] < 0) continue;
+		{
+			lock_guard<mutex> lock(registryMutex);
+			ImGui::TextDisabled("%s", threads[t]->name.c_str());
+		}
+		const ImVec2 origin = ImGui::GetCursorScreenPos();
+		const float laneHeight = rowHeight * (maxDepth[t] + 1);
+		ImGui::Dummy(ImVec2(width, laneHeight));
+		drawList->PushClipRect(origin, ImVec2(origin.x + width, origin.y + laneHeight), true);
+
+		for (const auto& z : frame.zones) {
+			if (z.thread != t) continue;
+			const double b = z.begin > frame.begin ? static_cast<double>(z.begin - frame.begin) : 0.0;
+			const double e = z.end > frame.begin ? static_cast<double>(z.end - frame.begin) : 0.0;
+			const ImVec2 p0(origin.x + static_cast<float>(b / span) * width, origin.y + z.depth * rowHeight);
+			const ImVec2 p1(max(p0.x + 1.0f, origin.x + static_cast<float>(e / span) * width), p0.y + rowHeight - 1.0f);
+			drawList->AddRectFilled(p0, p1, zoneColor(z.name));
+			if (p1.x - p0.x > ImGui::CalcTextSize(z.name).x + 4.0f)
+				drawList->AddText(ImVec2(p0.x + 2.0f, p0.y + 1.0f), IM_COL32(0, 0, 0, 255), z.name);
+			if (ImGui::IsMouseHoveringRect(p0, p1))
+				ImGui::SetTooltip("%s\n%.3f ms", z.name, toMs(z.end - z.begin));
+		}
+		drawList->PopClipRect();
+	}
+
+	// Totales por zona del frame seleccionado
+	if (ImGui::CollapsingHeader("Totales")) {
+		struct Total { const char* name; int calls; uint64_t ns; };
+		pmr::vector<Total> totals(scratch.resource());
+		for (const auto& z : frame.zones) {
+			auto it = find_if(totals.begin(), totals.end(), [&z](const Total& t) { return t.name == z.name; });
+			if (it == totals.end()) totals.push_back({ z.name, 1, z.end - z.begin });
+			else { it->calls++; it->ns += z.end - z.begin; }
+		}
+		sort(totals.begin(), totals.end(), [](const Total& a, const Total& b) { return a.ns > b.ns; });
+		for (const auto& t : totals) ImGui::Text("%-24s %4d  %8.3f ms", t.name, t.calls, toMs(t.ns));
+	}
+
+	ImGui::End();
+}
+
+ProfileZone::ProfileZone(const char* name) : _name(name), _begin(0), _depth(-1)
+{
+	if (!Profiler::enabled.load(memory_order_relaxed)) return;
+	_depth = localDepth++;
+	_begin = Profiler::now();
+}
+
+ProfileZone::~ProfileZone()
+{
+	if (_depth < 0) return;
+	localDepth--;
+	Profiler::record(_name, _begin, Profiler::now(), _depth);
+}
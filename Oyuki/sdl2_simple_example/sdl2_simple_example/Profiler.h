@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Profiler jerarquico de CPU.
+// PROFILE_SCOPE("nombre") abre una zona que se cierra al salir del bloque.
+// Cada hilo escribe sus zonas en su propio ring buffer lock-free y el hilo
+// principal las recoge en Profiler::endFrame() para agruparlas por frame.
+// Con OYUKI_PROFILER = 0 las macros desaparecen del todo.
+
+#ifndef OYUKI_PROFILER
+#define OYUKI_PROFILER 1
+#endif
+
+struct ProfileRecord
+{
+	const char* name;
+	uint64_t begin;
+	uint64_t end;
+	int depth;
+	int thread;
+};
+
+// Contadores que se acumulan durante el frame y se reinician en endFrame
+enum class Counter { DrawCalls, Triangles, BytesUploaded, HeapAllocations, CullPasses, CameraUploads, COUNT };
+
+namespace Profiler
+{
+	extern std::atomic<bool> enabled;
+
+	uint64_t now(); // nanosegundos, reloj monotono
+
+	void setThreadName(const char* name);
+	std::string threadName(int thread);
+	void record(const char* name, uint64_t begin, uint64_t end, int depth);
+
+	void addCounter(Counter counter, int64_t value);
+	const char* counterName(Counter counter);
+
+	// Cierra el frame actual: recoge las zonas de todos los hilos y las guarda en el historial
+	void endFrame();
+
+	// Datos del ultimo frame cerrado (aunque el historial este en pausa)
+	const std::vector<ProfileRecord>& lastFrameZones();
+	uint64_t lastFrameBegin();
+	uint64_t lastFrameEnd();
+	int64_t lastCounter(Counter counter);
+
+	// Ventana de ImGui con el historial de frames y el flame graph del frame seleccionado
+	void drawImGui();
+}
+
+class ProfileZone {
+
+	const char* _name;
+	uint64_t _begin;
+	int _depth;
+
+public:
+	explicit ProfileZone(const char* name);
+	~ProfileZone();
+};
+
+#if OYUKI_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileZone PROFILE_CONCAT(_profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#endif
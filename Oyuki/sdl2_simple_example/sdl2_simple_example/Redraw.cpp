@@ -0,0 +1,171 @@
+#include "Redraw.h"
+#include "Profiler.h"
+#include <SDL2/SDL_events.h>
+#include <SDL2/SDL_timer.h>
+#include <imgui.h>
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+using namespace std;
+
+using hrclock = chrono::steady_clock;
+
+namespace
+{
+	bool demand = true;
+	int framesLeft = 0;
+	RedrawReason lastReason = RedrawReason::Input;
+	Uint32 wakeEvent = static_cast<Uint32>(-1);
+
+	// Tramo parado en curso: desde el primer wait() tras un frame hasta el siguiente frame
+	bool idle = false;
+	hrclock::time_point idleStart;
+	double idleCpuStart = 0.0;
+
+	RedrawStats totals;
+	double idleCpuSeconds = 0.0;
+
+	// CPU de usuario y sistema de todo el proceso
+	double processCpuSeconds()
+	{
+#ifdef _WIN32
+		FILETIME creation, exit, kernel, user;
+		if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0.0;
+		auto seconds = [](const FILETIME& t) {
+			return ((static_cast<unsigned long long>(t.dwHighDateTime) << 32) | t.dwLowDateTime) * 1e-7;
+		};
+		return seconds(kernel) + seconds(user);
+#else
+		struct rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+		return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#endif
+	}
+
+	void endIdle()
+	{
+		if (!idle) return;
+		idle = false;
+		totals.idleSeconds += chrono::duration<double>(hrclock::now() - idleStart).count();
+		idleCpuSeconds += processCpuSeconds() - idleCpuStart;
+	}
+}
+
+void Redraw::init(bool onDemand)
+{
+	demand = onDemand;
+	framesLeft = 0;
+	// Un tipo propio: Input no lo cuenta como actividad, solo despierta el bucle
+	wakeEvent = SDL_RegisterEvents(1);
+	request(RedrawReason::Scene, 2);
+}
+
+void Redraw::shutdown()
+{
+	endIdle();
+	const RedrawStats s = stats();
+	if (!demand || s.framesDrawn == 0) return;
+	printf("Redraw: %zu frames dibujados, %.1f s parado con %.2f%% de CPU y %.1f despertares/s\n", s.framesDrawn,
+		s.idleSeconds, s.idleCpuPercent, s.wakeupsPerSecond);
+}
+
+bool Redraw::onDemand()
+{
+	return demand;
+}
+
+void Redraw::request(RedrawReason reason, int frames)
+{
+	if (frames > framesLeft) framesLeft = frames;
+	lastReason = reason;
+}
+
+bool Redraw::pending()
+{
+	return !demand || framesLeft > 0;
+}
+
+void Redraw::frameDrawn()
+{
+	endIdle();
+	if (framesLeft > 0) framesLeft--;
+	totals.framesDrawn++;
+	totals.framesByReason[static_cast<int>(lastReason)]++;
+}
+
+void Redraw::wait(int timeoutMs)
+{
+	PROFILE_FUNCTION();
+	if (!idle) {
+		idle = true;
+		idleStart = hrclock::now();
+		idleCpuStart = processCpuSeconds();
+	}
+	// Con nullptr el evento se queda en la cola para Input::pump()
+	SDL_WaitEventTimeout(nullptr, timeoutMs);
+	totals.wakeups++;
+}
+
+void Redraw::wake()
+{
+	if (wakeEvent == static_cast<Uint32>(-1)) return;
+	SDL_Event event;
+	SDL_zero(event);
+	event.type = wakeEvent;
+	SDL_PushEvent(&event);
+}
+
+RedrawStats Redraw::stats()
+{
+	RedrawStats s = totals;
+	// El tramo en curso tambien cuenta
+	double cpu = idleCpuSeconds;
+	if (idle) {
+		s.idleSeconds += chrono::duration<double>(hrclock::now() - idleStart).count();
+		cpu += processCpuSeconds() - idleCpuStart;
+	}
+	if (s.idleSeconds > 0.0) {
+		s.idleCpuPercent = 100.0 * cpu / s.idleSeconds;
+		s.wakeupsPerSecond = s.wakeups / s.idleSeconds;
+	}
+	return s;
+}
+
+const char* Redraw::reasonName(RedrawReason reason)
+{
+	switch (reason) {
+	case RedrawReason::Input: return "Input";
+	case RedrawReason::Camera: return "Camara";
+	case RedrawReason::Scene: return "Escena";
+	case RedrawReason::Assets: return "Assets";
+	case RedrawReason::ImGui: return "ImGui";
+	case RedrawReason::Capture: return "Captura";
+	default: return "?";
+	}
+}
+
+void Redraw::drawImGui()
+{
+	if (!ImGui::Begin("Redraw")) {
+		ImGui::End();
+		return;
+	}
+	if (!demand) {
+		ImGui::TextDisabled("Modo continuo (--continuous): se dibujan todos los frames");
+		ImGui::End();
+		return;
+	}
+	const RedrawStats s = stats();
+	ImGui::Text("Frames dibujados: %zu", s.framesDrawn);
+	ImGui::Text("Parado: %.1f s, CPU %.2f%% de un nucleo, %.1f despertares/s", s.idleSeconds, s.idleCpuPercent, s.wakeupsPerSecond);
+	for (int i = 0; i < static_cast<int>(RedrawReason::COUNT); i++) {
+		if (s.framesByReason[i]) ImGui::Text("  %s: %zu", reasonName(static_cast<RedrawReason>(i)), s.framesByReason[i]);
+	}
+	ImGui::End();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+
+// Por que se ha dibujado un frame en modo bajo demanda
+enum class RedrawReason { Input, Camera, Scene, Assets, ImGui, Capture, COUNT };
+
+struct RedrawStats
+{
+	size_t framesDrawn = 0;
+	size_t framesByReason[static_cast<int>(RedrawReason::COUNT)] = {};
+	double idleSeconds = 0.0;    // tiempo de pared parado, entre el ultimo frame y el siguiente
+	double idleCpuPercent = 0.0; // CPU del proceso (todos los hilos) mientras estaba parado, en % de un nucleo
+	double wakeupsPerSecond = 0.0; // veces que el bucle se ha despertado sin dibujar, por segundo parado
+	size_t wakeups = 0;
+};
+
+// Render bajo demanda: el bucle principal solo dibuja si algo ha cambiado.
+// Quien detecta un cambio (input, camara, escena, assets recargados, ImGui)
+// pide frames con request(); sin frames pendientes el hilo principal se
+// bloquea en SDL_WaitEventTimeout hasta el siguiente evento o el timeout, asi
+// que con la escena quieta el proceso no gasta CPU ni GPU.
+// Un hilo que termina algo que hay que ensenar (una carga) llama a wake().
+namespace Redraw
+{
+	// onDemand = false: se dibujan todos los frames (--continuous)
+	void init(bool onDemand);
+	void shutdown(); // Imprime el resumen
+	bool onDemand();
+
+	// Dibujar al menos 'frames' frames mas (un cambio de escena tarda dos en
+	// llegar a pantalla con el doble buffer; ImGui necesita alguno para asentarse)
+	void request(RedrawReason reason, int frames = 1);
+	bool pending();
+	// Despues del swap de cada frame dibujado
+	void frameDrawn();
+
+	// Bloquea hasta que haya un evento de SDL (sin sacarlo de la cola) o pase el timeout
+	void wait(int timeoutMs);
+	// Desde cualquier hilo: despierta a wait() con un SDL_USEREVENT
+	void wake();
+
+	RedrawStats stats();
+	const char* reasonName(RedrawReason reason);
+	// Se anade como ventana "Redraw"
+	void drawImGui();
+}
@@ -0,0 +1,33 @@
+#include "RenderPacket.h"
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstring>
+
+unsigned long long makeSortKey(GLuint vao, float viewDepth)
+{
+	// Para floats positivos el orden de los bits coincide con el orden numerico
+	if (!(viewDepth > 0.0f)) viewDepth = 0.0f;
+	unsigned int depthBits;
+	std::memcpy(&depthBits, &viewDepth, sizeof(depthBits));
+	return (static_cast<unsigned long long>(vao) << 32) | depthBits;
+}
+
+void sortDraws(std::vector<DrawPacket>& draws)
+{
+	// Ordenamos pares (clave, indice) en la arena del frame en vez de mover los DrawPacket enteros
+	struct KeyIndex
+	{
+		unsigned long long key;
+		size_t index;
+	};
+	ScratchScope scratch;
+	std::pmr::vector<KeyIndex> keys(scratch.resource());
+	keys.reserve(draws.size());
+	for (size_t i = 0; i < draws.size(); i++) keys.push_back({ draws[i].sortKey, i });
+	std::sort(keys.begin(), keys.end(), [](const KeyIndex& a, const KeyIndex& b) { return a.key < b.key; });
+
+	std::pmr::vector<DrawPacket> sorted(scratch.resource());
+	sorted.reserve(draws.size());
+	for (const auto& k : keys) sorted.push_back(draws[k.index]);
+	std::copy(sorted.begin(), sorted.end(), draws.begin());
+}
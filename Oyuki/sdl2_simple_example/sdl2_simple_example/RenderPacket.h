@@ -0,0 +1,57 @@
+#pragma once
+#include "ResourcePool.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+struct MeshData;
+struct Texture;
+
+// Todo lo que necesita el render para dibujar un frame. Lo rellena la fase de
+// simulacion/extraccion y, una vez publicado, el render solo lo lee.
+struct DrawPacket
+{
+	GLuint vao = 0;
+	GLsizei indexCount = 0;
+	GLuint texture = 0;
+	glm::mat4 model = glm::mat4(1.0f);
+	// Lo mismo en los pools de Resources, para el render por software (vao y texture son 0)
+	Handle<MeshData> mesh;
+	Handle<Texture> diffuse;
+	unsigned long long sortKey = 0; // Ver makeSortKey
+};
+
+// Ordena por VAO y, dentro del mismo VAO, de delante hacia atras
+unsigned long long makeSortKey(GLuint vao, float viewDepth);
+void sortDraws(std::vector<DrawPacket>& draws);
+
+struct FramePacket
+{
+	unsigned long long frameIndex = 0;
+	std::vector<DrawPacket> draws;
+	// Versiones de la camara y la escena con las que se generaron los draws
+	unsigned long long cameraVersion = 0;
+	unsigned long long sceneVersion = 0;
+	// Caja de mundo de la entidad seleccionada, si hay
+	bool hasSelection = false;
+	glm::vec3 selectionMin = glm::vec3(0.0f);
+	glm::vec3 selectionMax = glm::vec3(0.0f);
+
+	// clear() conserva la capacidad: en regimen estable no hay reservas nuevas
+	void reset(unsigned long long index) { frameIndex = index; draws.clear(); hasSelection = false; cameraVersion = sceneVersion = 0; }
+	// Como reset() pero sin tocar los draws: si las versiones siguen igual se reutilizan
+	void resetKeepingDraws(unsigned long long index) { frameIndex = index; hasSelection = false; }
+};
+
+// Doble buffer de FramePacket: mientras el render consume front() la
+// simulacion escribe el siguiente frame en back(). swap() publica back().
+class FramePipeline {
+
+	FramePacket _packets[2];
+	int _front = 0;
+
+public:
+	const FramePacket& front() const { return _packets[_front]; }
+	FramePacket& back() { return _packets[1 - _front]; }
+	void swap() { _front = 1 - _front; }
+};
@@ -0,0 +1,129 @@
+#pragma once
+#include <cstdint>
+#include <exception>
+#include <utility>
+#include <vector>
+
+// Handle de 32 bits: 20 bits de slot y 12 de generacion.
+// Cuando se borra un objeto su slot cambia de generacion, asi que las copias
+// viejas del handle dejan de ser validas en vez de apuntar a otro objeto.
+// El valor 0 es el handle nulo (las generaciones empiezan en 1).
+template<class T>
+struct Handle
+{
+	static const uint32_t INDEX_BITS = 20;
+	static const uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+	static const uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+	uint32_t value = 0;
+
+	uint32_t index() const { return value & INDEX_MASK; }
+	uint32_t generation() const { return value >> INDEX_BITS; }
+	bool isNull() const { return value == 0; }
+	bool operator==(Handle other) const { return value == other.value; }
+	bool operator!=(Handle other) const { return value != other.value; }
+
+	static Handle make(uint32_t index, uint32_t generation)
+	{
+		Handle h;
+		h.value = (generation << INDEX_BITS) | index;
+		return h;
+	}
+};
+
+// Almacen de objetos de tipo T direccionados por Handle<T>.
+// Los objetos vivos estan seguidos en un vector (se recorren con begin/end);
+// al borrar, el ultimo ocupa el hueco y se actualiza su slot.
+template<class T>
+class ResourcePool {
+
+	static const uint32_t FREE = 0xFFFFFFFFu;
+
+	struct Slot
+	{
+		uint32_t dense;       // posicion en _objects, FREE si el slot esta libre
+		uint32_t generation;
+	};
+
+	std::vector<T> _objects;
+	std::vector<uint32_t> _owners; // slot de cada objeto de _objects
+	std::vector<Slot> _slots;
+	std::vector<uint32_t> _freeSlots;
+
+	const Slot* findSlot(Handle<T> handle) const
+	{
+		if (handle.isNull() || handle.index() >= _slots.size()) return nullptr;
+		const Slot& slot = _slots[handle.index()];
+		if (slot.dense == FREE || slot.generation != handle.generation()) return nullptr;
+		return &slot;
+	}
+
+public:
+	Handle<T> insert(T object)
+	{
+		uint32_t index;
+		if (!_freeSlots.empty()) {
+			index = _freeSlots.back();
+			_freeSlots.pop_back();
+		}
+		else {
+			if (_slots.size() > Handle<T>::INDEX_MASK) throw std::exception("ResourcePool lleno");
+			index = static_cast<uint32_t>(_slots.size());
+			_slots.push_back({ FREE, 1 });
+		}
+		_slots[index].dense = static_cast<uint32_t>(_objects.size());
+		_objects.push_back(std::move(object));
+		_owners.push_back(index);
+		return Handle<T>::make(index, _slots[index].generation);
+	}
+
+	bool remove(Handle<T> handle)
+	{
+		if (!findSlot(handle)) return false;
+		Slot& slot = _slots[handle.index()];
+		const uint32_t last = static_cast<uint32_t>(_objects.size()) - 1;
+		if (slot.dense != last) {
+			_objects[slot.dense] = std::move(_objects[last]);
+			_owners[slot.dense] = _owners[last];
+			_slots[_owners[last]].dense = slot.dense;
+		}
+		_objects.pop_back();
+		_owners.pop_back();
+
+		slot.dense = FREE;
+		slot.generation = (slot.generation + 1) & Handle<T>::GENERATION_MASK;
+		if (slot.generation == 0) slot.generation = 1;
+		_freeSlots.push_back(handle.index());
+		return true;
+	}
+
+	bool valid(Handle<T> handle) const { return findSlot(handle) != nullptr; }
+
+	// nullptr si el handle es nulo o ya se borro
+	T* get(Handle<T> handle)
+	{
+		const Slot* slot = findSlot(handle);
+		return slot ? &_objects[slot->dense] : nullptr;
+	}
+
+	const T* get(Handle<T> handle) const
+	{
+		const Slot* slot = findSlot(handle);
+		return slot ? &_objects[slot->dense] : nullptr;
+	}
+
+	// Handle del objeto que esta en la posicion 'dense' del recorrido
+	Handle<T> handleAt(size_t dense) const
+	{
+		const uint32_t index = _owners[dense];
+		return Handle<T>::make(index, _slots[index].generation);
+	}
+
+	size_t size() const { return _objects.size(); }
+	bool empty() const { return _objects.empty(); }
+
+	typename std::vector<T>::iterator begin() { return _objects.begin(); }
+	typename std::vector<T>::iterator end() { return _objects.end(); }
+	typename std::vector<T>::const_iterator begin() const { return _objects.begin(); }
+	typename std::vector<T>::const_iterator end() const { return _objects.end(); }
+};
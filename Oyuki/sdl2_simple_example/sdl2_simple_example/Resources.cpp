@@ -0,0 +1,51 @@
+#include "Resources.h"
+#include "MemoryTracker.h"
+
+ResourcePool<MeshData> Resources::meshes;
+ResourcePool<Texture> Resources::textures;
+ResourcePool<Material> Resources::materials;
+ResourcePool<ShaderProgram> Resources::shaders;
+
+void Resources::destroyMesh(MeshHandle handle)
+{
+	MeshData* mesh = meshes.get(handle);
+	if (!mesh) return;
+	cleanupMeshData(*mesh);
+	meshes.remove(handle);
+}
+
+void Resources::destroyTexture(TextureHandle handle)
+{
+	Texture* texture = textures.get(handle);
+	if (!texture) return;
+	releaseTexture(*texture);
+	textures.remove(handle);
+}
+
+void Resources::releaseTexture(Texture& texture)
+{
+	if (!texture.pixels.empty()) {
+		MemoryTracker::remove(MemTag::Textures, texture.pixels.size());
+		texture.pixels = std::vector<unsigned char>();
+	}
+	if (!texture.id) return;
+	glDeleteTextures(1, &texture.id);
+	MemoryTracker::remove(MemTag::Textures, static_cast<size_t>(texture.width) * texture.height * 4);
+	texture.id = 0;
+}
+
+void Resources::destroyShader(ShaderHandle handle)
+{
+	ShaderProgram* shader = shaders.get(handle);
+	if (!shader) return;
+	glDeleteProgram(shader->id);
+	shaders.remove(handle);
+}
+
+void Resources::destroyAll()
+{
+	while (!meshes.empty()) destroyMesh(meshes.handleAt(0));
+	while (!textures.empty()) destroyTexture(textures.handleAt(0));
+	while (!shaders.empty()) destroyShader(shaders.handleAt(0));
+	while (!materials.empty()) materials.remove(materials.handleAt(0));
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "ResourcePool.h"
+#include "Mesh.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+struct Texture
+{
+	GLuint id = 0;
+	int width = 0;
+	int height = 0;
+	uint64_t contentHash = 0; // de los pixeles RGBA; las escenas guardadas referencian la textura con el
+	std::vector<unsigned char> pixels; // RGBA8 en CPU, solo para el render por software (id 0)
+};
+
+struct Material
+{
+	Handle<Texture> diffuse;
+	glm::vec4 color = glm::vec4(1.0f);
+};
+
+struct ShaderProgram
+{
+	GLuint id = 0;
+};
+
+using MeshHandle = Handle<MeshData>;
+using TextureHandle = Handle<Texture>;
+using MaterialHandle = Handle<Material>;
+using ShaderHandle = Handle<ShaderProgram>;
+
+// Todos los recursos del motor. Se modifican solo en el hilo principal y fuera
+// de la extraccion del frame; el resto de hilos solo los leen.
+namespace Resources
+{
+	extern ResourcePool<MeshData> meshes;
+	extern ResourcePool<Texture> textures;
+	extern ResourcePool<Material> materials;
+	extern ResourcePool<ShaderProgram> shaders;
+
+	// Liberan los objetos de OpenGL y el slot; el handle deja de ser valido
+	void destroyMesh(MeshHandle handle);
+	void destroyTexture(TextureHandle handle);
+	void destroyShader(ShaderHandle handle);
+	void destroyAll();
+
+	// Libera los objetos de OpenGL (y los pixeles en CPU) de una textura que ya no esta en el pool
+	void releaseTexture(Texture& texture);
+}
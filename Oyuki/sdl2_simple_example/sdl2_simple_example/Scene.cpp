@@ -0,0 +1,192 @@
+#include "Scene.h"
+#include "JobSystem.h"
+#include "FrameArena.h"
+#include "Profiler.h"
+#include "SimdMath.h"
+#include <cmath>
+using namespace std;
+
+Entity Scene::create() {
+	uint32_t index;
+	if (!_freeIndices.empty()) {
+		index = _freeIndices.back();
+		_freeIndices.pop_back();
+	}
+	else {
+		if (_generations.size() > Entity::INDEX_MASK) throw exception("Demasiadas entidades");
+		index = static_cast<uint32_t>(_generations.size());
+		_generations.push_back(1);
+	}
+	_alive++;
+	_version++;
+	return Entity::make(index, _generations[index]);
+}
+
+void Scene::destroy(Entity entity) {
+	if (!alive(entity)) return;
+	transforms.remove(entity);
+	renderers.remove(entity);
+	bounds.remove(entity);
+	materials.remove(entity);
+
+	uint32_t& generation = _generations[entity.index()];
+	generation = (generation + 1) & Entity::GENERATION_MASK;
+	if (generation == 0) generation = 1;
+	_freeIndices.push_back(entity.index());
+	_alive--;
+	_version++;
+}
+
+bool Scene::alive(Entity entity) const {
+	return !entity.isNull() && entity.index() < _generations.size() && _generations[entity.index()] == entity.generation();
+}
+
+void Scene::clear() {
+	transforms = ComponentStore<Transform>();
+	renderers = ComponentStore<MeshRenderer>();
+	bounds = ComponentStore<Bounds>();
+	materials = ComponentStore<MaterialRef>();
+	_generations.clear();
+	_freeIndices.clear();
+	_alive = 0;
+	_version++;
+}
+
+void Scene::reserve(size_t count) {
+	_generations.reserve(count);
+	transforms.reserve(count);
+	renderers.reserve(count);
+	bounds.reserve(count);
+	materials.reserve(count);
+}
+
+Entity Scene::spawnMesh(MeshHandle mesh, const Transform& transform) {
+	const Entity entity = create();
+	transforms.add(entity, transform);
+	renderers.add(entity, { mesh });
+	if (const MeshData* meshData = Resources::meshes.get(mesh)) {
+		Bounds b;
+		b.localMin = meshData->boundsMin;
+		b.localMax = meshData->boundsMax;
+		bounds.add(entity, b);
+		materials.add(entity, { meshData->material });
+	}
+	return entity;
+}
+
+void Scene::refreshMeshBounds(MeshHandle mesh) {
+	const MeshData* meshData = Resources::meshes.get(mesh);
+	if (!meshData) return;
+	_version++;
+	for (size_t i = 0; i < renderers.size(); i++) {
+		if (renderers.at(i).mesh != mesh) continue;
+		if (Bounds* b = bounds.get(renderers.entityAt(i))) {
+			b->localMin = meshData->boundsMin;
+			b->localMax = meshData->boundsMax;
+		}
+	}
+}
+
+void SceneSystems::updateTransforms(Scene& scene) {
+	PROFILE_FUNCTION();
+	ComponentStore<Transform>& transforms = scene.transforms;
+	JobSystem::parallelFor(transforms.size(), CHUNK_SIZE, [&transforms](size_t begin, size_t end) {
+		// T * Rx * Ry * Rz * S desarrollado: evita tres glm::rotate con eje generico por entidad
+		const float DEG = 3.14159265358979f / 180.0f;
+		for (size_t i = begin; i < end; i++) {
+			Transform& t = transforms.at(i);
+			const float sa = sinf(t.rotation.x * DEG), ca = cosf(t.rotation.x * DEG);
+			const float sb = sinf(t.rotation.y * DEG), cb = cosf(t.rotation.y * DEG);
+			const float sc = sinf(t.rotation.z * DEG), cc = cosf(t.rotation.z * DEG);
+			glm::mat4& w = t.world;
+			w[0][0] = cb * cc * t.scale.x;
+			w[0][1] = (sa * sb * cc + ca * sc) * t.scale.x;
+			w[0][2] = (sa * sc - ca * sb * cc) * t.scale.x;
+			w[0][3] = 0.0f;
+			w[1][0] = -cb * sc * t.scale.y;
+			w[1][1] = (ca * cc - sa * sb * sc) * t.scale.y;
+			w[1][2] = (ca * sb * sc + sa * cc) * t.scale.y;
+			w[1][3] = 0.0f;
+			w[2][0] = sb * t.scale.z;
+			w[2][1] = -sa * cb * t.scale.z;
+			w[2][2] = ca * cb * t.scale.z;
+			w[2][3] = 0.0f;
+			w[3] = glm::vec4(t.position, 1.0f);
+		}
+	});
+}
+
+void SceneSystems::updateBounds(Scene& scene) {
+	PROFILE_FUNCTION();
+	ComponentStore<Bounds>& bounds = scene.bounds;
+	const ComponentStore<Transform>& transforms = scene.transforms;
+	JobSystem::parallelFor(bounds.size(), CHUNK_SIZE, [&bounds, &transforms](size_t begin, size_t end) {
+		// Juntamos las matrices del bloque y el kernel lee y escribe las cajas en el propio array
+		ScratchScope scratch;
+		pmr::vector<glm::mat4> models(end - begin, glm::mat4(1.0f), scratch.resource());
+		for (size_t i = begin; i < end; i++) {
+			if (const Transform* t = transforms.get(bounds.entityAt(i))) models[i - begin] = t->world;
+		}
+		Bounds* b = &bounds.at(begin);
+		SimdMath::transformAabbs(models.data(), &b->localMin, &b->localMax, &b->worldMin, &b->worldMax, end - begin, sizeof(Bounds));
+	});
+}
+
+void SceneSystems::extractDraws(const Scene& scene, const Frustum& frustum, const glm::mat4& view, FramePacket& packet) {
+	PROFILE_FUNCTION();
+	const ComponentStore<MeshRenderer>& renderers = scene.renderers;
+
+	// Culling por bloques en paralelo; la compactacion se hace despues en orden
+	ScratchScope scratch;
+	pmr::vector<unsigned char> visible(renderers.size(), 0, scratch.resource());
+	unsigned char* flags = visible.data();
+	JobSystem::parallelFor(renderers.size(), CHUNK_SIZE, [&scene, &renderers, &frustum, flags](size_t begin, size_t end) {
+		// Las cajas del bloque en SoA para probarlas de 8 en 8; sin Bounds cuenta como visible
+		const size_t count = end - begin;
+		ScratchScope scratch;
+		pmr::vector<float> soa(count * 6, 0.0f, scratch.resource());
+		pmr::vector<unsigned char> noBounds(count, 0, scratch.resource());
+		float* minX = soa.data();
+		float* minY = minX + count;
+		float* minZ = minY + count;
+		float* maxX = minZ + count;
+		float* maxY = maxX + count;
+		float* maxZ = maxY + count;
+		for (size_t i = 0; i < count; i++) {
+			const Bounds* b = scene.bounds.get(renderers.entityAt(begin + i));
+			if (!b) {
+				noBounds[i] = 1;
+				continue;
+			}
+			minX[i] = b->worldMin.x; minY[i] = b->worldMin.y; minZ[i] = b->worldMin.z;
+			maxX[i] = b->worldMax.x; maxY[i] = b->worldMax.y; maxZ[i] = b->worldMax.z;
+		}
+		SimdMath::cullAabbs(frustum, { minX, minY, minZ, maxX, maxY, maxZ }, count, flags + begin);
+		for (size_t i = 0; i < count; i++) flags[begin + i] |= noBounds[i];
+	});
+
+	for (size_t i = 0; i < renderers.size(); i++) {
+		if (!flags[i]) continue;
+		const Entity entity = renderers.entityAt(i);
+		const MeshData* meshData = Resources::meshes.get(renderers.at(i).mesh);
+		if (!meshData) continue;
+
+		const Transform* transform = scene.transforms.get(entity);
+		const Bounds* b = scene.bounds.get(entity);
+		const MaterialRef* materialRef = scene.materials.get(entity);
+		const Material* material = materialRef ? Resources::materials.get(materialRef->material) : nullptr;
+		const Texture* texture = material ? Resources::textures.get(material->diffuse) : nullptr;
+
+		DrawPacket draw;
+		draw.vao = meshData->vao;
+		draw.indexCount = static_cast<GLsizei>(meshData->triangles.size() * 3);
+		draw.texture = texture ? texture->id : 0;
+		draw.mesh = renderers.at(i).mesh;
+		if (texture) draw.diffuse = material->diffuse;
+		draw.model = transform ? transform->world : glm::mat4(1.0f);
+		const glm::vec3 center = b ? (b->worldMin + b->worldMax) * 0.5f : glm::vec3(draw.model[3]);
+		draw.sortKey = makeSortKey(meshData->vao, -(view * glm::vec4(center, 1.0f)).z);
+		packet.draws.push_back(draw);
+	}
+	sortDraws(packet.draws);
+}
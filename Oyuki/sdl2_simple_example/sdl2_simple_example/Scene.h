@@ -0,0 +1,150 @@
+#pragma once
+#include "ResourcePool.h"
+#include "Resources.h"
+#include "Culling.h"
+#include "RenderPacket.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+// Escena entidad-componente con un sparse set por tipo de componente.
+// Cada componente vive en su propio array denso (SoA entre componentes), asi
+// que un sistema que solo necesita transformaciones recorre memoria contigua
+// sin saltarse entidades que no las tengan.
+
+struct EntityTag;
+using Entity = Handle<EntityTag>;
+
+struct Transform
+{
+	glm::vec3 position = glm::vec3(0.0f);
+	glm::vec3 rotation = glm::vec3(0.0f); // grados, orden X-Y-Z
+	glm::vec3 scale = glm::vec3(1.0f);
+	glm::mat4 world = glm::mat4(1.0f);     // lo calcula updateTransforms
+};
+
+struct MeshRenderer
+{
+	MeshHandle mesh;
+};
+
+struct Bounds
+{
+	glm::vec3 localMin = glm::vec3(0.0f);
+	glm::vec3 localMax = glm::vec3(0.0f);
+	glm::vec3 worldMin = glm::vec3(0.0f); // los calcula updateBounds
+	glm::vec3 worldMax = glm::vec3(0.0f);
+};
+
+struct MaterialRef
+{
+	MaterialHandle material;
+};
+
+template<class T>
+class ComponentStore {
+
+	static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+	std::vector<uint32_t> _sparse;   // indice de entidad -> posicion en _data
+	std::vector<Entity> _entities;   // entidad de cada posicion de _data
+	std::vector<T> _data;
+
+public:
+	T& add(Entity entity, const T& value)
+	{
+		const uint32_t index = entity.index();
+		if (index >= _sparse.size()) _sparse.resize(index + 1, NONE);
+		if (_sparse[index] != NONE) {
+			_entities[_sparse[index]] = entity;
+			return _data[_sparse[index]] = value;
+		}
+		_sparse[index] = static_cast<uint32_t>(_data.size());
+		_entities.push_back(entity);
+		_data.push_back(value);
+		return _data.back();
+	}
+
+	void remove(Entity entity)
+	{
+		if (!has(entity)) return;
+		const uint32_t pos = _sparse[entity.index()];
+		const uint32_t last = static_cast<uint32_t>(_data.size()) - 1;
+		if (pos != last) {
+			_data[pos] = _data[last];
+			_entities[pos] = _entities[last];
+			_sparse[_entities[pos].index()] = pos;
+		}
+		_data.pop_back();
+		_entities.pop_back();
+		_sparse[entity.index()] = NONE;
+	}
+
+	bool has(Entity entity) const
+	{
+		const uint32_t index = entity.index();
+		return index < _sparse.size() && _sparse[index] != NONE && _entities[_sparse[index]] == entity;
+	}
+
+	T* get(Entity entity) { return has(entity) ? &_data[_sparse[entity.index()]] : nullptr; }
+	const T* get(Entity entity) const { return has(entity) ? &_data[_sparse[entity.index()]] : nullptr; }
+
+	void reserve(size_t count)
+	{
+		_sparse.reserve(count);
+		_entities.reserve(count);
+		_data.reserve(count);
+	}
+
+	// Recorrido denso
+	size_t size() const { return _data.size(); }
+	T& at(size_t pos) { return _data[pos]; }
+	const T& at(size_t pos) const { return _data[pos]; }
+	Entity entityAt(size_t pos) const { return _entities[pos]; }
+};
+
+class Scene {
+
+	std::vector<uint32_t> _generations; // por indice de entidad
+	std::vector<uint32_t> _freeIndices;
+	size_t _alive = 0;
+	uint64_t _version = 1;
+
+public:
+	ComponentStore<Transform> transforms;
+	ComponentStore<MeshRenderer> renderers;
+	ComponentStore<Bounds> bounds;
+	ComponentStore<MaterialRef> materials;
+
+	Entity create();
+	// Quita la entidad de todos los componentes; sus handles dejan de ser validos
+	void destroy(Entity entity);
+	bool alive(Entity entity) const;
+	size_t entityCount() const { return _alive; }
+	void clear();
+	// Reserva para 'count' entidades con todos los componentes (carga de escenas)
+	void reserve(size_t count);
+
+	// Entidad con transform, malla, bounds y material a partir de una malla cargada
+	Entity spawnMesh(MeshHandle mesh, const Transform& transform = Transform());
+	// Copia de nuevo las bounds locales de la malla en las entidades que la usan (tras recargarla)
+	void refreshMeshBounds(MeshHandle mesh);
+
+	// Sube con cada cambio de la escena: altas, bajas, clear y mallas recargadas.
+	// La extraccion del frame se salta transforms, bounds y culling si no ha
+	// cambiado, asi que quien escriba componentes directamente (mover una
+	// entidad, cambiar su malla) tiene que llamar a markChanged()
+	uint64_t version() const { return _version; }
+	void markChanged() { _version++; }
+};
+
+// Sistemas: recorren los arrays densos por bloques repartidos en el JobSystem
+namespace SceneSystems
+{
+	const size_t CHUNK_SIZE = 1024;
+
+	void updateTransforms(Scene& scene);
+	void updateBounds(Scene& scene);
+
+	// Lista de draws visibles, ordenada con sortDraws
+	void extractDraws(const Scene& scene, const Frustum& frustum, const glm::mat4& view, FramePacket& packet);
+}
@@ -0,0 +1,329 @@
+#include "SceneFile.h"
+#include "Scene.h"
+#include "Mesh.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+using namespace std;
+
+using hrclock = chrono::high_resolution_clock;
+
+static_assert(sizeof(SceneFileHeader) == 80, "El formato de la escena depende del tamano de los registros");
+static_assert(sizeof(SceneEntityRecord) == 48, "El formato de la escena depende del tamano de los registros");
+static_assert(sizeof(SceneAssetRecord) == 24, "El formato de la escena depende del tamano de los registros");
+static_assert(sizeof(SceneMaterialRecord) == 24, "El formato de la escena depende del tamano de los registros");
+
+namespace
+{
+	const uint32_t NONE = SceneEntityRecord::NONE;
+
+	struct AssetSource
+	{
+		string path;
+		uint32_t subIndex = 0;
+	};
+
+	// Por valor del handle
+	unordered_map<uint32_t, AssetSource> meshSources;
+	unordered_map<uint32_t, AssetSource> textureSources;
+
+	// Escritura secuencial con un buffer propio: el fichero no se monta entero en memoria
+	class StreamWriter {
+
+		FILE* _file = nullptr;
+		vector<unsigned char> _buffer;
+		size_t _used = 0;
+		uint64_t _position = 0;
+		bool _failed = false;
+
+	public:
+		explicit StreamWriter(FILE* file) : _file(file), _buffer(64 * 1024) {}
+
+		void write(const void* data, size_t size)
+		{
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			_position += size;
+			if (_used + size > _buffer.size()) {
+				flush();
+				if (size > _buffer.size()) {
+					_failed = _failed || fwrite(bytes, 1, size, _file) != size;
+					return;
+				}
+			}
+			memcpy(_buffer.data() + _used, bytes, size);
+			_used += size;
+		}
+
+		void align8()
+		{
+			static const unsigned char zeros[8] = {};
+			write(zeros, static_cast<size_t>(((_position + 7) & ~uint64_t(7)) - _position));
+		}
+
+		void flush()
+		{
+			if (_used) _failed = _failed || fwrite(_buffer.data(), 1, _used, _file) != _used;
+			_used = 0;
+		}
+
+		uint64_t position() const { return _position; }
+		bool failed() const { return _failed; }
+	};
+
+	bool sectionFits(uint64_t offset, uint64_t count, size_t recordSize, size_t fileSize)
+	{
+		return offset <= fileSize && offset % 8 == 0 && count <= (fileSize - offset) / recordSize;
+	}
+}
+
+void SceneFile::trackModel(const char* path, const vector<MeshHandle>& meshes)
+{
+	for (size_t i = 0; i < meshes.size(); i++) meshSources[meshes[i].value] = { path, static_cast<uint32_t>(i) };
+}
+
+void SceneFile::trackTexture(const char* path, TextureHandle texture)
+{
+	if (!texture.isNull()) textureSources[texture.value] = { path, 0 };
+}
+
+bool SceneFile::save(const char* path, const Scene& scene, const SimState& camera)
+{
+	PROFILE_FUNCTION();
+	const string temporary = string(path) + ".tmp";
+	FILE* f = fopen(temporary.c_str(), "wb");
+	if (!f) {
+		fprintf(stderr, "No se puede escribir %s\n", temporary.c_str());
+		return false;
+	}
+
+	// Una entrada por asset/material distinto, no por entidad
+	vector<SceneAssetRecord> assets;
+	vector<SceneMaterialRecord> materials;
+	string paths;
+	unordered_map<uint32_t, uint32_t> meshIndex, textureIndex, materialIndex;
+	auto addAsset = [&](uint32_t kind, uint32_t handle, uint64_t hash, const unordered_map<uint32_t, AssetSource>& sources) {
+		SceneAssetRecord record = {};
+		record.contentHash = hash;
+		record.kind = kind;
+		const auto source = sources.find(handle);
+		if (source != sources.end()) {
+			record.subIndex = source->second.subIndex;
+			record.pathOffset = static_cast<uint32_t>(paths.size());
+			record.pathLength = static_cast<uint32_t>(source->second.path.size());
+			paths += source->second.path;
+		}
+		assets.push_back(record);
+		return static_cast<uint32_t>(assets.size() - 1);
+	};
+	auto meshAsset = [&](MeshHandle handle) {
+		const MeshData* meshData = Resources::meshes.get(handle);
+		if (!meshData) return NONE;
+		const auto found = meshIndex.find(handle.value);
+		if (found != meshIndex.end()) return found->second;
+		return meshIndex[handle.value] = addAsset(SceneAssetRecord::Mesh, handle.value, meshData->contentHash, meshSources);
+	};
+	auto materialRecord = [&](MaterialHandle handle) {
+		const Material* material = Resources::materials.get(handle);
+		if (!material) return NONE;
+		const auto found = materialIndex.find(handle.value);
+		if (found != materialIndex.end()) return found->second;
+		SceneMaterialRecord record = {};
+		record.texture = NONE;
+		record.color = material->color;
+		if (const Texture* texture = Resources::textures.get(material->diffuse)) {
+			const auto known = textureIndex.find(material->diffuse.value);
+			record.texture = known != textureIndex.end() ? known->second
+				: (textureIndex[material->diffuse.value] = addAsset(SceneAssetRecord::Texture, material->diffuse.value, texture->contentHash, textureSources));
+		}
+		materials.push_back(record);
+		return materialIndex[handle.value] = static_cast<uint32_t>(materials.size() - 1);
+	};
+
+	SceneFileHeader header = {};
+	header.magic = SceneFileHeader::MAGIC;
+	header.version = SceneFileHeader::VERSION;
+	header.entityCount = scene.transforms.size();
+	header.camera[0] = camera.rotationX;
+	header.camera[1] = camera.rotationY;
+	header.camera[2] = camera.zoomLevel;
+	header.camera[3] = camera.cameraOffsetX;
+	header.camera[4] = camera.cameraOffsetY;
+
+	StreamWriter out(f);
+	out.write(&header, sizeof(header)); // se reescribe al final con los offsets
+	header.entitiesOffset = out.position();
+	for (size_t i = 0; i < scene.transforms.size(); i++) {
+		const Entity entity = scene.transforms.entityAt(i);
+		const Transform& t = scene.transforms.at(i);
+		SceneEntityRecord record;
+		record.position = t.position;
+		record.rotation = t.rotation;
+		record.scale = t.scale;
+		const MeshRenderer* renderer = scene.renderers.get(entity);
+		const MaterialRef* material = scene.materials.get(entity);
+		record.mesh = renderer ? meshAsset(renderer->mesh) : NONE;
+		record.material = material ? materialRecord(material->material) : NONE;
+		record.reserved = 0;
+		out.write(&record, sizeof(record));
+	}
+	header.assetCount = static_cast<uint32_t>(assets.size());
+	header.materialCount = static_cast<uint32_t>(materials.size());
+	header.assetsOffset = out.position();
+	out.write(assets.data(), assets.size() * sizeof(SceneAssetRecord));
+	header.materialsOffset = out.position();
+	out.write(materials.data(), materials.size() * sizeof(SceneMaterialRecord));
+	header.pathsOffset = out.position();
+	out.write(paths.data(), paths.size());
+	out.flush();
+
+	bool ok = !out.failed() && fseek(f, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, f) == 1;
+	ok = fclose(f) == 0 && ok;
+	error_code error;
+	if (ok) filesystem::rename(temporary, path, error);
+	if (!ok || error) {
+		fprintf(stderr, "Error al guardar la escena en %s\n", path);
+		::remove(temporary.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool SceneFile::load(const char* path, Scene& scene, SimState& camera, SceneLoadStats* stats)
+{
+	PROFILE_FUNCTION();
+	const auto t0 = hrclock::now();
+	MappedFile file;
+	if (!file.open(path)) {
+		fprintf(stderr, "No se puede abrir la escena %s\n", path);
+		return false;
+	}
+	file.advise(MapAccess::Sequential);
+	const unsigned char* data = file.data();
+	const size_t size = file.size();
+	SceneFileHeader header;
+	bool valid = size >= sizeof(header);
+	if (valid) {
+		memcpy(&header, data, sizeof(header));
+		valid = header.magic == SceneFileHeader::MAGIC && header.version == SceneFileHeader::VERSION
+			&& sectionFits(header.entitiesOffset, header.entityCount, sizeof(SceneEntityRecord), size)
+			&& sectionFits(header.assetsOffset, header.assetCount, sizeof(SceneAssetRecord), size)
+			&& sectionFits(header.materialsOffset, header.materialCount, sizeof(SceneMaterialRecord), size)
+			&& header.pathsOffset <= size;
+	}
+	if (!valid) {
+		fprintf(stderr, "%s no es una escena valida (o es de otra version)\n", path);
+		return false;
+	}
+	const SceneEntityRecord* entities = reinterpret_cast<const SceneEntityRecord*>(data + header.entitiesOffset);
+	const SceneAssetRecord* assets = reinterpret_cast<const SceneAssetRecord*>(data + header.assetsOffset);
+	const SceneMaterialRecord* materialRecords = reinterpret_cast<const SceneMaterialRecord*>(data + header.materialsOffset);
+	const char* paths = reinterpret_cast<const char*>(data + header.pathsOffset);
+	const size_t pathsSize = size - header.pathsOffset;
+	SceneLoadStats result;
+
+	// Assets: primero lo que ya esta cargado (por hash) y si no, su ruta
+	unordered_map<uint64_t, uint32_t> loadedMeshes, loadedTextures;
+	for (size_t i = 0; i < Resources::meshes.size(); i++) {
+		const MeshHandle handle = Resources::meshes.handleAt(i);
+		loadedMeshes.emplace(Resources::meshes.get(handle)->contentHash, handle.value);
+	}
+	for (size_t i = 0; i < Resources::textures.size(); i++) {
+		const TextureHandle handle = Resources::textures.handleAt(i);
+		loadedTextures.emplace(Resources::textures.get(handle)->contentHash, handle.value);
+	}
+	unordered_map<string, vector<MeshHandle>> importedModels;
+	vector<uint32_t> assetHandles(header.assetCount, 0);
+	for (uint32_t a = 0; a < header.assetCount; a++) {
+		const SceneAssetRecord& asset = assets[a];
+		const bool isMesh = asset.kind == SceneAssetRecord::Mesh;
+		unordered_map<uint64_t, uint32_t>& loaded = isMesh ? loadedMeshes : loadedTextures;
+		auto found = loaded.find(asset.contentHash);
+		if (found != loaded.end()) {
+			assetHandles[a] = found->second;
+			continue;
+		}
+		if (asset.pathLength == 0 || asset.pathOffset > pathsSize || asset.pathLength > pathsSize - asset.pathOffset) {
+			result.assetsMissing++;
+			continue;
+		}
+		const string source(paths + asset.pathOffset, asset.pathLength);
+		if (isMesh) {
+			auto model = importedModels.find(source);
+			if (model == importedModels.end()) {
+				ImportedModel imported = importFBX(source.c_str());
+				model = importedModels.emplace(source, uploadModel(imported)).first;
+				trackModel(source.c_str(), model->second);
+				for (const MeshHandle handle : model->second) loaded.emplace(Resources::meshes.get(handle)->contentHash, handle.value);
+			}
+			found = loaded.find(asset.contentHash);
+			if (found != loaded.end()) assetHandles[a] = found->second;
+			else if (asset.subIndex < model->second.size()) {
+				// El fichero ha cambiado desde que se guardo: la malla que estaba en esa posicion
+				fprintf(stderr, "Escena: %s ha cambiado, se usa la malla %u\n", source.c_str(), asset.subIndex);
+				assetHandles[a] = model->second[asset.subIndex].value;
+			}
+		}
+		else {
+			const TextureHandle texture = uploadTexture(decodeImage(source.c_str()));
+			trackTexture(source.c_str(), texture);
+			assetHandles[a] = texture.value;
+			if (const Texture* t = Resources::textures.get(texture)) loaded.emplace(t->contentHash, texture.value);
+		}
+		if (assetHandles[a]) result.assetsImported++;
+		else result.assetsMissing++;
+	}
+
+	// Materiales: se reutiliza uno igual si ya existe
+	vector<MaterialHandle> materialHandles(header.materialCount);
+	for (uint32_t m = 0; m < header.materialCount; m++) {
+		const SceneMaterialRecord& record = materialRecords[m];
+		TextureHandle texture;
+		if (record.texture < header.assetCount && assets[record.texture].kind == SceneAssetRecord::Texture) texture.value = assetHandles[record.texture];
+		for (size_t i = 0; i < Resources::materials.size() && materialHandles[m].isNull(); i++) {
+			const MaterialHandle handle = Resources::materials.handleAt(i);
+			const Material* material = Resources::materials.get(handle);
+			if (material->diffuse == texture && material->color == record.color) materialHandles[m] = handle;
+		}
+		if (materialHandles[m].isNull()) materialHandles[m] = Resources::materials.insert({ texture, record.color });
+	}
+
+	// Entidades: una pasada secuencial por el mapeo, sin reservas por objeto
+	scene.clear();
+	scene.reserve(static_cast<size_t>(header.entityCount));
+	for (uint64_t i = 0; i < header.entityCount; i++) {
+		const SceneEntityRecord& record = entities[i];
+		const Entity entity = scene.create();
+		Transform transform;
+		transform.position = record.position;
+		transform.rotation = record.rotation;
+		transform.scale = record.scale;
+		scene.transforms.add(entity, transform);
+
+		MeshHandle mesh;
+		if (record.mesh < header.assetCount && assets[record.mesh].kind == SceneAssetRecord::Mesh) mesh.value = assetHandles[record.mesh];
+		if (const MeshData* meshData = Resources::meshes.get(mesh)) {
+			scene.renderers.add(entity, { mesh });
+			Bounds b;
+			b.localMin = meshData->boundsMin;
+			b.localMax = meshData->boundsMax;
+			scene.bounds.add(entity, b);
+		}
+		if (record.material < header.materialCount) scene.materials.add(entity, { materialHandles[record.material] });
+	}
+
+	camera.rotationX = header.camera[0];
+	camera.rotationY = header.camera[1];
+	camera.zoomLevel = header.camera[2];
+	camera.cameraOffsetX = header.camera[3];
+	camera.cameraOffsetY = header.camera[4];
+
+	result.entities = static_cast<size_t>(header.entityCount);
+	result.ms = chrono::duration<double, milli>(hrclock::now() - t0).count();
+	if (stats) *stats = result;
+	return true;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "Resources.h"
+#include "Simulation.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+class Scene;
+
+// Escena guardada en binario (.oysc). Little endian, cada seccion alineada a 8:
+//   SceneFileHeader
+//   SceneEntityRecord[entityCount]
+//   SceneAssetRecord[assetCount]       mallas y texturas por contentHash
+//   SceneMaterialRecord[materialCount]
+//   rutas de los assets seguidas, sin terminador
+// Las entidades van antes que las tablas para poder escribirlas en una sola
+// pasada: las tablas se completan mientras se recorren.
+struct SceneFileHeader
+{
+	static const uint32_t MAGIC = 0x4353594F; // "OYSC"
+	static const uint32_t VERSION = 1;
+
+	uint32_t magic;
+	uint32_t version;
+	uint32_t assetCount;
+	uint32_t materialCount;
+	uint64_t entityCount;
+	uint64_t entitiesOffset;
+	uint64_t assetsOffset;
+	uint64_t materialsOffset;
+	uint64_t pathsOffset;
+	float camera[5]; // rotationX, rotationY, zoomLevel, cameraOffsetX, cameraOffsetY
+	uint32_t reserved;
+};
+
+struct SceneEntityRecord
+{
+	static const uint32_t NONE = 0xFFFFFFFFu;
+
+	glm::vec3 position;
+	glm::vec3 rotation;
+	glm::vec3 scale;
+	uint32_t mesh;     // indice en los assets o NONE
+	uint32_t material; // indice en los materiales o NONE
+	uint32_t reserved;
+};
+
+struct SceneAssetRecord
+{
+	enum Kind : uint32_t { Mesh = 0, Texture = 1 };
+
+	uint64_t contentHash;
+	uint32_t kind;
+	uint32_t subIndex;   // malla dentro del modelo
+	uint32_t pathOffset; // fichero del que salio; longitud 0 si no se sabe
+	uint32_t pathLength;
+};
+
+struct SceneMaterialRecord
+{
+	uint32_t texture; // indice en los assets o NONE
+	uint32_t reserved;
+	glm::vec4 color;
+};
+
+struct SceneLoadStats
+{
+	size_t entities = 0;
+	size_t assetsImported = 0; // no estaban cargados y se han leido de su ruta
+	size_t assetsMissing = 0;  // ni cargados ni en su ruta: sus entidades quedan sin malla/textura
+	double ms = 0.0;
+};
+
+namespace SceneFile
+{
+	// De donde sale cada asset, para poder guardarlo con su ruta
+	void trackModel(const char* path, const std::vector<MeshHandle>& meshes);
+	void trackTexture(const char* path, TextureHandle texture);
+
+	// Escribe por bloques a un temporal y lo renombra al terminar
+	bool save(const char* path, const Scene& scene, const SimState& camera);
+
+	// Sustituye el contenido de 'scene' y la camara. El fichero se proyecta en
+	// memoria y las entidades se crean en una pasada sobre arrays ya reservados.
+	// Los assets se buscan primero por hash entre los cargados y si no estan se
+	// importan de su ruta, asi que va en el hilo del contexto y entre frames.
+	bool load(const char* path, Scene& scene, SimState& camera, SceneLoadStats* stats = nullptr);
+}
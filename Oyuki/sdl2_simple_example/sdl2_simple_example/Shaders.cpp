@@ -0,0 +1,264 @@
+#include "Shaders.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+using namespace std;
+
+using hrclock = chrono::high_resolution_clock;
+
+namespace
+{
+	struct BinaryHeader
+	{
+		static const uint32_t MAGIC = 0x4253594F; // "OYSB"
+		static const uint32_t VERSION = 1;
+
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceHash;
+		uint64_t driverHash;
+		uint32_t format; // el que devuelve glGetProgramBinary
+		uint32_t length;
+	};
+
+	struct Pending
+	{
+		string name;
+		uint64_t sourceHash = 0;
+		GLuint program = 0;
+		GLuint vertex = 0;
+		GLuint fragment = 0;
+		bool fromCache = false;
+	};
+
+	string cacheDirectory;
+	bool binaryCache = false;
+	bool parallelCompile = false;
+	uint64_t driverHash = 0;
+
+	vector<Pending> pending;
+	hrclock::time_point submitTime;
+	ShaderStats shaderStats;
+
+	uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	// El terminador entra en el hash para que "ab" + "c" no sea igual que "a" + "bc"
+	uint64_t hashSource(const ShaderSource& source)
+	{
+		uint64_t hash = fnv1a(source.vertex.c_str(), source.vertex.size() + 1);
+		hash = fnv1a(source.fragment.c_str(), source.fragment.size() + 1, hash);
+		for (const string& attribute : source.attributes) hash = fnv1a(attribute.c_str(), attribute.size() + 1, hash);
+		return hash;
+	}
+
+	string glString(GLenum name)
+	{
+		const GLubyte* value = glGetString(name);
+		return value ? string(reinterpret_cast<const char*>(value)) : string();
+	}
+
+	string cachePath(const string& name)
+	{
+		return cacheDirectory + "/" + name + ".glbin";
+	}
+
+	// El binario se pasa al driver directamente desde el mapeo del fichero
+	bool loadBinary(Pending& p)
+	{
+		MappedFile file;
+		if (!file.open(cachePath(p.name).c_str()) || file.size() < sizeof(BinaryHeader)) return false;
+		BinaryHeader header;
+		memcpy(&header, file.data(), sizeof(header));
+		if (header.magic != BinaryHeader::MAGIC || header.version != BinaryHeader::VERSION
+			|| header.sourceHash != p.sourceHash || header.driverHash != driverHash
+			|| header.length > file.size() - sizeof(header)) return false;
+
+		p.program = glCreateProgram();
+		glProgramBinary(p.program, header.format, file.data() + sizeof(header), static_cast<GLsizei>(header.length));
+		GLint linked = GL_FALSE;
+		glGetProgramiv(p.program, GL_LINK_STATUS, &linked);
+		if (!linked) {
+			glDeleteProgram(p.program);
+			p.program = 0;
+			return false;
+		}
+		return true;
+	}
+
+	void saveBinary(const Pending& p)
+	{
+		GLint length = 0;
+		glGetProgramiv(p.program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) return;
+		vector<unsigned char> blob(sizeof(BinaryHeader) + length);
+		GLenum format = 0;
+		glGetProgramBinary(p.program, length, &length, &format, blob.data() + sizeof(BinaryHeader));
+
+		BinaryHeader header;
+		header.magic = BinaryHeader::MAGIC;
+		header.version = BinaryHeader::VERSION;
+		header.sourceHash = p.sourceHash;
+		header.driverHash = driverHash;
+		header.format = format;
+		header.length = static_cast<uint32_t>(length);
+		memcpy(blob.data(), &header, sizeof(header));
+
+		// Primero a un temporal: nunca queda un binario a medias con el nombre bueno
+		const string path = cachePath(p.name);
+		const string temporary = path + ".tmp";
+		FILE* f = fopen(temporary.c_str(), "wb");
+		if (!f) return;
+		const bool written = fwrite(blob.data(), 1, sizeof(header) + length, f) == sizeof(header) + length;
+		if (fclose(f) != 0 || !written) {
+			::remove(temporary.c_str());
+			return;
+		}
+		error_code error;
+		filesystem::rename(temporary, path, error);
+		if (error) ::remove(temporary.c_str());
+	}
+
+	GLuint compileShader(GLenum type, const string& source)
+	{
+		const GLuint shader = glCreateShader(type);
+		const GLchar* text = source.c_str();
+		glShaderSource(shader, 1, &text, nullptr);
+		glCompileShader(shader);
+		return shader;
+	}
+
+	bool checkShader(GLuint shader, const string& name, const char* stage)
+	{
+		GLint compiled = GL_FALSE;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+		if (compiled) return true;
+		char log[1024];
+		glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+		fprintf(stderr, "Shader %s (%s): %s\n", name.c_str(), stage, log);
+		return false;
+	}
+}
+
+void Shaders::init(const char* directory)
+{
+	cacheDirectory = directory ? directory : "";
+	driverHash = fnv1a("", 0);
+	for (const GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+		const string value = glString(name);
+		driverHash = fnv1a(value.c_str(), value.size() + 1, driverHash);
+	}
+
+	GLint formats = 0;
+	if (GLEW_ARB_get_program_binary) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	binaryCache = !cacheDirectory.empty() && formats > 0;
+	if (binaryCache) {
+		error_code error;
+		filesystem::create_directories(cacheDirectory, error);
+		binaryCache = !error;
+	}
+
+	// 0xFFFFFFFF: el driver usa los hilos que crea convenientes
+	if (GLEW_KHR_parallel_shader_compile) glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+	else if (GLEW_ARB_parallel_shader_compile) glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+	parallelCompile = GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+}
+
+bool Shaders::binaryCacheEnabled()
+{
+	return binaryCache;
+}
+
+bool Shaders::parallelCompileEnabled()
+{
+	return parallelCompile;
+}
+
+void Shaders::submit(const vector<ShaderSource>& sources)
+{
+	PROFILE_FUNCTION();
+	if (pending.empty()) submitTime = hrclock::now();
+	for (const ShaderSource& source : sources) {
+		Pending p;
+		p.name = source.name;
+		p.sourceHash = hashSource(source);
+		p.fromCache = binaryCache && loadBinary(p);
+		if (!p.fromCache) {
+			// Sin consultar el estado: eso obligaria al driver a terminar este antes de empezar el siguiente
+			p.vertex = compileShader(GL_VERTEX_SHADER, source.vertex);
+			p.fragment = compileShader(GL_FRAGMENT_SHADER, source.fragment);
+			p.program = glCreateProgram();
+			glAttachShader(p.program, p.vertex);
+			glAttachShader(p.program, p.fragment);
+			for (size_t i = 0; i < source.attributes.size(); i++)
+				glBindAttribLocation(p.program, static_cast<GLuint>(i), source.attributes[i].c_str());
+			if (binaryCache) glProgramParameteri(p.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+			glLinkProgram(p.program);
+		}
+		pending.push_back(move(p));
+	}
+}
+
+vector<ShaderHandle> Shaders::finish()
+{
+	PROFILE_FUNCTION();
+	vector<ShaderHandle> handles;
+	handles.reserve(pending.size());
+	for (Pending& p : pending) {
+		shaderStats.programs++;
+		bool linked = p.fromCache;
+		if (!p.fromCache) {
+			const bool compiled = checkShader(p.vertex, p.name, "vertex") & checkShader(p.fragment, p.name, "fragment");
+			GLint status = GL_FALSE;
+			glGetProgramiv(p.program, GL_LINK_STATUS, &status);
+			linked = compiled && status;
+			if (compiled && !status) {
+				char log[1024];
+				glGetProgramInfoLog(p.program, sizeof(log), nullptr, log);
+				fprintf(stderr, "Shader %s (link): %s\n", p.name.c_str(), log);
+			}
+			// El programa enlazado ya no los necesita
+			glDetachShader(p.program, p.vertex);
+			glDetachShader(p.program, p.fragment);
+			glDeleteShader(p.vertex);
+			glDeleteShader(p.fragment);
+			if (linked && binaryCache) saveBinary(p);
+		}
+
+		if (!linked) {
+			glDeleteProgram(p.program);
+			shaderStats.failed++;
+			handles.push_back(ShaderHandle());
+			continue;
+		}
+		if (p.fromCache) shaderStats.fromCache++;
+		else shaderStats.compiled++;
+		ShaderProgram program;
+		program.id = p.program;
+		handles.push_back(Resources::shaders.insert(program));
+	}
+	if (!pending.empty()) shaderStats.ms += chrono::duration<double, milli>(hrclock::now() - submitTime).count();
+	pending.clear();
+	return handles;
+}
+
+const ShaderStats& Shaders::stats()
+{
+	return shaderStats;
+}
+
+void Shaders::print(FILE* f)
+{
+	fprintf(f, "Shaders: %d programas (%d del cache, %d compilados, %d con errores) en %.2f ms; cache %s, compilacion paralela %s\n",
+		shaderStats.programs, shaderStats.fromCache, shaderStats.compiled, shaderStats.failed, shaderStats.ms,
+		binaryCache ? "si" : "no", parallelCompile ? "si" : "no");
+}
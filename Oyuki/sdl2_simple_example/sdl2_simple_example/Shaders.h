@@ -0,0 +1,45 @@
+#pragma once
+#include "Resources.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+struct ShaderSource
+{
+	std::string name; // tambien el nombre del fichero en el cache
+	std::string vertex;
+	std::string fragment;
+	std::vector<std::string> attributes; // la posicion en el vector es la location
+};
+
+struct ShaderStats
+{
+	int programs = 0;
+	int fromCache = 0;
+	int compiled = 0;
+	int failed = 0;
+	double ms = 0.0; // de submit a finish
+};
+
+// Programas GLSL con cache de binarios (glGetProgramBinary / glProgramBinary).
+// Cada binario se guarda en <cache>/<nombre>.glbin junto con el hash del codigo
+// y el del driver (vendor, renderer y version): si cualquiera cambia, o el
+// driver rechaza el binario, se compila de nuevo y se reescribe sin avisar.
+// Las compilaciones se lanzan todas antes de consultar ninguna; con
+// KHR/ARB_parallel_shader_compile el driver las hace en sus hilos mientras el
+// hilo principal sigue con otra cosa hasta finish().
+namespace Shaders
+{
+	// Despues de glewInit. Sin directorio (o sin formatos de binario) no hay cache.
+	void init(const char* cacheDirectory);
+	bool binaryCacheEnabled();
+	bool parallelCompileEnabled();
+
+	void submit(const std::vector<ShaderSource>& sources);
+	// Espera a lo enviado y guarda los binarios nuevos. Los handles van en el
+	// orden de submit; nulo si el programa no compila (el log va a stderr).
+	std::vector<ShaderHandle> finish();
+
+	const ShaderStats& stats();
+	void print(FILE* f);
+}
@@ -0,0 +1,793 @@
+#include "SimdMath.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define OYUKI_SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define OYUKI_SIMD_X86 0
+#endif
+
+// MSVC deja usar cualquier intrinseco sin /arch; GCC y Clang necesitan marcar la funcion
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TARGET_SSE41
+#define TARGET_AVX2
+#define TARGET_AVX2_NO_FMA
+#else
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+// Sin fma GCC no puede juntar multiplicacion y suma (-ffp-contract=fast)
+#define TARGET_AVX2_NO_FMA __attribute__((target("avx2")))
+#endif
+
+using namespace std;
+
+namespace
+{
+	SimdLevel detectLevel()
+	{
+#if !OYUKI_SIMD_X86
+		return SimdLevel::Scalar;
+#elif defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		const int maxLeaf = info[0];
+		__cpuid(info, 1);
+		const bool sse41 = (info[2] & (1 << 19)) != 0;
+		const bool fma = (info[2] & (1 << 12)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		const bool f16c = (info[2] & (1 << 29)) != 0;
+		bool avx2 = false;
+		// Ademas de la CPU, el sistema operativo tiene que guardar los registros YMM
+		if (maxLeaf >= 7 && fma && f16c && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+		return avx2 ? SimdLevel::AVX2 : sse41 ? SimdLevel::SSE41 : SimdLevel::Scalar;
+#else
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c")) return SimdLevel::AVX2;
+		if (__builtin_cpu_supports("sse4.1")) return SimdLevel::SSE41;
+		return SimdLevel::Scalar;
+#endif
+	}
+
+	const SimdLevel supported = detectLevel();
+	SimdLevel current = supported;
+
+	const float* floatAt(const void* base, size_t i, size_t stride)
+	{
+		return reinterpret_cast<const float*>(static_cast<const char*>(base) + i * stride);
+	}
+
+	float* floatAt(void* base, size_t i, size_t stride)
+	{
+		return reinterpret_cast<float*>(static_cast<char*>(base) + i * stride);
+	}
+
+	// ---- Escalar: referencia y resto de los bucles SIMD ----
+
+	void multiplyScalar(const float* a, const float* b, float* out, size_t count)
+	{
+		for (size_t i = 0; i < count; i++, a += 16, b += 16, out += 16) {
+			float r[16];
+			for (int c = 0; c < 4; c++)
+				for (int row = 0; row < 4; row++)
+					r[c * 4 + row] = a[row] * b[c * 4] + a[4 + row] * b[c * 4 + 1] + a[8 + row] * b[c * 4 + 2] + a[12 + row] * b[c * 4 + 3];
+			memcpy(out, r, sizeof(r));
+		}
+	}
+
+	void transformScalar(const float* models, const void* localMin, const void* localMax, void* worldMin, void* worldMax,
+		size_t begin, size_t end, size_t stride)
+	{
+		for (size_t i = begin; i < end; i++) {
+			const float* m = models + i * 16;
+			const float* lo = floatAt(localMin, i, stride);
+			const float* hi = floatAt(localMax, i, stride);
+			float mn[3] = { m[12], m[13], m[14] };
+			float mx[3] = { m[12], m[13], m[14] };
+			for (int c = 0; c < 3; c++) {
+				for (int r = 0; r < 3; r++) {
+					const float a = m[c * 4 + r] * lo[c];
+					const float b = m[c * 4 + r] * hi[c];
+					mn[r] += a < b ? a : b;
+					mx[r] += a < b ? b : a;
+				}
+			}
+			memcpy(floatAt(worldMin, i, stride), mn, sizeof(mn));
+			memcpy(floatAt(worldMax, i, stride), mx, sizeof(mx));
+		}
+	}
+
+	void cullScalar(const Frustum& frustum, const SimdMath::AabbSoA& b, size_t begin, size_t end, unsigned char* visible)
+	{
+		for (size_t i = begin; i < end; i++) {
+			visible[i] = isVisible(frustum, glm::vec3(b.minX[i], b.minY[i], b.minZ[i]), glm::vec3(b.maxX[i], b.maxY[i], b.maxZ[i]));
+		}
+	}
+
+	// Mismo orden de operandos que _mm_min_ps/_mm_max_ps para dar el mismo resultado
+	int rayAabb4Scalar(const float origin[3], const float invDir[3], const float* boxes, float maxT, float tNear[4])
+	{
+		int mask = 0;
+		for (int k = 0; k < 4; k++) {
+			float enter = 0.0f, exit = maxT;
+			for (int c = 0; c < 3; c++) {
+				const float t0 = (boxes[c * 4 + k] - origin[c]) * invDir[c];
+				const float t1 = (boxes[12 + c * 4 + k] - origin[c]) * invDir[c];
+				const float lo = t0 < t1 ? t0 : t1;
+				const float hi = t0 > t1 ? t0 : t1;
+				enter = enter > lo ? enter : lo;
+				exit = exit < hi ? exit : hi;
+			}
+			tNear[k] = enter;
+			if (enter <= exit) mask |= 1 << k;
+		}
+		return mask;
+	}
+
+	void scaleToDoubleScalar(const float* src, size_t begin, size_t end, float scale, double* dst)
+	{
+		for (size_t i = begin; i < end; i++) dst[i] = src[i] * scale;
+	}
+
+	void scaleFloatsScalar(const float* src, size_t begin, size_t end, float scale, float* dst)
+	{
+		for (size_t i = begin; i < end; i++) dst[i] = src[i] * scale;
+	}
+
+	void boundsScalar(const float* xyz, size_t begin, size_t end, float mn[3], float mx[3])
+	{
+		for (size_t i = begin; i < end; i++) {
+			for (int c = 0; c < 3; c++) {
+				const float v = xyz[i * 3 + c];
+				if (v < mn[c]) mn[c] = v;
+				if (v > mx[c]) mx[c] = v;
+			}
+		}
+	}
+
+	// Limites como _mm_max_ps/_mm_min_ps: un NaN acaba en -1
+	int32_t snorm10(float v)
+	{
+		v = v > -1.0f ? v : -1.0f;
+		v = v < 1.0f ? v : 1.0f;
+		return static_cast<int32_t>(lrintf(v * 511.0f));
+	}
+
+	void packNormalsScalar(const float* xyz, size_t begin, size_t end, uint32_t* dst)
+	{
+		for (size_t i = begin; i < end; i++) {
+			const float* n = xyz + i * 3;
+			dst[i] = (snorm10(n[0]) & 0x3FF) | (snorm10(n[1]) & 0x3FF) << 10 | (snorm10(n[2]) & 0x3FF) << 20;
+		}
+	}
+
+	void packTexCoordsScalar(const float* xyz, size_t begin, size_t end, uint32_t* dst)
+	{
+		for (size_t i = begin; i < end; i++) {
+			dst[i] = SimdMath::floatToHalf(xyz[i * 3]) | static_cast<uint32_t>(SimdMath::floatToHalf(xyz[i * 3 + 1])) << 16;
+		}
+	}
+
+	// Enteros entrelazados (componente k % 3 ya desplazada a su sitio) -> una palabra por normal
+	void orTriples(const uint32_t* fields, size_t normals, uint32_t* dst)
+	{
+		for (size_t k = 0; k < normals; k++) dst[k] = fields[k * 3] | fields[k * 3 + 1] | fields[k * 3 + 2];
+	}
+
+	// Carriles del bloque que empieza en x que caen dentro de [begin, end)
+	int spanLanes(int x, int begin, int end, int lanes)
+	{
+		int mask = (1 << lanes) - 1;
+		if (x < begin) mask &= ~((1 << (begin - x)) - 1);
+		if (end - x < lanes) mask &= (1 << (end - x)) - 1;
+		return mask;
+	}
+
+	// Carriles de 'mask' que pasan la profundidad: escriben z y se apuntan en covered
+	int storeCovered(int x, int mask, const float* z, float* depthRow, uint16_t* covered, int n)
+	{
+		for (int k = 0; mask; k++, mask >>= 1) {
+			if (!(mask & 1)) continue;
+			depthRow[x + k] = z[k];
+			covered[n++] = static_cast<uint16_t>(x + k);
+		}
+		return n;
+	}
+
+	// Las versiones SIMD hacen las mismas operaciones en el mismo orden (sin FMA) y
+	// pintan exactamente los mismos pixeles
+	int rasterSpanScalar(const SimdMath::RasterEdges& t, int y, int begin, int end, float* depthRow, uint16_t* covered)
+	{
+		const float py = y + 0.5f;
+		float row[3];
+		for (int k = 0; k < 3; k++) row[k] = t.b[k] * py + t.c[k];
+		const float zRow = t.z0 + t.dzdy * (py - t.y0);
+		int n = 0;
+		for (int x = begin; x < end; x++) {
+			const float px = x + 0.5f;
+			bool inside = true;
+			for (int k = 0; k < 3; k++) {
+				const float e = t.a[k] * px + row[k];
+				inside = inside && (e > 0.0f || (e == 0.0f && t.topLeft[k]));
+			}
+			if (!inside) continue;
+			const float z = zRow + t.dzdx * (px - t.x0);
+			if (!(z < depthRow[x])) continue;
+			depthRow[x] = z;
+			covered[n++] = static_cast<uint16_t>(x);
+		}
+		return n;
+	}
+
+	// Junta acumuladores de puntos xyz entrelazados: el carril k es la componente k % 3
+	void reduceInterleaved(const float* mins, const float* maxs, int lanes, float mn[3], float mx[3])
+	{
+		for (int k = 0; k < lanes; k++) {
+			if (mins[k] < mn[k % 3]) mn[k % 3] = mins[k];
+			if (maxs[k] > mx[k % 3]) mx[k % 3] = maxs[k];
+		}
+	}
+
+#if OYUKI_SIMD_X86
+
+	// ---- SSE4.1: 4 carriles ----
+
+	TARGET_SSE41 void multiplySse(const float* a, const float* b, float* out, size_t count)
+	{
+		for (size_t i = 0; i < count; i++, a += 16, b += 16, out += 16) {
+			const __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+			for (int c = 0; c < 4; c++) {
+				const float* bc = b + c * 4;
+				__m128 r = _mm_mul_ps(a0, _mm_set1_ps(bc[0]));
+				r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(bc[1])));
+				r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+				r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(bc[3])));
+				_mm_storeu_ps(out + c * 4, r);
+			}
+		}
+	}
+
+	TARGET_SSE41 void transformSse(const float* models, const void* localMin, const void* localMax, void* worldMin, void* worldMax,
+		size_t count, size_t stride)
+	{
+		// Una caja por iteracion con una columna de la matriz por registro (el 4o carril sobra)
+		for (size_t i = 0; i < count; i++) {
+			const float* m = models + i * 16;
+			const float* lo = floatAt(localMin, i, stride);
+			const float* hi = floatAt(localMax, i, stride);
+			__m128 mn = _mm_loadu_ps(m + 12);
+			__m128 mx = mn;
+			for (int c = 0; c < 3; c++) {
+				const __m128 col = _mm_loadu_ps(m + c * 4);
+				const __m128 a = _mm_mul_ps(col, _mm_set1_ps(lo[c]));
+				const __m128 b = _mm_mul_ps(col, _mm_set1_ps(hi[c]));
+				mn = _mm_add_ps(mn, _mm_min_ps(a, b));
+				mx = _mm_add_ps(mx, _mm_max_ps(a, b));
+			}
+			float outMin[4], outMax[4];
+			_mm_storeu_ps(outMin, mn);
+			_mm_storeu_ps(outMax, mx);
+			memcpy(floatAt(worldMin, i, stride), outMin, 3 * sizeof(float));
+			memcpy(floatAt(worldMax, i, stride), outMax, 3 * sizeof(float));
+		}
+	}
+
+	TARGET_SSE41 void cullSse(const Frustum& frustum, const SimdMath::AabbSoA& b, size_t count, unsigned char* visible)
+	{
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (const auto& p : frustum.planes) {
+				const __m128 x = _mm_loadu_ps((p.x >= 0.0f ? b.maxX : b.minX) + i);
+				const __m128 y = _mm_loadu_ps((p.y >= 0.0f ? b.maxY : b.minY) + i);
+				const __m128 z = _mm_loadu_ps((p.z >= 0.0f ? b.maxZ : b.minZ) + i);
+				__m128 d = _mm_mul_ps(_mm_set1_ps(p.x), x);
+				d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(p.y), y));
+				d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(p.z), z));
+				d = _mm_add_ps(d, _mm_set1_ps(p.w));
+				inside = _mm_and_ps(inside, _mm_cmpnlt_ps(d, _mm_setzero_ps()));
+			}
+			const int mask = _mm_movemask_ps(inside);
+			for (int k = 0; k < 4; k++) visible[i + k] = (mask >> k) & 1;
+		}
+		cullScalar(frustum, b, i, count, visible);
+	}
+
+	// Las 4 cajas de un nodo a la vez: 3 ejes x (2 restas + 2 productos) y la reduccion
+	TARGET_SSE41 int rayAabb4Sse(const float origin[3], const float invDir[3], const float* boxes, float maxT, float tNear[4])
+	{
+		__m128 enter = _mm_setzero_ps();
+		__m128 exit = _mm_set1_ps(maxT);
+		for (int c = 0; c < 3; c++) {
+			const __m128 o = _mm_set1_ps(origin[c]);
+			const __m128 inv = _mm_set1_ps(invDir[c]);
+			const __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(boxes + c * 4), o), inv);
+			const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(boxes + 12 + c * 4), o), inv);
+			enter = _mm_max_ps(enter, _mm_min_ps(t0, t1));
+			exit = _mm_min_ps(exit, _mm_max_ps(t0, t1));
+		}
+		_mm_storeu_ps(tNear, enter);
+		return _mm_movemask_ps(_mm_cmple_ps(enter, exit));
+	}
+
+	TARGET_SSE41 void scaleToDoubleSse(const float* src, size_t count, float scale, double* dst)
+	{
+		const __m128 s = _mm_set1_ps(scale);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const __m128 v = _mm_mul_ps(_mm_loadu_ps(src + i), s);
+			_mm_storeu_pd(dst + i, _mm_cvtps_pd(v));
+			_mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+		}
+		scaleToDoubleScalar(src, i, count, scale, dst);
+	}
+
+	TARGET_SSE41 void scaleFloatsSse(const float* src, size_t count, float scale, float* dst)
+	{
+		const __m128 s = _mm_set1_ps(scale);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), s));
+		scaleFloatsScalar(src, i, count, scale, dst);
+	}
+
+	TARGET_SSE41 void boundsSse(const float* xyz, size_t points, float mn[3], float mx[3])
+	{
+		// 4 puntos = 12 floats = 3 registros; cada carril siempre ve la misma componente
+		const __m128 inf = _mm_set1_ps(numeric_limits<float>::infinity());
+		const __m128 ninf = _mm_set1_ps(-numeric_limits<float>::infinity());
+		__m128 mn0 = inf, mn1 = inf, mn2 = inf, mx0 = ninf, mx1 = ninf, mx2 = ninf;
+		size_t i = 0;
+		for (; i + 4 <= points; i += 4) {
+			const float* p = xyz + i * 3;
+			const __m128 v0 = _mm_loadu_ps(p), v1 = _mm_loadu_ps(p + 4), v2 = _mm_loadu_ps(p + 8);
+			mn0 = _mm_min_ps(mn0, v0); mn1 = _mm_min_ps(mn1, v1); mn2 = _mm_min_ps(mn2, v2);
+			mx0 = _mm_max_ps(mx0, v0); mx1 = _mm_max_ps(mx1, v1); mx2 = _mm_max_ps(mx2, v2);
+		}
+		float mins[12], maxs[12];
+		_mm_storeu_ps(mins, mn0); _mm_storeu_ps(mins + 4, mn1); _mm_storeu_ps(mins + 8, mn2);
+		_mm_storeu_ps(maxs, mx0); _mm_storeu_ps(maxs + 4, mx1); _mm_storeu_ps(maxs + 8, mx2);
+		reduceInterleaved(mins, maxs, 12, mn, mx);
+		boundsScalar(xyz, i, points, mn, mx);
+	}
+
+	TARGET_SSE41 __m128i snorm10Sse(__m128 v, __m128i shift)
+	{
+		v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+		const __m128i q = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(511.0f))), _mm_set1_epi32(0x3FF));
+		return _mm_mullo_epi32(q, shift); // sin desplazamiento variable en SSE: multiplica por 2^n
+	}
+
+	TARGET_SSE41 void packNormalsSse(const float* xyz, size_t count, uint32_t* dst)
+	{
+		// 4 normales = 12 floats = 3 registros con el patron de componentes x y z x | y z x y | z x y z
+		const __m128i s0 = _mm_setr_epi32(1, 1 << 10, 1 << 20, 1);
+		const __m128i s1 = _mm_setr_epi32(1 << 10, 1 << 20, 1, 1 << 10);
+		const __m128i s2 = _mm_setr_epi32(1 << 20, 1, 1 << 10, 1 << 20);
+		alignas(16) uint32_t fields[12];
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const float* p = xyz + i * 3;
+			_mm_store_si128(reinterpret_cast<__m128i*>(fields), snorm10Sse(_mm_loadu_ps(p), s0));
+			_mm_store_si128(reinterpret_cast<__m128i*>(fields + 4), snorm10Sse(_mm_loadu_ps(p + 4), s1));
+			_mm_store_si128(reinterpret_cast<__m128i*>(fields + 8), snorm10Sse(_mm_loadu_ps(p + 8), s2));
+			orTriples(fields, 4, dst + i);
+		}
+		packNormalsScalar(xyz, i, count, dst);
+	}
+
+	// 4 pixeles por iteracion: las tres aristas, la mascara de cobertura y la profundidad
+	TARGET_SSE41 int rasterSpanSse(const SimdMath::RasterEdges& t, int y, int begin, int end, float* depthRow, uint16_t* covered)
+	{
+		const float py = y + 0.5f;
+		__m128 a[3], row[3], topLeft[3];
+		for (int k = 0; k < 3; k++) {
+			a[k] = _mm_set1_ps(t.a[k]);
+			row[k] = _mm_set1_ps(t.b[k] * py + t.c[k]);
+			topLeft[k] = _mm_castsi128_ps(_mm_set1_epi32(t.topLeft[k] ? -1 : 0));
+		}
+		const __m128 zRow = _mm_set1_ps(t.z0 + t.dzdy * (py - t.y0));
+		const __m128 dzdx = _mm_set1_ps(t.dzdx);
+		const __m128 x0 = _mm_set1_ps(t.x0);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 centers = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		alignas(16) float z[4];
+		int n = 0;
+		for (int x = begin & ~3; x < end; x += 4) {
+			const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), centers);
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int k = 0; k < 3; k++) {
+				const __m128 e = _mm_add_ps(_mm_mul_ps(a[k], px), row[k]);
+				inside = _mm_and_ps(inside, _mm_or_ps(_mm_cmpgt_ps(e, zero), _mm_and_ps(_mm_cmpeq_ps(e, zero), topLeft[k])));
+			}
+			int mask = _mm_movemask_ps(inside) & spanLanes(x, begin, end, 4);
+			if (!mask) continue;
+			const __m128 depth = _mm_add_ps(zRow, _mm_mul_ps(dzdx, _mm_sub_ps(px, x0)));
+			mask &= _mm_movemask_ps(_mm_cmplt_ps(depth, _mm_loadu_ps(depthRow + x)));
+			_mm_store_ps(z, depth);
+			n = storeCovered(x, mask, z, depthRow, covered, n);
+		}
+		return n;
+	}
+
+	// ---- AVX2 + FMA: 8 carriles ----
+
+	TARGET_AVX2 void multiplyAvx2(const float* a, const float* b, float* out, size_t count)
+	{
+		// Dos columnas del resultado por registro
+		for (size_t i = 0; i < count; i++, a += 16, b += 16, out += 16) {
+			const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a));
+			const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+			const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+			const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+			for (int c = 0; c < 4; c += 2) {
+				const __m256 bc = _mm256_loadu_ps(b + c * 4);
+				__m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(bc, 0x00));
+				r = _mm256_fmadd_ps(a1, _mm256_permute_ps(bc, 0x55), r);
+				r = _mm256_fmadd_ps(a2, _mm256_permute_ps(bc, 0xAA), r);
+				r = _mm256_fmadd_ps(a3, _mm256_permute_ps(bc, 0xFF), r);
+				_mm256_storeu_ps(out + c * 4, r);
+			}
+		}
+	}
+
+	TARGET_AVX2 void transformAvx2(const float* models, const void* localMin, const void* localMax, void* worldMin, void* worldMax,
+		size_t count, size_t stride)
+	{
+		// Dos cajas por iteracion, una en cada mitad del registro
+		size_t i = 0;
+		for (; i + 2 <= count; i += 2) {
+			const float* m0 = models + i * 16;
+			const float* m1 = m0 + 16;
+			const float* lo0 = floatAt(localMin, i, stride);
+			const float* lo1 = floatAt(localMin, i + 1, stride);
+			const float* hi0 = floatAt(localMax, i, stride);
+			const float* hi1 = floatAt(localMax, i + 1, stride);
+			__m256 mn = _mm256_loadu2_m128(m1 + 12, m0 + 12);
+			__m256 mx = mn;
+			for (int c = 0; c < 3; c++) {
+				const __m256 col = _mm256_loadu2_m128(m1 + c * 4, m0 + c * 4);
+				const __m256 a = _mm256_mul_ps(col, _mm256_setr_ps(lo0[c], lo0[c], lo0[c], lo0[c], lo1[c], lo1[c], lo1[c], lo1[c]));
+				const __m256 b = _mm256_mul_ps(col, _mm256_setr_ps(hi0[c], hi0[c], hi0[c], hi0[c], hi1[c], hi1[c], hi1[c], hi1[c]));
+				mn = _mm256_add_ps(mn, _mm256_min_ps(a, b));
+				mx = _mm256_add_ps(mx, _mm256_max_ps(a, b));
+			}
+			float outMin[8], outMax[8];
+			_mm256_storeu_ps(outMin, mn);
+			_mm256_storeu_ps(outMax, mx);
+			memcpy(floatAt(worldMin, i, stride), outMin, 3 * sizeof(float));
+			memcpy(floatAt(worldMax, i, stride), outMax, 3 * sizeof(float));
+			memcpy(floatAt(worldMin, i + 1, stride), outMin + 4, 3 * sizeof(float));
+			memcpy(floatAt(worldMax, i + 1, stride), outMax + 4, 3 * sizeof(float));
+		}
+		transformScalar(models, localMin, localMax, worldMin, worldMax, i, count, stride);
+	}
+
+	// Sin FMA a proposito, tampoco en el target: mismo redondeo que isVisible, y
+	// una caja que roza un plano da lo mismo que en escalar y SSE
+	TARGET_AVX2_NO_FMA void cullAvx2(const Frustum& frustum, const SimdMath::AabbSoA& b, size_t count, unsigned char* visible)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (const auto& p : frustum.planes) {
+				const __m256 x = _mm256_loadu_ps((p.x >= 0.0f ? b.maxX : b.minX) + i);
+				const __m256 y = _mm256_loadu_ps((p.y >= 0.0f ? b.maxY : b.minY) + i);
+				const __m256 z = _mm256_loadu_ps((p.z >= 0.0f ? b.maxZ : b.minZ) + i);
+				__m256 d = _mm256_mul_ps(_mm256_set1_ps(p.x), x);
+				d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(p.y), y));
+				d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(p.z), z));
+				d = _mm256_add_ps(d, _mm256_set1_ps(p.w));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_NLT_UQ));
+			}
+			const int mask = _mm256_movemask_ps(inside);
+			for (int k = 0; k < 8; k++) visible[i + k] = (mask >> k) & 1;
+		}
+		cullScalar(frustum, b, i, count, visible);
+	}
+
+	TARGET_AVX2 void scaleToDoubleAvx2(const float* src, size_t count, float scale, double* dst)
+	{
+		const __m256 s = _mm256_set1_ps(scale);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const __m256 v = _mm256_mul_ps(_mm256_loadu_ps(src + i), s);
+			_mm256_storeu_pd(dst + i, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+			_mm256_storeu_pd(dst + i + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+		}
+		scaleToDoubleScalar(src, i, count, scale, dst);
+	}
+
+	TARGET_AVX2 void scaleFloatsAvx2(const float* src, size_t count, float scale, float* dst)
+	{
+		const __m256 s = _mm256_set1_ps(scale);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), s));
+		scaleFloatsScalar(src, i, count, scale, dst);
+	}
+
+	TARGET_AVX2 void boundsAvx2(const float* xyz, size_t points, float mn[3], float mx[3])
+	{
+		// 8 puntos = 24 floats = 3 registros
+		const __m256 inf = _mm256_set1_ps(numeric_limits<float>::infinity());
+		const __m256 ninf = _mm256_set1_ps(-numeric_limits<float>::infinity());
+		__m256 mn0 = inf, mn1 = inf, mn2 = inf, mx0 = ninf, mx1 = ninf, mx2 = ninf;
+		size_t i = 0;
+		for (; i + 8 <= points; i += 8) {
+			const float* p = xyz + i * 3;
+			const __m256 v0 = _mm256_loadu_ps(p), v1 = _mm256_loadu_ps(p + 8), v2 = _mm256_loadu_ps(p + 16);
+			mn0 = _mm256_min_ps(mn0, v0); mn1 = _mm256_min_ps(mn1, v1); mn2 = _mm256_min_ps(mn2, v2);
+			mx0 = _mm256_max_ps(mx0, v0); mx1 = _mm256_max_ps(mx1, v1); mx2 = _mm256_max_ps(mx2, v2);
+		}
+		float mins[24], maxs[24];
+		_mm256_storeu_ps(mins, mn0); _mm256_storeu_ps(mins + 8, mn1); _mm256_storeu_ps(mins + 16, mn2);
+		_mm256_storeu_ps(maxs, mx0); _mm256_storeu_ps(maxs + 8, mx1); _mm256_storeu_ps(maxs + 16, mx2);
+		reduceInterleaved(mins, maxs, 24, mn, mx);
+		boundsScalar(xyz, i, points, mn, mx);
+	}
+
+	TARGET_AVX2 __m256i snorm10Avx2(__m256 v, __m256i shift)
+	{
+		v = _mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(-1.0f)), _mm256_set1_ps(1.0f));
+		const __m256i q = _mm256_and_si256(_mm256_cvtps_epi32(_mm256_mul_ps(v, _mm256_set1_ps(511.0f))), _mm256_set1_epi32(0x3FF));
+		return _mm256_sllv_epi32(q, shift);
+	}
+
+	TARGET_AVX2 void packNormalsAvx2(const float* xyz, size_t count, uint32_t* dst)
+	{
+		// 8 normales = 24 floats = 3 registros; el desplazamiento de cada carril es 10 * (k % 3)
+		const __m256i s0 = _mm256_setr_epi32(0, 10, 20, 0, 10, 20, 0, 10);
+		const __m256i s1 = _mm256_setr_epi32(20, 0, 10, 20, 0, 10, 20, 0);
+		const __m256i s2 = _mm256_setr_epi32(10, 20, 0, 10, 20, 0, 10, 20);
+		alignas(32) uint32_t fields[24];
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const float* p = xyz + i * 3;
+			_mm256_store_si256(reinterpret_cast<__m256i*>(fields), snorm10Avx2(_mm256_loadu_ps(p), s0));
+			_mm256_store_si256(reinterpret_cast<__m256i*>(fields + 8), snorm10Avx2(_mm256_loadu_ps(p + 8), s1));
+			_mm256_store_si256(reinterpret_cast<__m256i*>(fields + 16), snorm10Avx2(_mm256_loadu_ps(p + 16), s2));
+			orTriples(fields, 8, dst + i);
+		}
+		packNormalsScalar(xyz, i, count, dst);
+	}
+
+	TARGET_AVX2 void packTexCoordsAvx2(const float* xyz, size_t count, uint32_t* dst)
+	{
+		// 4 UV por iteracion: cada x, y se lee como 64 bits y F16C convierte los 8 floats de golpe
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const double* p = reinterpret_cast<const double*>(xyz + i * 3);
+			const double* q = reinterpret_cast<const double*>(xyz + i * 3 + 6);
+			const __m128 lo = _mm_castpd_ps(_mm_loadh_pd(_mm_load_sd(p), reinterpret_cast<const double*>(xyz + i * 3 + 3)));
+			const __m128 hi = _mm_castpd_ps(_mm_loadh_pd(_mm_load_sd(q), reinterpret_cast<const double*>(xyz + i * 3 + 9)));
+			const __m256 uv = _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_cvtps_ph(uv, _MM_FROUND_TO_NEAREST_INT));
+		}
+		packTexCoordsScalar(xyz, i, count, dst);
+	}
+
+	// Como rasterSpanSse con 8 pixeles. Multiplicacion y suma por separado: con FMA
+	// el redondeo cambiaria y algun pixel del borde no coincidiria con el escalar
+	TARGET_AVX2_NO_FMA int rasterSpanAvx2(const SimdMath::RasterEdges& t, int y, int begin, int end, float* depthRow, uint16_t* covered)
+	{
+		const float py = y + 0.5f;
+		__m256 a[3], row[3], topLeft[3];
+		for (int k = 0; k < 3; k++) {
+			a[k] = _mm256_set1_ps(t.a[k]);
+			row[k] = _mm256_set1_ps(t.b[k] * py + t.c[k]);
+			topLeft[k] = _mm256_castsi256_ps(_mm256_set1_epi32(t.topLeft[k] ? -1 : 0));
+		}
+		const __m256 zRow = _mm256_set1_ps(t.z0 + t.dzdy * (py - t.y0));
+		const __m256 dzdx = _mm256_set1_ps(t.dzdx);
+		const __m256 x0 = _mm256_set1_ps(t.x0);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 centers = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+		alignas(32) float z[8];
+		int n = 0;
+		for (int x = begin & ~7; x < end; x += 8) {
+			const __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), centers);
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (int k = 0; k < 3; k++) {
+				const __m256 e = _mm256_add_ps(_mm256_mul_ps(a[k], px), row[k]);
+				const __m256 onEdge = _mm256_and_ps(_mm256_cmp_ps(e, zero, _CMP_EQ_OQ), topLeft[k]);
+				inside = _mm256_and_ps(inside, _mm256_or_ps(_mm256_cmp_ps(e, zero, _CMP_GT_OQ), onEdge));
+			}
+			int mask = _mm256_movemask_ps(inside) & spanLanes(x, begin, end, 8);
+			if (!mask) continue;
+			const __m256 depth = _mm256_add_ps(zRow, _mm256_mul_ps(dzdx, _mm256_sub_ps(px, x0)));
+			mask &= _mm256_movemask_ps(_mm256_cmp_ps(depth, _mm256_loadu_ps(depthRow + x), _CMP_LT_OQ));
+			_mm256_store_ps(z, depth);
+			n = storeCovered(x, mask, z, depthRow, covered, n);
+		}
+		return n;
+	}
+
+#endif
+}
+
+SimdLevel SimdMath::detect()
+{
+	return supported;
+}
+
+SimdLevel SimdMath::level()
+{
+	return current;
+}
+
+void SimdMath::setLevel(SimdLevel level)
+{
+	current = static_cast<int>(level) <= static_cast<int>(supported) ? level : supported;
+}
+
+const char* SimdMath::levelName(SimdLevel level)
+{
+	switch (level) {
+	case SimdLevel::AVX2: return "AVX2";
+	case SimdLevel::SSE41: return "SSE4.1";
+	default: return "Escalar";
+	}
+}
+
+void SimdMath::multiplyMat4(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count)
+{
+	const float* fa = reinterpret_cast<const float*>(a);
+	const float* fb = reinterpret_cast<const float*>(b);
+	float* fo = reinterpret_cast<float*>(out);
+#if OYUKI_SIMD_X86
+	if (current == SimdLevel::AVX2) return multiplyAvx2(fa, fb, fo, count);
+	if (current == SimdLevel::SSE41) return multiplySse(fa, fb, fo, count);
+#endif
+	multiplyScalar(fa, fb, fo, count);
+}
+
+void SimdMath::transformAabbs(const glm::mat4* models, const glm::vec3* localMin, const glm::vec3* localMax,
+	glm::vec3* worldMin, glm::vec3* worldMax, size_t count, size_t stride)
+{
+	const float* m = reinterpret_cast<const float*>(models);
+#if OYUKI_SIMD_X86
+	if (current == SimdLevel::AVX2) return transformAvx2(m, localMin, localMax, worldMin, worldMax, count, stride);
+	if (current == SimdLevel::SSE41) return transformSse(m, localMin, localMax, worldMin, worldMax, count, stride);
+#endif
+	transformScalar(m, localMin, localMax, worldMin, worldMax, 0, count, stride);
+}
+
+void SimdMath::cullAabbs(const Frustum& frustum, const AabbSoA& boxes, size_t count, unsigned char* visible)
+{
+#if OYUKI_SIMD_X86
+	if (current == SimdLevel::AVX2) return cullAvx2(frustum, boxes, count, visible);
+	if (current == SimdLevel::SSE41) return cullSse(frustum, boxes, count, visible);
+#endif
+	cullScalar(frustum, boxes, 0, count, visible);
+}
+
+int SimdMath::rayAabb4(const float origin[3], const float invDir[3], const float* boxes, float maxT, float tNear[4])
+{
+#if OYUKI_SIMD_X86
+	// Son 4 carriles: AVX2 usa la misma version que SSE
+	if (current != SimdLevel::Scalar) return rayAabb4Sse(origin, invDir, boxes, maxT, tNear);
+#endif
+	return rayAabb4Scalar(origin, invDir, boxes, maxT, tNear);
+}
+
+void SimdMath::scaleToDouble(const float* src, size_t count, float scale, double* dst)
+{
+#if OYUKI_SIMD_X86
+	if (current == SimdLevel::AVX2) return scaleToDoubleAvx2(src, count, scale, dst);
+	if (current == SimdLevel::SSE41) return scaleToDoubleSse(src, count, scale, dst);
+#endif
+	scaleToDoubleScalar(src, 0, count, scale, dst);
+}
+
+void SimdMath::scaleFloats(const float* src, size_t count, float scale, float* dst)
+{
+#if OYUKI_SIMD_X86
+	if (current == SimdLevel::AVX2) return scaleFloatsAvx2(src, count, scale, dst);
+	if (current == SimdLevel::SSE41) return scaleFloatsSse(src, count, scale, dst);
+#endif
+	scaleFloatsScalar(src, 0, count, scale, dst);
+}
+
+void SimdMath::pointBounds(const float* xyz, size_t points, glm::vec3& outMin, glm::vec3& outMax)
+{
+	if (points == 0) {
+		outMin = outMax = glm::vec3(0.0f);
+		return;
+	}
+	float mn[3] = { xyz[0], xyz[1], xyz[2] };
+	float mx[3] = { xyz[0], xyz[1], xyz[2] };
+#if OYUKI_SIMD_X86
+	if (current == SimdLevel::AVX2) boundsAvx2(xyz, points, mn, mx);
+	else if (current == SimdLevel::SSE41) boundsSse(xyz, points, mn, mx);
+	else boundsScalar(xyz, 0, points, mn, mx);
+#else
+	boundsScalar(xyz, 0, points, mn, mx);
+#endif
+	outMin = glm::vec3(mn[0], mn[1], mn[2]);
+	outMax = glm::vec3(mx[0], mx[1], mx[2]);
+}
+
+void SimdMath::packNormals(const float* xyz, size_t count, uint32_t* dst)
+{
+#if OYUKI_SIMD_X86
+	if (current == SimdLevel::AVX2) return packNormalsAvx2(xyz, count, dst);
+	if (current == SimdLevel::SSE41) return packNormalsSse(xyz, count, dst);
+#endif
+	packNormalsScalar(xyz, 0, count, dst);
+}
+
+void SimdMath::packTexCoords(const float* xyz, size_t count, uint32_t* dst)
+{
+#if OYUKI_SIMD_X86
+	if (current == SimdLevel::AVX2) return packTexCoordsAvx2(xyz, count, dst);
+#endif
+	packTexCoordsScalar(xyz, 0, count, dst);
+}
+
+uint16_t SimdMath::floatToHalf(float value)
+{
+	// Redondeo al par como vcvtps2ph; los subnormales se redondean sumando un numero magico
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	const uint32_t sign = bits & 0x80000000u;
+	bits ^= sign;
+
+	uint32_t half;
+	if (bits >= 0x47800000u) { // >= 65536: infinito, o NaN silencioso
+		half = bits > 0x7F800000u ? 0x7E00u : 0x7C00u;
+	}
+	else if (bits < 0x38800000u) { // por debajo de 2^-14: subnormal o cero
+		const uint32_t magicBits = 126u << 23; // 0.5f
+		float magic, f;
+		memcpy(&magic, &magicBits, sizeof(magic));
+		memcpy(&f, &bits, sizeof(f));
+		f += magic;
+		memcpy(&half, &f, sizeof(half));
+		half -= magicBits;
+	}
+	else {
+		const uint32_t odd = (bits >> 13) & 1;
+		bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xFFFu + odd;
+		half = bits >> 13;
+	}
+	return static_cast<uint16_t>(half | sign >> 16);
+}
+
+float SimdMath::halfToFloat(uint16_t value)
+{
+	const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+	const uint32_t exponent = (value >> 10) & 0x1Fu;
+	const uint32_t mantissa = value & 0x3FFu;
+	uint32_t bits;
+	if (exponent == 0x1Fu) { // infinito o NaN
+		bits = sign | 0x7F800000u | mantissa << 13;
+	}
+	else if (exponent == 0) { // subnormal o cero: mantisa * 2^-24, exacto en float
+		const float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+		memcpy(&bits, &magnitude, sizeof(bits));
+		bits |= sign;
+	}
+	else {
+		bits = sign | (exponent + (127 - 15)) << 23 | mantissa << 13;
+	}
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+int SimdMath::rasterSpan(const RasterEdges& t, int y, int begin, int end, float* depthRow, uint16_t* covered)
+{
+#if OYUKI_SIMD_X86
+	if (current == SimdLevel::AVX2) return rasterSpanAvx2(t, y, begin, end, depthRow, covered);
+	if (current == SimdLevel::SSE41) return rasterSpanSse(t, y, begin, end, depthRow, covered);
+#endif
+	return rasterSpanScalar(t, y, begin, end, depthRow, covered);
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "Culling.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Kernels de matematicas por lotes con SIMD.
+// Al arrancar se elige la mejor version que soporta la CPU (AVX2+FMA+F16C, SSE4.1
+// o escalar); setLevel permite forzar una inferior para comparar resultados.
+// Todas dan el mismo resultado que su equivalente de glm/Culling salvo el
+// redondeo de FMA en multiplyMat4.
+enum class SimdLevel { Scalar, SSE41, AVX2 };
+
+namespace SimdMath
+{
+	SimdLevel detect(); // lo que soporta esta CPU
+	SimdLevel level();
+	void setLevel(SimdLevel level); // se limita a detect()
+	const char* levelName(SimdLevel level);
+
+	// out[i] = a[i] * b[i]
+	void multiplyMat4(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count);
+
+	// AABB locales transformadas por models[i] (como transformBounds).
+	// Entre una caja y la siguiente hay 'stride' bytes, asi se pueden leer y
+	// escribir directamente en un array de structs.
+	void transformAabbs(const glm::mat4* models, const glm::vec3* localMin, const glm::vec3* localMax,
+		glm::vec3* worldMin, glm::vec3* worldMax, size_t count, size_t stride = sizeof(glm::vec3));
+
+	// Cajas en SoA para probarlas de 8 en 8 (4 con SSE)
+	struct AabbSoA
+	{
+		const float* minX;
+		const float* minY;
+		const float* minZ;
+		const float* maxX;
+		const float* maxY;
+		const float* maxZ;
+	};
+	// visible[i] = 1 si la caja i toca el frustum (como isVisible)
+	void cullAabbs(const Frustum& frustum, const AabbSoA& boxes, size_t count, unsigned char* visible);
+
+	// Rayo contra 4 cajas seguidas en SoA: minX[4], minY[4], minZ[4], maxX[4], maxY[4], maxZ[4].
+	// invDir = 1 / direccion, sin componentes a 0. Devuelve la mascara de las cajas que
+	// corta entre 0 y maxT, con la distancia de entrada de cada una en tNear
+	int rayAabb4(const float origin[3], const float invDir[3], const float* boxes, float maxT, float tNear[4]);
+
+	// Flujos de 'count' floats (x, y, z, x, y, z...) multiplicados por scale
+	void scaleToDouble(const float* src, size_t count, float scale, double* dst);
+	void scaleFloats(const float* src, size_t count, float scale, float* dst);
+
+	// AABB de 'points' puntos xyz seguidos
+	void pointBounds(const float* xyz, size_t points, glm::vec3& outMin, glm::vec3& outMax);
+
+	// Cuantizacion de vertices (redondeo al par, igual en todos los niveles).
+	// Normales xyz -> snorm 10:10:10:2 (GL_INT_2_10_10_10_REV, w = 0)
+	void packNormals(const float* xyz, size_t count, uint32_t* dst);
+	// x, y de cada xyz -> dos half float (GL_HALF_FLOAT); sin F16C se hace en escalar
+	void packTexCoords(const float* xyz, size_t count, uint32_t* dst);
+	uint16_t floatToHalf(float value);
+	float halfToFloat(uint16_t value); // exacta
+
+	// Triangulo listo para rasterizar (lo prepara SoftwareRenderer). Aristas
+	// E = a * x + b * y + c, positivas dentro; con E == 0 el pixel solo es del
+	// triangulo si la arista es superior o izquierda (topLeft), asi dos triangulos
+	// que comparten arista no pintan el mismo pixel ni dejan huecos entre ellos.
+	// Profundidad: z = z0 + dzdx * (x - x0) + dzdy * (y - y0)
+	struct RasterEdges
+	{
+		float a[3];
+		float b[3];
+		float c[3];
+		bool topLeft[3];
+		float x0, y0, z0, dzdx, dzdy;
+	};
+	// Pixeles [begin, end) de la fila y, muestreados en su centro (+0.5). Los que
+	// estan dentro y pasan la prueba de profundidad (z < depthRow[x]) escriben su z
+	// y dejan su x en 'covered', de menor a mayor; devuelve cuantos son.
+	// Se leen bloques alineados de 8: depthRow tiene que poder leerse desde
+	// begin & ~7 hasta end redondeado a 8. Solo se escribe en [begin, end).
+	int rasterSpan(const RasterEdges& t, int y, int begin, int end, float* depthRow, uint16_t* covered);
+}
@@ -0,0 +1,58 @@
+#include "Simulation.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+bool sameState(const SimState& a, const SimState& b)
+{
+	return a.rotationX == b.rotationX && a.rotationY == b.rotationY && a.zoomLevel == b.zoomLevel &&
+		a.cameraOffsetX == b.cameraOffsetX && a.cameraOffsetY == b.cameraOffsetY;
+}
+
+bool hasInput(const PendingInput& input)
+{
+	return input.rotateX != 0.0f || input.rotateY != 0.0f || input.panX != 0.0f || input.panY != 0.0f || input.zoom != 0.0f;
+}
+
+// a + (b - a) * t da exactamente a si no se ha movido (glm::mix puede variar
+// en el ultimo bit con t), asi la camara no se ensucia estando quieta
+static float lerpExact(float a, float b, float t)
+{
+	return a + (b - a) * t;
+}
+
+SimState lerpState(const SimState& a, const SimState& b, float t)
+{
+	SimState s;
+	s.rotationX = lerpExact(a.rotationX, b.rotationX, t);
+	s.rotationY = lerpExact(a.rotationY, b.rotationY, t);
+	s.zoomLevel = lerpExact(a.zoomLevel, b.zoomLevel, t);
+	s.cameraOffsetX = lerpExact(a.cameraOffsetX, b.cameraOffsetX, t);
+	s.cameraOffsetY = lerpExact(a.cameraOffsetY, b.cameraOffsetY, t);
+	return s;
+}
+
+SimState applyInput(const SimState& state, const PendingInput& input)
+{
+	SimState s = state;
+	s.rotationX += input.rotateX;
+	s.rotationY += input.rotateY;
+	s.cameraOffsetX += input.panX;
+	s.cameraOffsetY += input.panY;
+	// Limitar el zoom para evitar que se acerque o aleje demasiado
+	s.zoomLevel = glm::clamp(s.zoomLevel + input.zoom, -20.0f, -1.0f);
+	return s;
+}
+
+void update_simulation(SimState& state, PendingInput& input) // Un paso fijo de SIM_DT
+{
+	state = applyInput(state, input);
+	input = PendingInput();
+}
+
+glm::mat4 computeViewMatrix(const SimState& state)
+{
+	// Actualizar la matriz de vista: zoom (eje Z) y desplazamiento en el eje Y (para mover la cmara arriba/abajo)
+	glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(state.cameraOffsetX * 0.4f, -state.cameraOffsetY * 0.4f, state.zoomLevel));
+	view = glm::rotate(view, glm::radians(state.rotationX), glm::vec3(1.0f, 0.0f, 0.0f));
+	view = glm::rotate(view, glm::radians(state.rotationY), glm::vec3(0.0f, 1.0f, 0.0));
+	return view;
+}
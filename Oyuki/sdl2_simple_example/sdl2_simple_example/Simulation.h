@@ -0,0 +1,31 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// Estado de la simulacion: solo se modifica en update_simulation a paso fijo
+struct SimState
+{
+	float rotationX = 0.0f;  // Rotacin alrededor del eje X
+	float rotationY = 0.0f;  // Rotacin alrededor del eje Y
+	float zoomLevel = -5.0f;
+	float cameraOffsetX = 0.0f;
+	float cameraOffsetY = 0.0f;
+};
+
+// Input acumulado entre pasos de simulacion (lo rellena processEvents)
+struct PendingInput
+{
+	float rotateX = 0.0f;
+	float rotateY = 0.0f;
+	float panX = 0.0f;
+	float panY = 0.0f;
+	float zoom = 0.0f;
+};
+
+bool sameState(const SimState& a, const SimState& b);
+bool hasInput(const PendingInput& input);
+SimState lerpState(const SimState& a, const SimState& b, float t);
+// Estado con el input aplicado (lo que hara el siguiente paso de simulacion)
+SimState applyInput(const SimState& state, const PendingInput& input);
+void update_simulation(SimState& state, PendingInput& input); // Un paso fijo de simulacion
+// Matriz de vista de la camara orbital a partir del estado
+glm::mat4 computeViewMatrix(const SimState& state);
@@ -0,0 +1,365 @@
+#include "SoftwareRenderer.h"
+#include "Camera.h"
+#include "JobSystem.h"
+#include "Mesh.h"
+#include "Profiler.h"
+#include "Resources.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdio.h>
+using namespace std;
+
+namespace
+{
+	// Triangulos por tanda: cada tanda se rasteriza antes de preparar la siguiente,
+	// asi lo preparado no crece con el tamano de la malla
+	const size_t BATCH_TRIANGLES = 1 << 17;
+	// Bloques de la preparacion: como mucho MAX_CHUNKS por tanda y de al menos
+	// MIN_CHUNK_TRIANGLES. Dependen solo del numero de triangulos, no de los hilos
+	const size_t MAX_CHUNKS = 64;
+	const size_t MIN_CHUNK_TRIANGLES = 2048;
+	const size_t VERTEX_GRAIN = 16384;
+
+	uint32_t packColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a)
+	{
+		const unsigned char bytes[4] = { r, g, b, a };
+		uint32_t color;
+		memcpy(&color, bytes, sizeof(color));
+		return color;
+	}
+
+	const uint32_t CLEAR_COLOR = packColor(51, 51, 51, 255); // glClearColor(0.2, 0.2, 0.2, 1)
+	const uint32_t WHITE = 0xFFFFFFFFu;
+
+	const int OUTSIDE_NEAR = 1 << 5;
+
+	// Un bit por plano del frustum del que el vertice queda fuera
+	int outcode(const glm::vec4& p)
+	{
+		return (p.x < -p.w) | (p.x > p.w) << 1 | (p.y < -p.w) << 2 | (p.y > p.w) << 3 | (p.z > p.w) << 4
+			| (p.z < -p.w ? OUTSIDE_NEAR : 0);
+	}
+}
+
+SoftwareRenderer::SoftwareRenderer(int width, int height)
+{
+	resize(width, height);
+}
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+	releaseSurface();
+}
+
+void SoftwareRenderer::releaseSurface()
+{
+	if (_surface) SDL_FreeSurface(_surface);
+	_surface = nullptr;
+}
+
+void SoftwareRenderer::resize(int width, int height)
+{
+	width = max(width, 1);
+	height = max(height, 1);
+	if (width == _width && height == _height) return;
+	releaseSurface();
+	_width = width;
+	_height = height;
+	_stride = (width + 7) & ~7;
+	_tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	_tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+	_color.assign(static_cast<size_t>(_stride) * height, CLEAR_COLOR);
+	_depth.assign(static_cast<size_t>(_stride) * height, 1.0f);
+}
+
+void SoftwareRenderer::draw(const FramePacket& packet, const Camera& camera)
+{
+	PROFILE_FUNCTION();
+	collectDraws(packet, camera);
+	transformVertices();
+
+	// La primera tanda tambien borra los tiles, aunque no haya ningun triangulo
+	size_t first = 0;
+	do {
+		const size_t count = min(BATCH_TRIANGLES, _triangleCount - first);
+		binTriangles(first, count);
+		const bool clear = first == 0;
+		PROFILE_SCOPE("RasterTiles");
+		JobSystem::parallelFor(static_cast<size_t>(_tilesX) * _tilesY, 1, [this, clear](size_t begin, size_t end) {
+			for (size_t tile = begin; tile < end; tile++) rasterTile(static_cast<int>(tile), clear);
+		});
+		first += count;
+	} while (first < _triangleCount);
+}
+
+void SoftwareRenderer::collectDraws(const FramePacket& packet, const Camera& camera)
+{
+	_draws.clear();
+	_vertexCount = 0;
+	_triangleCount = 0;
+	for (const DrawPacket& draw : packet.draws) {
+		const MeshData* mesh = Resources::meshes.get(draw.mesh);
+		if (!mesh || mesh->triangles.empty()) continue;
+		const Texture* texture = Resources::textures.get(draw.diffuse);
+
+		DrawRange range;
+		range.mesh = mesh;
+		range.texture = texture && !texture->pixels.empty() ? texture : nullptr;
+		range.modelViewProjection = camera.viewProjection() * draw.model;
+		range.firstVertex = _vertexCount;
+		range.firstTriangle = _triangleCount;
+		_vertexCount += mesh->vertices.size();
+		_triangleCount += mesh->triangles.size();
+		_draws.push_back(range);
+		Profiler::addCounter(Counter::DrawCalls, 1);
+		Profiler::addCounter(Counter::Triangles, static_cast<int64_t>(mesh->triangles.size()));
+	}
+	_clip.resize(_vertexCount);
+	_uv.resize(_vertexCount);
+}
+
+void SoftwareRenderer::transformVertices()
+{
+	PROFILE_FUNCTION();
+	JobSystem::parallelFor(_vertexCount, VERTEX_GRAIN, [this](size_t begin, size_t end) {
+		// El draw del primer vertice del bloque; los siguientes se recorren en orden
+		size_t d = upper_bound(_draws.begin(), _draws.end(), begin,
+			[](size_t vertex, const DrawRange& range) { return vertex < range.firstVertex; }) - _draws.begin() - 1;
+		for (size_t i = begin; i < end; i++) {
+			while (i - _draws[d].firstVertex >= _draws[d].mesh->vertices.size()) d++;
+			const DrawRange& draw = _draws[d];
+			const size_t local = i - draw.firstVertex;
+			_clip[i] = draw.modelViewProjection * glm::vec4(draw.mesh->vertices[local], 1.0f);
+			_uv[i] = texCoordAt(*draw.mesh, local);
+		}
+	});
+}
+
+void SoftwareRenderer::binTriangles(size_t first, size_t count)
+{
+	PROFILE_FUNCTION();
+	const size_t chunkSize = max(MIN_CHUNK_TRIANGLES, (count + MAX_CHUNKS - 1) / MAX_CHUNKS);
+	_chunkCount = (count + chunkSize - 1) / chunkSize;
+	if (_chunks.size() < _chunkCount) _chunks.resize(_chunkCount);
+	JobSystem::parallelFor(_chunkCount, 1, [this, first, count, chunkSize](size_t begin, size_t end) {
+		for (size_t c = begin; c < end; c++) {
+			const size_t from = first + c * chunkSize;
+			setupChunk(_chunks[c], from, min(from + chunkSize, first + count));
+		}
+	});
+}
+
+void SoftwareRenderer::setupChunk(Chunk& chunk, size_t first, size_t end) const
+{
+	chunk.setups.clear();
+	chunk.bins.resize(static_cast<size_t>(_tilesX) * _tilesY);
+	for (auto& bin : chunk.bins) bin.clear();
+	if (first == end) return;
+
+	size_t d = upper_bound(_draws.begin(), _draws.end(), first,
+		[](size_t triangle, const DrawRange& range) { return triangle < range.firstTriangle; }) - _draws.begin() - 1;
+	for (size_t t = first; t < end; t++) {
+		while (t - _draws[d].firstTriangle >= _draws[d].mesh->triangles.size()) d++;
+		const DrawRange& draw = _draws[d];
+		const vector<unsigned int>& indices = draw.mesh->triangles[t - draw.firstTriangle];
+		if (indices.size() < 3) continue;
+
+		ClipVertex polygon[4];
+		int codes = ~0, anyOutside = 0;
+		for (int i = 0; i < 3; i++) {
+			const size_t index = draw.firstVertex + indices[i];
+			polygon[i] = { _clip[index], _uv[index] };
+			const int code = outcode(polygon[i].position);
+			codes &= code;
+			anyOutside |= code;
+		}
+		if (codes) continue; // los tres fuera del mismo plano
+		int count = 3;
+		if (anyOutside & OUTSIDE_NEAR) {
+			const ClipVertex triangle[3] = { polygon[0], polygon[1], polygon[2] };
+			count = clipNear(triangle, polygon);
+		}
+
+		// Recortado puede quedar un cuadrilatero: dos triangulos en abanico
+		for (int i = 1; i + 1 < count; i++) {
+			const ClipVertex fan[3] = { polygon[0], polygon[i], polygon[i + 1] };
+			Setup s;
+			if (!setupTriangle(fan, draw.texture, s)) continue;
+			const uint32_t index = static_cast<uint32_t>(chunk.setups.size());
+			chunk.setups.push_back(s);
+			for (int ty = s.minY / TILE_SIZE; ty <= s.maxY / TILE_SIZE; ty++) {
+				for (int tx = s.minX / TILE_SIZE; tx <= s.maxX / TILE_SIZE; tx++) chunk.bins[ty * _tilesX + tx].push_back(index);
+			}
+		}
+	}
+}
+
+int SoftwareRenderer::clipNear(const ClipVertex in[3], ClipVertex out[4])
+{
+	// El corte se interpola siempre desde el vertice de dentro: los dos triangulos
+	// que comparten la arista obtienen el mismo punto
+	auto intersect = [](const ClipVertex& inside, const ClipVertex& outside) {
+		const float di = inside.position.z + inside.position.w;
+		const float doutside = outside.position.z + outside.position.w;
+		const float t = di / (di - doutside);
+		return ClipVertex{ inside.position + (outside.position - inside.position) * t, inside.uv + (outside.uv - inside.uv) * t };
+	};
+	int n = 0;
+	for (int i = 0; i < 3; i++) {
+		const ClipVertex& a = in[i];
+		const ClipVertex& b = in[(i + 1) % 3];
+		const bool aInside = a.position.z + a.position.w >= 0.0f;
+		const bool bInside = b.position.z + b.position.w >= 0.0f;
+		if (aInside) out[n++] = a;
+		if (aInside != bInside) out[n++] = aInside ? intersect(a, b) : intersect(b, a);
+	}
+	return n;
+}
+
+bool SoftwareRenderer::setupTriangle(const ClipVertex v[3], const Texture* texture, Setup& s) const
+{
+	// Pantalla con la y hacia abajo, en float como las usa rasterSpan.
+	// Despues del recorte w es al menos el plano cercano
+	float x[3], y[3];
+	double z[3], invW[3], uOverW[3], vOverW[3];
+	for (int i = 0; i < 3; i++) {
+		const double inv = 1.0 / v[i].position.w;
+		x[i] = static_cast<float>((v[i].position.x * inv * 0.5 + 0.5) * _width);
+		y[i] = static_cast<float>((0.5 - v[i].position.y * inv * 0.5) * _height);
+		z[i] = v[i].position.z * inv;
+		invW[i] = inv;
+		uOverW[i] = v[i].uv.x * inv;
+		vOverW[i] = v[i].uv.y * inv;
+	}
+
+	// Pixeles cuyo centro puede caer dentro
+	const float left = max(0.0f, min({ x[0], x[1], x[2] }));
+	const float right = min(_width - 1.0f, max({ x[0], x[1], x[2] }));
+	const float top = max(0.0f, min({ y[0], y[1], y[2] }));
+	const float bottom = min(_height - 1.0f, max({ y[0], y[1], y[2] }));
+	if (left > right || top > bottom) return false;
+	s.minX = static_cast<int>(left);
+	s.maxX = static_cast<int>(right);
+	s.minY = static_cast<int>(top);
+	s.maxY = static_cast<int>(bottom);
+
+	// La arista k va del vertice k + 1 al k + 2 y vale 0 en los dos. Los productos
+	// de dos floats son exactos en double: en una arista compartida los coeficientes
+	// salen exactamente con el signo cambiado y entre los triangulos no hay huecos
+	double a[3], b[3], c[3];
+	for (int k = 0; k < 3; k++) {
+		const int p = (k + 1) % 3, q = (k + 2) % 3;
+		a[k] = static_cast<double>(y[p]) - y[q];
+		b[k] = static_cast<double>(x[q]) - x[p];
+		c[k] = static_cast<double>(x[p]) * y[q] - static_cast<double>(y[p]) * x[q];
+	}
+	const double area = a[0] * x[0] + b[0] * y[0] + c[0]; // el doble del area, con signo
+	if (area == 0.0) return false;
+	// Sin culling de caras, como el pipeline de OpenGL: se orienta para que dentro sea positivo
+	const double sign = area < 0.0 ? -1.0 : 1.0;
+	for (int k = 0; k < 3; k++) {
+		s.edges.a[k] = static_cast<float>(a[k] * sign);
+		s.edges.b[k] = static_cast<float>(b[k] * sign);
+		s.edges.c[k] = static_cast<float>(c[k] * sign);
+		s.edges.topLeft[k] = s.edges.a[k] > 0.0f || (s.edges.a[k] == 0.0f && s.edges.b[k] > 0.0f);
+	}
+
+	// Atributo lineal en pantalla: sum(f[k] * E[k]) / area
+	s.edges.x0 = x[0];
+	s.edges.y0 = y[0];
+	auto plane = [&a, &b, area](const double f[3], float out[3]) {
+		out[0] = static_cast<float>(f[0]);
+		out[1] = static_cast<float>((f[0] * a[0] + f[1] * a[1] + f[2] * a[2]) / area);
+		out[2] = static_cast<float>((f[0] * b[0] + f[1] * b[1] + f[2] * b[2]) / area);
+	};
+	float depth[3];
+	plane(z, depth);
+	s.edges.z0 = depth[0];
+	s.edges.dzdx = depth[1];
+	s.edges.dzdy = depth[2];
+	plane(invW, s.invW);
+	plane(uOverW, s.uOverW);
+	plane(vOverW, s.vOverW);
+	s.texture = texture;
+	return true;
+}
+
+void SoftwareRenderer::rasterTile(int tile, bool clear)
+{
+	const int x0 = (tile % _tilesX) * TILE_SIZE;
+	const int y0 = (tile / _tilesX) * TILE_SIZE;
+	const int x1 = min(x0 + TILE_SIZE, _width);
+	const int y1 = min(y0 + TILE_SIZE, _height);
+	if (clear) {
+		for (int y = y0; y < y1; y++) {
+			const size_t row = static_cast<size_t>(y) * _stride;
+			fill(_color.begin() + row + x0, _color.begin() + row + x1, CLEAR_COLOR);
+			fill(_depth.begin() + row + x0, _depth.begin() + row + x1, 1.0f);
+		}
+	}
+
+	// Los bloques en orden y cada uno con sus triangulos en orden: el mismo que el de los draws
+	uint16_t covered[TILE_SIZE];
+	for (size_t c = 0; c < _chunkCount; c++) {
+		const Chunk& chunk = _chunks[c];
+		for (const uint32_t index : chunk.bins[tile]) {
+			const Setup& s = chunk.setups[index];
+			const int begin = max(x0, s.minX);
+			const int end = min(x1, s.maxX + 1);
+			const int bottom = min(y1, s.maxY + 1);
+			for (int y = max(y0, s.minY); y < bottom; y++) {
+				const size_t row = static_cast<size_t>(y) * _stride;
+				const int count = SimdMath::rasterSpan(s.edges, y, begin, end, &_depth[row], covered);
+				if (count) shadeSpan(s, y, covered, count, &_color[row]);
+			}
+		}
+	}
+}
+
+void SoftwareRenderer::shadeSpan(const Setup& s, int y, const uint16_t* covered, int count, uint32_t* colorRow)
+{
+	const Texture* texture = s.texture;
+	if (!texture) {
+		for (int i = 0; i < count; i++) colorRow[covered[i]] = WHITE;
+		return;
+	}
+	// Correccion de perspectiva: 1/w, u/w y v/w son lineales en pantalla, u y v no
+	const float dy = (y + 0.5f) - s.edges.y0;
+	const float invWRow = s.invW[0] + s.invW[2] * dy;
+	const float uRow = s.uOverW[0] + s.uOverW[2] * dy;
+	const float vRow = s.vOverW[0] + s.vOverW[2] * dy;
+	const int width = texture->width;
+	const int height = texture->height;
+	const unsigned char* texels = texture->pixels.data();
+	for (int i = 0; i < count; i++) {
+		const float dx = (covered[i] + 0.5f) - s.edges.x0;
+		const float w = 1.0f / (invWRow + s.invW[1] * dx);
+		const float u = (uRow + s.uOverW[1] * dx) * w;
+		const float v = (vRow + s.vOverW[1] * dx) * w;
+		if (!isfinite(u) || !isfinite(v)) continue;
+		// GL_REPEAT y GL_NEAREST: la parte fraccionaria y el texel que la contiene
+		const int tx = min(static_cast<int>((u - floorf(u)) * width), width - 1);
+		const int ty = min(static_cast<int>((v - floorf(v)) * height), height - 1);
+		memcpy(&colorRow[covered[i]], texels + (static_cast<size_t>(ty) * width + tx) * 4, sizeof(uint32_t));
+	}
+}
+
+SDL_Surface* SoftwareRenderer::surface()
+{
+	if (!_surface) {
+		_surface = SDL_CreateRGBSurfaceWithFormatFrom(_color.data(), _width, _height, 32, pitch(), SDL_PIXELFORMAT_RGBA32);
+	}
+	return _surface;
+}
+
+bool SoftwareRenderer::save(const char* path)
+{
+	SDL_Surface* image = surface();
+	if (!image || SDL_SaveBMP(image, path) != 0) {
+		fprintf(stderr, "No se puede guardar %s: %s\n", path, SDL_GetError());
+		return false;
+	}
+	return true;
+}
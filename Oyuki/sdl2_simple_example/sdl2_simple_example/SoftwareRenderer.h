@@ -0,0 +1,115 @@
+#pragma once
+#include "RenderPacket.h"
+#include "SimdMath.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Camera;
+struct MeshData;
+struct SDL_Surface;
+struct Texture;
+
+// Render por CPU para maquinas sin GPU: dibuja el mismo FramePacket que
+// drawModel con la camara del frame, en un buffer de color RGBA8 con su depth.
+// El frame va por fases, todas en paralelo con el JobSystem:
+//  1. Vertices a clip space.
+//  2. Triangulos: recorte contra el plano cercano, preparacion (aristas y
+//     planos de profundidad, 1/w, u/w y v/w) y reparto en tiles de TILE_SIZE.
+//  3. Cada tile en un job: sus triangulos en orden, fila a fila con
+//     SimdMath::rasterSpan (aristas y profundidad en SIMD) y la textura con
+//     correccion de perspectiva. Un tile solo escribe sus pixeles.
+// El reparto va por bloques de triangulos fijos, asi la imagen no depende del
+// numero de hilos. Hace lo mismo que el pipeline de OpenGL del motor: prueba de
+// profundidad LESS, textura con NEAREST y REPEAT y blanco sin textura.
+// Las mallas necesitan sus vertices en CPU (siempre los tienen) y las texturas
+// sus pixeles (insertTextureCpu); una textura que solo esta en GPU sale blanca.
+class SoftwareRenderer {
+public:
+	static const int TILE_SIZE = 64;
+
+private:
+	// Un draw del paquete ya resuelto, con sus vertices y triangulos en la numeracion global del frame
+	struct DrawRange
+	{
+		const MeshData* mesh = nullptr;
+		const Texture* texture = nullptr;
+		glm::mat4 modelViewProjection = glm::mat4(1.0f);
+		size_t firstVertex = 0;
+		size_t firstTriangle = 0;
+	};
+
+	// Triangulo preparado. Los planos son (valor en x0, y0; derivada en x; en y)
+	struct Setup
+	{
+		SimdMath::RasterEdges edges;
+		float invW[3];
+		float uOverW[3];
+		float vOverW[3];
+		const Texture* texture;
+		int minX, minY, maxX, maxY; // pixeles que puede tocar, ya dentro de la pantalla
+	};
+
+	struct ClipVertex
+	{
+		glm::vec4 position;
+		glm::vec2 uv;
+	};
+
+	// Un bloque de triangulos con lo que ha preparado y su lista por tile
+	struct Chunk
+	{
+		std::vector<Setup> setups;
+		std::vector<std::vector<uint32_t>> bins; // indices en setups, por tile
+	};
+
+	int _width = 0;
+	int _height = 0;
+	int _stride = 0; // en pixeles, multiplo de 8 para los bloques de rasterSpan
+	int _tilesX = 0;
+	int _tilesY = 0;
+	std::vector<uint32_t> _color;
+	std::vector<float> _depth;
+	SDL_Surface* _surface = nullptr;
+
+	std::vector<DrawRange> _draws;
+	size_t _vertexCount = 0;
+	size_t _triangleCount = 0;
+	std::vector<glm::vec4> _clip;
+	std::vector<glm::vec2> _uv;
+	std::vector<Chunk> _chunks;
+	size_t _chunkCount = 0;
+
+	void collectDraws(const FramePacket& packet, const Camera& camera);
+	void transformVertices();
+	void binTriangles(size_t first, size_t count);
+	void setupChunk(Chunk& chunk, size_t first, size_t end) const;
+	bool setupTriangle(const ClipVertex v[3], const Texture* texture, Setup& s) const;
+	static int clipNear(const ClipVertex in[3], ClipVertex out[4]);
+	void rasterTile(int tile, bool clear);
+	static void shadeSpan(const Setup& s, int y, const uint16_t* covered, int count, uint32_t* colorRow);
+	void releaseSurface();
+
+public:
+	SoftwareRenderer(int width, int height);
+	~SoftwareRenderer();
+
+	SoftwareRenderer(const SoftwareRenderer&) = delete;
+	SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
+
+	void resize(int width, int height);
+	int width() const { return _width; }
+	int height() const { return _height; }
+
+	// Borra a gris (como glClearColor) y dibuja todos los draws del paquete
+	void draw(const FramePacket& packet, const Camera& camera);
+
+	// RGBA8 con la fila 0 arriba; entre filas hay pitch() bytes
+	const uint32_t* pixels() const { return _color.data(); }
+	int pitch() const { return _stride * 4; }
+	// Surface de SDL sobre el buffer de color (sin copiarlo); vale hasta el siguiente resize
+	SDL_Surface* surface();
+	// BMP del ultimo frame
+	bool save(const char* path);
+};
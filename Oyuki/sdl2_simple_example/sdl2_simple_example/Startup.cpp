@@ -0,0 +1,103 @@
+#include "Startup.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+using hrclock = chrono::high_resolution_clock;
+
+namespace
+{
+	struct PhaseRecord
+	{
+		const char* name;
+		double startMs;
+		double ms;
+		bool mainThread;
+	};
+
+	// Los dos se inicializan con los globales, antes de main y en el hilo principal
+	const hrclock::time_point processStart = hrclock::now();
+	const thread::id mainThreadId = this_thread::get_id();
+
+	mutex phasesMutex;
+	vector<PhaseRecord> phases;
+	double firstFrameMs = -1.0;
+
+	double sinceStart()
+	{
+		return chrono::duration<double, milli>(hrclock::now() - processStart).count();
+	}
+
+	// Copia ordenada por inicio
+	vector<PhaseRecord> sortedPhases()
+	{
+		lock_guard<mutex> lock(phasesMutex);
+		vector<PhaseRecord> sorted = phases;
+		sort(sorted.begin(), sorted.end(), [](const PhaseRecord& a, const PhaseRecord& b) { return a.startMs < b.startMs; });
+		return sorted;
+	}
+}
+
+StartupPhase::StartupPhase(const char* name) : _name(name), _startMs(sinceStart())
+{
+}
+
+StartupPhase::~StartupPhase()
+{
+	const double endMs = sinceStart();
+	lock_guard<mutex> lock(phasesMutex);
+	phases.push_back({ _name, _startMs, endMs - _startMs, this_thread::get_id() == mainThreadId });
+}
+
+void Startup::markFirstFrame()
+{
+	if (firstFrameMs >= 0.0) return;
+	firstFrameMs = sinceStart();
+	print(stdout);
+}
+
+double Startup::timeToFirstFrameMs()
+{
+	return firstFrameMs;
+}
+
+double Startup::spanMs(const char* first, const char* last)
+{
+	lock_guard<mutex> lock(phasesMutex);
+	const PhaseRecord* a = nullptr;
+	const PhaseRecord* b = nullptr;
+	for (const auto& phase : phases) {
+		if (strcmp(phase.name, first) == 0) a = &phase;
+		if (strcmp(phase.name, last) == 0) b = &phase;
+	}
+	return a && b ? b->startMs + b->ms - a->startMs : -1.0;
+}
+
+void Startup::print(FILE* f)
+{
+	fprintf(f, "Arranque (ms desde el inicio del proceso)\n");
+	fprintf(f, "  %-16s %-10s %10s %10s\n", "fase", "hilo", "inicio", "duracion");
+	for (const auto& phase : sortedPhases()) {
+		fprintf(f, "  %-16s %-10s %10.2f %10.2f\n", phase.name, phase.mainThread ? "principal" : "worker", phase.startMs, phase.ms);
+	}
+	if (firstFrameMs >= 0.0) fprintf(f, "  primer frame a los %.2f ms\n", firstFrameMs);
+}
+
+void Startup::writeJson(FILE* f, const char* indent)
+{
+	const vector<PhaseRecord> sorted = sortedPhases();
+	fprintf(f, "{\n");
+	fprintf(f, "%s  \"time_to_first_frame_ms\": %.3f,\n", indent, firstFrameMs);
+	fprintf(f, "%s  \"phases\": [\n", indent);
+	for (size_t i = 0; i < sorted.size(); i++) {
+		fprintf(f, "%s    { \"name\": \"%s\", \"main_thread\": %s, \"start_ms\": %.3f, \"ms\": %.3f }%s\n",
+			indent, sorted[i].name, sorted[i].mainThread ? "true" : "false", sorted[i].startMs, sorted[i].ms,
+			i + 1 < sorted.size() ? "," : "");
+	}
+	fprintf(f, "%s  ]\n", indent);
+	fprintf(f, "%s}", indent);
+}
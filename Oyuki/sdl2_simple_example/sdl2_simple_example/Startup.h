@@ -0,0 +1,31 @@
+#pragma once
+#include <stdio.h>
+
+// Tiempos del arranque por fase.
+// Las fases pueden solaparse (la carga va en workers mientras el hilo principal
+// crea la ventana), asi que cada una guarda su hilo y su inicio, contados desde
+// que se carga el programa. markFirstFrame() cierra el arranque con el tiempo
+// hasta el primer frame presentado.
+class StartupPhase {
+
+	const char* _name;
+	double _startMs;
+
+public:
+	explicit StartupPhase(const char* name);
+	~StartupPhase();
+};
+
+namespace Startup
+{
+	// La primera llamada guarda el tiempo y escribe el informe por stdout
+	void markFirstFrame();
+	double timeToFirstFrameMs(); // -1 si aun no se ha presentado ninguno
+
+	// Desde que empieza 'first' hasta que acaba 'last'; -1 si falta alguna
+	double spanMs(const char* first, const char* last);
+
+	void print(FILE* f);
+	// Objeto JSON con el tiempo hasta el primer frame y la lista de fases
+	void writeJson(FILE* f, const char* indent);
+}
@@ -0,0 +1,161 @@
+#include "TraceCapture.h"
+#include "Profiler.h"
+#include "GpuTimer.h"
+#include <imgui.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace
+{
+	const int PROCESS_ID = 1;
+	const int GPU_THREAD_ID = 1000;
+
+	FILE* file = nullptr;
+	string filePath;
+	int framesLeft = 0;
+	int framesWritten = 0;
+	uint64_t captureStart = 0;
+	bool firstEvent = true;
+	vector<bool> namedThreads;
+	char lastCapture[260] = "";
+
+	// Microsegundos desde el inicio de la captura (unidad de "ts" y "dur")
+	double toUs(uint64_t ns)
+	{
+		return ns > captureStart ? (ns - captureStart) / 1000.0 : 0.0;
+	}
+
+	void writeEscaped(const char* s)
+	{
+		fputc('"', file);
+		for (; *s; s++) {
+			const unsigned char c = static_cast<unsigned char>(*s);
+			if (c == '"' || c == '\\') { fputc('\\', file); fputc(c, file); }
+			else if (c < 0x20) fprintf(file, "\\u%04x", c);
+			else fputc(c, file);
+		}
+		fputc('"', file);
+	}
+
+	void beginEvent()
+	{
+		fputs(firstEvent ? "\n" : ",\n", file);
+		firstEvent = false;
+	}
+
+	void writeThreadName(int tid, const char* name)
+	{
+		beginEvent();
+		fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":", PROCESS_ID, tid);
+		writeEscaped(name);
+		fputs("}}", file);
+	}
+
+	void writeComplete(const char* name, const char* category, int tid, uint64_t begin, uint64_t end)
+	{
+		beginEvent();
+		fputs("{\"name\":", file);
+		writeEscaped(name);
+		fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+			category, PROCESS_ID, tid, toUs(begin), end > begin ? (end - begin) / 1000.0 : 0.0);
+	}
+
+	void writeCounter(const char* name, uint64_t time, long long value)
+	{
+		beginEvent();
+		fputs("{\"name\":", file);
+		writeEscaped(name);
+		fprintf(file, ",\"ph\":\"C\",\"pid\":%d,\"ts\":%.3f,\"args\":{\"value\":%lld}}", PROCESS_ID, toUs(time), value);
+	}
+}
+
+bool TraceCapture::start(const char* path, int frames)
+{
+	if (file) stop();
+	file = fopen(path, "wb");
+	if (!file) {
+		fprintf(stderr, "TraceCapture: no se puede abrir %s\n", path);
+		return false;
+	}
+	setvbuf(file, nullptr, _IOFBF, 1 << 16);
+
+	filePath = path;
+	framesLeft = frames;
+	framesWritten = 0;
+	captureStart = Profiler::now();
+	firstEvent = true;
+	namedThreads.clear();
+
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+	writeThreadName(GPU_THREAD_ID, "GPU");
+	return true;
+}
+
+void TraceCapture::stop()
+{
+	if (!file) return;
+	fputs("\n]}\n", file);
+	fclose(file);
+	file = nullptr;
+	snprintf(lastCapture, sizeof(lastCapture), "%s (%d frames)", filePath.c_str(), framesWritten);
+	printf("TraceCapture: %s\n", lastCapture);
+}
+
+bool TraceCapture::capturing()
+{
+	return file != nullptr;
+}
+
+void TraceCapture::endFrame()
+{
+	if (!file) return;
+
+	for (const auto& zone : Profiler::lastFrameZones()) {
+		if (zone.end < captureStart) continue;
+		if (zone.thread >= static_cast<int>(namedThreads.size())) namedThreads.resize(zone.thread + 1, false);
+		if (!namedThreads[zone.thread]) {
+			writeThreadName(zone.thread, Profiler::threadName(zone.thread).c_str());
+			namedThreads[zone.thread] = true;
+		}
+		writeComplete(zone.name, "cpu", zone.thread, zone.begin, zone.end);
+	}
+
+	for (const auto& pass : GpuTimer::lastSamples()) {
+		if (pass.end < captureStart) continue;
+		writeComplete(pass.name, "gpu", GPU_THREAD_ID, pass.begin, pass.end);
+	}
+
+	const uint64_t frameEnd = Profiler::lastFrameEnd();
+	for (int i = 0; i < static_cast<int>(Counter::COUNT); i++) {
+		const Counter counter = static_cast<Counter>(i);
+		writeCounter(Profiler::counterName(counter), frameEnd, static_cast<long long>(Profiler::lastCounter(counter)));
+	}
+
+	framesWritten++;
+	if (--framesLeft <= 0) stop();
+}
+
+void TraceCapture::drawImGui()
+{
+	static int frames = 300;
+
+	if (!ImGui::Begin("Profiler")) {
+		ImGui::End();
+		return;
+	}
+	if (ImGui::CollapsingHeader("Captura")) {
+		if (capturing()) {
+			ImGui::Text("Capturando... %d frames restantes", framesLeft);
+			if (ImGui::Button("Parar")) stop();
+		}
+		else {
+			ImGui::InputInt("Frames", &frames);
+			if (frames < 1) frames = 1;
+			if (ImGui::Button("Capturar traza")) start("oyuki_trace.json", frames);
+		}
+		if (lastCapture[0]) ImGui::TextDisabled("Ultima: %s", lastCapture);
+	}
+	ImGui::End();
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// Captura de N frames en formato Chrome trace-event JSON (se abre en
+// ui.perfetto.dev o chrome://tracing). Se escribe frame a frame en el fichero,
+// asi que una captura larga no se acumula en memoria.
+// Incluye las zonas de CPU con el nombre de cada hilo, los contadores del
+// Profiler y las pasadas de GPU en una pista propia.
+namespace TraceCapture
+{
+	bool start(const char* path, int frames);
+	void stop();
+	bool capturing();
+
+	// Despues de Profiler::endFrame y GpuTimer::endFrame
+	void endFrame();
+
+	// Boton de captura dentro de la ventana "Profiler"
+	void drawImGui();
+}
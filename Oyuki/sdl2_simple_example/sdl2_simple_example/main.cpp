@@ -4,16 +4,46 @@
 #include <exception>
 #include <glm/glm.hpp>
 #include <SDL2/SDL_events.h>
+#include <SDL2/SDL_hints.h>
 #include "MyWindow.h"
 #include <stdio.h>
-#include <assimp/cimport.h>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
 #include <vector>
 #include "imgui_impl_sdl2.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <IL/il.h>
+#include "FixedTimestep.h"
+#include "JobSystem.h"
+#include "Benchmark.h"
+#include "RenderPacket.h"
+#include "Profiler.h"
+#include "GpuTimer.h"
+#include "TraceCapture.h"
+#include "OffscreenTarget.h"
+#include "Mesh.h"
+#include "Simulation.h"
+#include "Culling.h"
+#include "FrameArena.h"
+#include "AllocationCounter.h"
+#include "Resources.h"
+#include "Scene.h"
+#include "Startup.h"
+#include "HotReload.h"
+#include "Pak.h"
+#include "Shaders.h"
+#include "SceneFile.h"
+#include "Input.h"
+#include "Picking.h"
+#include "Camera.h"
+#include "Redraw.h"
+#include "SoftwareRenderer.h"
+#include "SimdMath.h"
+#include <SDL2/SDL_surface.h>
+#include <imgui.h>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
 
 using namespace std;
 
@@ -25,10 +55,63 @@ using vec3 = glm::dvec3;
 static const ivec2 WINDOW_SIZE(512, 512);
 static const unsigned int FPS = 60;
 static const auto FRAME_DT = 1.0s / FPS;
+static const double SIM_DT = 1.0 / 120.0; // Paso fijo de simulacion
+static const int MAX_SIM_STEPS = 8;       // Maximo de pasos a recuperar por frame
+// La camara se corrige justo antes de dibujar (late latch), despues del culling:
+// el frustum del culling se abre estos grados por cada lado para que lo que
+// entra por el borde en ese intervalo no falte. Un giro mas rapido puede dejar
+// un frame sin algun objeto en el borde.
+static const float LATE_LATCH_GUARD_DEGREES = 10.0f;
+// Render bajo demanda: frames que se dibujan tras cada cambio y espera maxima parado
+static const int PIPELINE_FRAMES = 2;     // un cambio de la escena llega a pantalla un frame despues (doble buffer)
+static const int IMGUI_SETTLE_FRAMES = 3; // hover, ventanas que se abren... ImGui tarda algun frame en reaccionar
+static const int IDLE_TIMEOUT_MS = 1000;
+static const int HOT_RELOAD_POLL_MS = 100; // con un fichero cambiando o cargandose
+static const char* MODEL_PATH = "C:/Users/adriarj/Downloads/putin.fbx";
+static const char* TEXTURE_PATH = "C:/Users/adriarj/Downloads/putinText.png";
+
+// La camara de pantalla solo la toca el hilo principal (late latch, picking);
+// la del culling, con el margen del late latch, solo la extraccion del frame
+static Camera camera(45.0f, WINDOW_SIZE.x, WINDOW_SIZE.y);
+static Camera cullCamera(45.0f + 2.0f * LATE_LATCH_GUARD_DEGREES, WINDOW_SIZE.x, WINDOW_SIZE.y);
+Scene scene;
+
+// --no-shader-cache lo deja a nullptr: se compila siempre
+static const char* shaderCacheDirectory = "shader_cache";
+
+// Programa de las mallas: posicion, normal y UV en las locations 0, 1 y 2 de LoadToBuffers
+// uViewProjection se sube solo cuando cambia la camara; uModel va con cada draw
+static const char* MESH_VERTEX_SHADER = R"(#version 130
+uniform mat4 uViewProjection;
+uniform mat4 uModel;
+in vec3 aPosition;
+in vec4 aNormal;
+in vec2 aTexCoord;
+out vec2 vTexCoord;
+void main() {
+	vTexCoord = aTexCoord;
+	gl_Position = uViewProjection * (uModel * vec4(aPosition, 1.0));
+}
+)";
+static const char* MESH_FRAGMENT_SHADER = R"(#version 130
+uniform sampler2D uTexture;
+uniform bool uTextured;
+in vec2 vTexCoord;
+void main() {
+	gl_FragColor = uTextured ? texture(uTexture, vTexCoord) : vec4(1.0);
+}
+)";
+static ShaderHandle meshShader; // nulo si no compila: se dibuja con la pipeline fija
+static GLint meshViewProjectionLocation = -1;
+static GLint meshModelLocation = -1;
+static GLint meshTexturedLocation = -1;
 
-glm::mat4 projectionMatrix;
-glm::mat4 viewMatrix;
-glm::mat4 modelMatrix;
+// Lo que ya esta cargado en OpenGL de la camara (version de Camera): los
+// uniforms se quedan en el programa y las matrices fijas en su pila
+static GLuint cameraProgram = 0;
+static uint64_t cameraProgramVersion = 0;
+static uint64_t fixedProjectionVersion = 0;
+static uint64_t fixedViewVersion = 0;
 
 
 
@@ -38,7 +121,8 @@ static void init_openGL() {
 
 	glEnable(GL_DEPTH_TEST);
 	glEnable(GL_TEXTURE_2D);
-	ilInit();
+	GpuTimer::init(); // DevIL se inicializa al decodificar la primera imagen
+	Shaders::init(shaderCacheDirectory);
 	/*glEnable(GL_LIGHTING);
 	glEnable(GL_LIGHT0);
 	glEnable(GL_COLOR_MATERIAL);
@@ -69,197 +153,47 @@ static void init_openGL() {
 	glColorMaterial(GL_FRONT, GL_AMBIENT_AND_DIFFUSE);*/
 
 	glClearColor(0.2f, 0.2f, 0.2f, 1.0f);  // Fondo ms oscuro para mejor contraste
-
-	projectionMatrix = glm::perspective(glm::radians(45.0f),
-		static_cast<float>(WINDOW_SIZE.x) / WINDOW_SIZE.y, 0.1f, 100.0f);
-	viewMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -5.0f));
-	modelMatrix = glm::mat4(1.0f);
 }
 
-struct MeshData // Estructura para almacenar los datos de un modelo 3D
-{
-	vector<vec3> vertices;
-	vector<vector<unsigned int>> triangles;
-	vector<vec3> colors;
-	vector<vec3> normals; 
-	vector<vec3> texCoords;
-	GLuint vao = 0;
-	GLuint vbo = 0;
-	GLuint ebo = 0;
-	GLuint normalVBO = 0;
-	GLuint textureVBO = 0;
-	GLuint colorVBO = 0;
-};
-
-static void drawModel(const vector<MeshData>& data) {
-	
-	for (const auto& meshData : data) {
-		glBindVertexArray(meshData.vao);
-
-		// Asegrate de que el color se cargue desde el VBO de colores
-		glBindBuffer(GL_ARRAY_BUFFER, meshData.colorVBO);
-		glBindBuffer(GL_ARRAY_BUFFER, meshData.textureVBO);
-		glEnableVertexAttribArray(2); // Activar el atributo de color
-
-		size_t offset = 0;
-		for (size_t i = 0; i < meshData.triangles.size(); i++) {
-			const auto& triangle = meshData.triangles[i];
-			//if (i % 6 == 0) glColor3f(0.6f, 0.6f, 0.6f); // Rojo
-			//else if (i % 6 == 1) glColor3f(0.3f, 0.3f, 0.3f); // Verde
-			//else if (i % 6 == 2) glColor3f(0.5f, 0.5f, 0.5f); // Azul
-			//else if (i % 6 == 3) glColor3f(0.1f, 0.1f, 0.1f); // Amarillo
-			//else if (i % 6 == 4) glColor3f(0.4f, 0.4f, 0.4f); // Magenta
-			//else if (i % 6 == 5) glColor3f(0.2f, 0.2f, 0.2f); // Cian
-			glDrawElements(GL_TRIANGLES, triangle.size(), GL_UNSIGNED_INT,
-				(void*)(offset * sizeof(unsigned int)));
-			offset += triangle.size();
+static void drawModel(const FramePacket& packet, const Camera& camera) {
+	PROFILE_FUNCTION();
+
+	const ShaderProgram* shader = Resources::shaders.get(meshShader);
+	if (shader) {
+		glUseProgram(shader->id);
+		if (shader->id != cameraProgram || camera.version() != cameraProgramVersion) {
+			glUniformMatrix4fv(meshViewProjectionLocation, 1, GL_FALSE, glm::value_ptr(camera.viewProjection()));
+			cameraProgram = shader->id;
+			cameraProgramVersion = camera.version();
+			Profiler::addCounter(Counter::CameraUploads, 1);
 		}
-		glBindVertexArray(0);
-	}
-}
-
-void LoadToBuffers(MeshData& meshData) 
-{
-	glGenVertexArrays(1, &meshData.vao);
-	glGenBuffers(1, &meshData.vbo);
-	glGenBuffers(1, &meshData.ebo);
-	glGenBuffers(1, &meshData.normalVBO);
-	glGenBuffers(1, &meshData.textureVBO);
-
-	glBindVertexArray(meshData.vao);
-
-	// Cargar vrtices
-	glBindBuffer(GL_ARRAY_BUFFER, meshData.vbo);
-	glBufferData(GL_ARRAY_BUFFER, meshData.vertices.size() * sizeof(vec3),
-		meshData.vertices.data(), GL_STATIC_DRAW);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_DOUBLE, GL_FALSE, sizeof(vec3), (void*)0);
-
-	// Cargar normales
-	if (!meshData.normals.empty()) {
-		glBindBuffer(GL_ARRAY_BUFFER, meshData.normalVBO);
-		glBufferData(GL_ARRAY_BUFFER, meshData.normals.size() * sizeof(vec3), meshData.normals.data(), GL_STATIC_DRAW);
-		glEnableVertexAttribArray(1); // Asegrate de usar el ndice correcto
-		glVertexAttribPointer(1, 3, GL_DOUBLE, GL_FALSE, sizeof(vec3), (void*)0);
-	}
-
-	//Texturas
-	if (!meshData.texCoords.empty()) {
-		glGenBuffers(1, &meshData.textureVBO);
-		glBindBuffer(GL_ARRAY_BUFFER, meshData.textureVBO);
-		glBufferData(GL_ARRAY_BUFFER, meshData.texCoords.size() * sizeof(vec3), meshData.texCoords.data(), GL_STATIC_DRAW);
-		glEnableVertexAttribArray(2); // Atributo 2 para texturas
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_TRUE, sizeof(vec3), (void*)0); // Cambi a GL_FLOAT y 2 componentes
-	}
-
-	// Cargar ndices
-	vector<unsigned int> allIndices;
-	for (const auto& triangle : meshData.triangles) {
-		allIndices.insert(allIndices.end(), triangle.begin(), triangle.end());
-	}
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshData.ebo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshData.triangles.size() * sizeof(unsigned int) * 3,
-		allIndices.data(), GL_STATIC_DRAW);
-
-
-	glBindVertexArray(0);
-}
-
-void cleanupMeshData(MeshData& meshData) {
-	glDeleteBuffers(1, &meshData.vbo);
-	glDeleteBuffers(1, &meshData.ebo);
-	glDeleteBuffers(1, &meshData.colorVBO);  // Nuevo: eliminar VBO de colores
-	glDeleteBuffers(1, &meshData.textureVBO);
-	glDeleteVertexArrays(1, &meshData.vao);
-}
-
-vector<MeshData> LoadFBX()
-{
-	const char* file = "C:/Users/adriarj/Downloads/putin.fbx"; // Ruta del fitxer a carregar
-	const struct aiScene* scene = aiImportFile(file,
-		aiProcess_Triangulate | aiProcess_GenNormals);
-	const float scaleFactor = 1.0f;
-	if (!scene) {
-		fprintf(stderr, "Error en carregar el fitxer: %s\n", aiGetErrorString());
-		return {};
 	}
 
-	vector<MeshData> MayaTotal;
-
-	for (unsigned int i = 0; i < scene->mNumMeshes; i++) 
-	{
-		aiMesh* mesh = scene->mMeshes[i];
-		MeshData meshData;
-
-		// Vrtexs
-		for (unsigned int v = 0; v < mesh->mNumVertices; v++) {
-			aiVector3D vertex = mesh->mVertices[v];
-			meshData.vertices.push_back(vec3(
-				vertex.x * scaleFactor,
-				vertex.y * scaleFactor,
-				vertex.z * scaleFactor));
-			if (mesh->HasNormals()) {
-				aiVector3D normal = mesh->mNormals[v];
-				meshData.normals.push_back(vec3(normal.x, normal.y, normal.z));
-			}
-			// Coordenadas de textura (si estn disponibles)
-			if (mesh->HasTextureCoords(0)) {
-				aiVector3D texCoord = mesh->mTextureCoords[0][v];
-				meshData.texCoords.push_back(vec3(texCoord.x, texCoord.y, 0));
-			}
+	GLuint boundTexture = ~0u;
+	for (const auto& draw : packet.draws) {
+		if (draw.texture != boundTexture) {
+			glBindTexture(GL_TEXTURE_2D, draw.texture);
+			boundTexture = draw.texture;
+			if (shader) glUniform1i(meshTexturedLocation, draw.texture != 0);
 		}
-
-		// ndexs de triangles (3 per triangle)
-		for (unsigned int f = 0; f < mesh->mNumFaces; f++) 
-		{
-			aiFace face = mesh->mFaces[f];
-			if (face.mNumIndices != 3) {
-				printf("Advertencia: Face %u no es un tringulo (tiene %u ndices)\n",
-					f, face.mNumIndices);
-				continue;
-			}
-			vector<unsigned int> indices;
-			for (unsigned int j = 0; j < face.mNumIndices; j++) {
-				indices.push_back(face.mIndices[j]);
-			}
-			meshData.triangles.push_back(indices);
+		if (shader) {
+			glUniformMatrix4fv(meshModelLocation, 1, GL_FALSE, glm::value_ptr(draw.model));
+		}
+		else {
+			glPushMatrix();
+			glMultMatrixf(glm::value_ptr(draw.model));
 		}
+		glBindVertexArray(draw.vao);
+		glEnableVertexAttribArray(2); // Activar el atributo de textura
 
-		LoadToBuffers(meshData);
-		MayaTotal.push_back(move(meshData));
+		// Todos los triangulos estan seguidos en el EBO: una sola llamada por malla
+		glDrawElements(GL_TRIANGLES, draw.indexCount, GL_UNSIGNED_INT, (void*)0);
+		glBindVertexArray(0);
+		if (!shader) glPopMatrix();
+		Profiler::addCounter(Counter::DrawCalls, 1);
+		Profiler::addCounter(Counter::Triangles, draw.indexCount / 3);
 	}
-	aiReleaseImport(scene);
-	return MayaTotal;
-
-}
-void LoadText()
-{
-	const char* Path = "C:/Users/adriarj/Downloads/putinText.png";
-	ILuint imageID;
-	ilGenImages(1, &imageID);
-	ilBindImage(imageID);
-
-	if (!ilLoadImage((const wchar_t*)Path)) {  // Cargamos la imagen usando la ruta
-		ilDeleteImages(1, &imageID);
-		return; // Si falla, terminamos aqu
-	}
-
-	ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
-	int width = ilGetInteger(IL_IMAGE_WIDTH);
-	int height = ilGetInteger(IL_IMAGE_HEIGHT);
-	unsigned char* imageData = ilGetData();
-	GLuint textureID;
-
-	//ilLoadImage((const wchar_t* )textureID);
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_2D, textureID);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, imageData);
-	ilDeleteImages(1, &imageID);
+	if (shader) glUseProgram(0);
 }
 
 void drawGrid(float size = 10.0f, int divisions = 10) {
@@ -285,31 +219,84 @@ void drawGrid(float size = 10.0f, int divisions = 10) {
 
 	glEnd();
 }
-vector<MeshData> dato;
-float rotationX = 0.0f;  // Rotacin alrededor del eje X
-float rotationY = 0.0f;  // Rotacin alrededor del eje Y
-float objX = 0.0f;
-float objY = 0.0f;
-bool isDragging = false;  // Indica si el mouse est siendo arrastrado
-bool isScrolling = false;
-bool moveObject = false;
-int lastMouseX, lastMouseY; // ltima posicin del mouse
-float zoomLevel = -5.0f;
-float cameraOffsetY;
-float cameraOffsetX;
-
-
-
-static void display_func() //funcion que se llama en el main, seria como un Update
+
+SimState previousState;
+SimState currentState;
+PendingInput pendingInput;
+static bool quitRequested = false; // SDL_QUIT visto en el pump del late latch
+
+// Clic izquierdo: selecciona lo que hay debajo del cursor; arrastrando, lo mueve
+// en el plano paralelo a la pantalla que pasa por el punto agarrado
+static Entity selectedEntity;
+static bool draggingSelection = false;
+static glm::vec3 dragAnchor = glm::vec3(0.0f);
+
+// --scene <fichero>: se carga al arrancar si existe y se guarda al salir.
+// F5 guarda y F9 carga en cualquier momento (por defecto en scene.oysc).
+static const char* scenePath = "scene.oysc";
+static bool persistScene = false;
+static bool saveSceneRequested = false;
+static bool loadSceneRequested = false;
+
+// Fase de extraccion: la lista de draws del frame sin tocar OpenGL.
+// Transforms y bounds solo se recalculan si ha cambiado la escena, y el culling
+// si ademas se ha movido la camara: con todo quieto el paquete conserva los
+// draws de la ultima vez que se lleno (hace dos frames con el doble buffer)
+static void extract_frame(const SimState& state, FramePacket& packet, Camera& cullCamera)
 {
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	PROFILE_FUNCTION();
+	cullCamera.setPose(state);
+
+	static uint64_t updatedSceneVersion = 0;
+	if (scene.version() != updatedSceneVersion) {
+		SceneSystems::updateTransforms(scene);
+		SceneSystems::updateBounds(scene);
+		updatedSceneVersion = scene.version();
+	}
+
+	// Frustum culling con la AABB de cada entidad y orden por estado/profundidad
+	if (packet.cameraVersion != cullCamera.version() || packet.sceneVersion != scene.version()) {
+		packet.draws.clear();
+		SceneSystems::extractDraws(scene, cullCamera.frustum(), cullCamera.view(), packet);
+		packet.cameraVersion = cullCamera.version();
+		packet.sceneVersion = scene.version();
+		Profiler::addCounter(Counter::CullPasses, 1);
+	}
 
-	// Actualizar la matriz de vista: zoom (eje Z) y desplazamiento en el eje Y (para mover la cmara arriba/abajo)	
-	viewMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(cameraOffsetX * 0.4f, -cameraOffsetY * 0.4f, zoomLevel));
-	viewMatrix = glm::rotate(viewMatrix, glm::radians(rotationX), glm::vec3(1.0f, 0.0f, 0.0f));
-	viewMatrix = glm::rotate(viewMatrix, glm::radians(rotationY), glm::vec3(0.0f, 1.0f, 0.0));
+	if (const Bounds* b = scene.bounds.get(selectedEntity)) {
+		packet.hasSelection = true;
+		packet.selectionMin = b->worldMin;
+		packet.selectionMax = b->worldMax;
+	}
+}
 
-	modelMatrix = glm::mat4(1.0f);	
+static void drawSelection(const FramePacket& packet)
+{
+	if (!packet.hasSelection) return;
+	const glm::vec3& lo = packet.selectionMin;
+	const glm::vec3& hi = packet.selectionMax;
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBegin(GL_LINES);
+	glColor3f(1.0f, 0.6f, 0.1f);
+	// Las 12 aristas de la caja: 4 en cada eje
+	for (int i = 0; i < 4; i++) {
+		const float a = (i & 1) ? hi.y : lo.y, b = (i & 2) ? hi.z : lo.z;
+		glVertex3f(lo.x, a, b); glVertex3f(hi.x, a, b);
+		const float c = (i & 1) ? hi.x : lo.x, d = (i & 2) ? hi.z : lo.z;
+		glVertex3f(c, lo.y, d); glVertex3f(c, hi.y, d);
+		const float e = (i & 1) ? hi.x : lo.x, f = (i & 2) ? hi.y : lo.y;
+		glVertex3f(e, f, lo.z); glVertex3f(e, f, hi.z);
+	}
+	glEnd();
+	glColor3f(1.0f, 1.0f, 1.0f);
+}
+
+// Fase de render: solo consume el paquete ya publicado. La camara puede ser mas
+// reciente que la del culling del paquete (late latch)
+static void display_func(const FramePacket& packet, const Camera& camera) //funcion que se llama en el main, seria como un Update
+{
+	PROFILE_FUNCTION();
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	//drawGrid();
 	// Crear la matriz de modelo: rotacin del objeto en los ejes X e Y
@@ -320,96 +307,583 @@ static void display_func() //funcion que se llama en el main, seria como un Upda
 	// Multiplicacin de las matrices: proyeccin * vista * modelo
 	//glm::mat4 mvp = projectionMatrix * viewMatrix * modelMatrix;
 
-	// Aplicar la matriz MVP en OpenGL
-	glMatrixMode(GL_PROJECTION);
-	glLoadMatrixf(glm::value_ptr(projectionMatrix));
+	// Matrices de la pipeline fija (rejilla, caja de seleccion y mallas sin shader), solo si han cambiado
+	if (camera.projectionVersion() != fixedProjectionVersion) {
+		glMatrixMode(GL_PROJECTION);
+		glLoadMatrixf(glm::value_ptr(camera.projection()));
+		glMatrixMode(GL_MODELVIEW);
+		fixedProjectionVersion = camera.projectionVersion();
+	}
+	if (camera.version() != fixedViewVersion) {
+		glMatrixMode(GL_MODELVIEW);
+		glLoadMatrixf(glm::value_ptr(camera.view()));
+		fixedViewVersion = camera.version();
+	}
 
-	glMatrixMode(GL_MODELVIEW);
-	glLoadMatrixf(glm::value_ptr(viewMatrix));
+	GPU_SCOPE("Scene");
+	drawModel(packet, camera);
+	drawSelection(packet);
+}
+
+// Al principio del frame: el input acumulado pasa a la simulacion y las teclas se atienden aqui.
+// Ningun job esta extrayendo todavia, asi que tambien se puede cambiar la camara del culling
+static bool processEvents(MyWindow& window)
+{
+	if (quitRequested || !Input::pump()) return false;
+	int width, height;
+	if (Input::consumeResize(width, height)) {
+		// Un redimensionado solo cambia la proyeccion; la vista y el resto siguen en cache
+		window.resized(width, height);
+		glViewport(0, 0, width, height);
+		camera.setViewport(width, height);
+		cullCamera.setViewport(width, height);
+	}
+	if (Input::keyPressed(SDLK_F5)) saveSceneRequested = true;
+	if (Input::keyPressed(SDLK_F9)) loadSceneRequested = true;
+	Input::take(pendingInput);
+	return true;
+}
 
-	drawModel(dato);
+// Entre frames: ni la simulacion ni la extraccion estan leyendo la escena
+static void save_scene()
+{
+	saveSceneRequested = false;
+	const auto t0 = hrclock::now();
+	if (!SceneFile::save(scenePath, scene, currentState)) return;
+	printf("Escena guardada en %s: %zu entidades en %.2f ms\n", scenePath, scene.entityCount(),
+		chrono::duration<double, milli>(hrclock::now() - t0).count());
 }
 
-static bool processEvents() //funcion que gestion de eventos(mouse)
+// Entre frames, con la vista que ha visto el usuario en el ultimo frame
+static void update_selection()
 {
-	SDL_Event event;
-	while (SDL_PollEvent(&event)) {
-		ImGui_ImplSDL2_ProcessEvent(&event);
-		switch (event.type) {
-		case SDL_QUIT:
-			return false;
-		case SDL_MOUSEBUTTONDOWN: //cuando se presiona el boton del mouse
-			if (event.button.button == SDL_BUTTON_RIGHT) {//boton derecho
-				isDragging = true;
-				SDL_GetMouseState(&lastMouseX, &lastMouseY);
-			}
-			if (event.button.button == SDL_BUTTON_LEFT) // boton izquierdo + alt
-			{
-				if (SDL_GetModState() & KMOD_ALT)
-				{
-					isScrolling = true;
-					SDL_GetMouseState(&lastMouseX, &lastMouseY);
-				}
-				else
-				{
-					moveObject = true;
-					SDL_GetMouseState(&lastMouseX, &lastMouseY);
-				}
-			}
-			break;
-		case SDL_MOUSEBUTTONUP: //cuando se suelta el boton del mouse
-			if (event.button.button == SDL_BUTTON_RIGHT && isDragging) {
-				isDragging = false;
-			}
-			if ( event.button.button == SDL_BUTTON_LEFT && isScrolling)
-			{
-				isScrolling = false;
-				moveObject = false;
-			}
-			break;
-		case SDL_MOUSEWHEEL:
-			// Ajustar el zoom basado en el movimiento de la rueda
-			zoomLevel += event.wheel.y * 0.5f;
-			// Limitar el zoom para evitar que se acerque o aleje demasiado
-			zoomLevel = glm::clamp(zoomLevel, -20.0f, -1.0f);
-			break;
-		case SDL_MOUSEMOTION:
-			if (isDragging || isScrolling || moveObject) {
-				int mouseX, mouseY;
-				SDL_GetMouseState(&mouseX, &mouseY);
-				int deltaX = mouseX - lastMouseX;
-				int deltaY = mouseY - lastMouseY;
-
-				if (isDragging) {rotationY += deltaX * 0.5f; rotationX += deltaY * 0.5f;}
-				if (isScrolling) { cameraOffsetY += deltaY * 0.05f; cameraOffsetX += deltaX * 0.05f;}
-
-				lastMouseX = mouseX;
-				lastMouseY = mouseY;
-			}
-			break;
+	glm::vec3 origin, direction;
+	int x, y;
+	if (Input::consumeObjectClick(x, y)) {
+		const auto t0 = hrclock::now();
+		camera.screenRay(x, y, origin, direction);
+		PickHit hit;
+		draggingSelection = Picking::pick(scene, origin, direction, hit);
+		const double ms = chrono::duration<double, milli>(hrclock::now() - t0).count();
+		if (!draggingSelection) {
+			selectedEntity = Entity();
+			return;
 		}
+		selectedEntity = hit.entity;
+		dragAnchor = hit.point;
+		if (hit.exact) printf("Seleccion: entidad %u, triangulo %u a %.3f (%.3f ms)\n", hit.entity.index(), hit.triangle, hit.distance, ms);
+		else printf("Seleccion: entidad %u por su caja a %.3f (%.3f ms)\n", hit.entity.index(), hit.distance, ms);
+		return;
 	}
-	return true;
+	if (!draggingSelection) return;
+	Transform* transform = scene.transforms.get(selectedEntity);
+	if (Input::drag() != MouseDrag::Object || !transform) {
+		draggingSelection = false;
+		return;
+	}
+
+	Input::mousePosition(x, y);
+	camera.screenRay(x, y, origin, direction);
+	// El eje Z de la camara en mundo es la tercera fila de la rotacion de la vista
+	const glm::mat4& view = camera.view();
+	const glm::vec3 forward = glm::vec3(view[0][2], view[1][2], view[2][2]);
+	glm::vec3 point;
+	if (!Picking::rayPlane(origin, direction, dragAnchor, forward, point) || point == dragAnchor) return;
+	transform->position += point - dragAnchor;
+	dragAnchor = point;
+	scene.markChanged();
+}
+
+static void load_scene()
+{
+	loadSceneRequested = false;
+	selectedEntity = Entity();
+	draggingSelection = false;
+	SceneLoadStats stats;
+	if (!SceneFile::load(scenePath, scene, currentState, &stats)) return;
+	previousState = currentState;
+	printf("Escena %s: %zu entidades en %.2f ms (%zu assets importados, %zu sin encontrar)\n", scenePath,
+		stats.entities, stats.ms, stats.assetsImported, stats.assetsMissing);
+}
+
+// Render bajo demanda: pide frames a Redraw por lo que haya cambiado desde la
+// ultima vez que se miro. Se llama al principio de cada vuelta del bucle
+static bool needs_redraw()
+{
+	static size_t seenEvents = 0;
+	static uint64_t seenCameraVersion = 0;
+	static uint64_t seenSceneVersion = 0;
+	if (Input::events() != seenEvents) {
+		seenEvents = Input::events();
+		Redraw::request(RedrawReason::Input, IMGUI_SETTLE_FRAMES);
+	}
+	// Input sin aplicar, interpolacion que aun no ha llegado al ultimo estado o redimensionado
+	if (hasInput(pendingInput) || !sameState(previousState, currentState) || camera.version() != seenCameraVersion) {
+		seenCameraVersion = camera.version();
+		Redraw::request(RedrawReason::Camera, PIPELINE_FRAMES);
+	}
+	if (scene.version() != seenSceneVersion) {
+		seenSceneVersion = scene.version();
+		Redraw::request(RedrawReason::Scene, PIPELINE_FRAMES);
+	}
+	if (HotReload::readyToApply()) Redraw::request(RedrawReason::Assets);
+	if (ImGui::GetIO().WantTextInput) Redraw::request(RedrawReason::ImGui); // cursor parpadeando
+	if (TraceCapture::capturing()) Redraw::request(RedrawReason::Capture);
+	return Redraw::pending();
+}
+
+// Arranque con las fases independientes en paralelo: la importacion del modelo y
+// la decodificacion de la textura van en workers mientras este hilo crea la
+// ventana y el contexto (SDL y OpenGL tienen que ir en el hilo principal).
+// La subida a GPU espera a las dos cosas. Cada fase queda en Startup.
+static unique_ptr<MyWindow> start_engine(const char* title, bool hidden, const char* modelPath, const char* texturePath)
+{
+	{
+		StartupPhase phase("JobSystem");
+		Profiler::setThreadName("Main");
+		JobSystem::init();
+	}
+
+	struct LoadArgs { const char* model; const char* texture; ImportedModel* imported; DecodedImage* image; };
+	ImportedModel imported;
+	DecodedImage image;
+	const LoadArgs args = { modelPath, texturePath, &imported, &image };
+	JobCounter loaded;
+	JobSystem::run(loaded, [args]() {
+		StartupPhase phase("ImportModel");
+		*args.imported = importFBX(args.model);
+	});
+	if (texturePath) {
+		JobSystem::run(loaded, [args]() {
+			StartupPhase phase("DecodeTexture");
+			*args.image = decodeImage(args.texture);
+		});
+	}
+
+	unique_ptr<MyWindow> window;
+	try {
+		StartupPhase phase("Window");
+		window = make_unique<MyWindow>(title, WINDOW_SIZE.x, WINDOW_SIZE.y, hidden);
+	}
+	catch (...) {
+		JobSystem::wait(loaded); // los jobs escriben en variables de esta funcion
+		throw;
+	}
+	{
+		StartupPhase phase("OpenGL");
+		init_openGL();
+	}
+	{
+		// Solo se lanzan: el driver compila mientras este hilo espera a la carga
+		StartupPhase phase("CompileShaders");
+		Shaders::submit({ { "mesh", MESH_VERTEX_SHADER, MESH_FRAGMENT_SHADER, { "aPosition", "aNormal", "aTexCoord" } } });
+	}
+	{
+		StartupPhase phase("WaitAssets");
+		JobSystem::wait(loaded);
+	}
+	{
+		StartupPhase phase("LinkShaders");
+		meshShader = Shaders::finish()[0];
+		if (const ShaderProgram* shader = Resources::shaders.get(meshShader)) {
+			meshViewProjectionLocation = glGetUniformLocation(shader->id, "uViewProjection");
+			meshModelLocation = glGetUniformLocation(shader->id, "uModel");
+			meshTexturedLocation = glGetUniformLocation(shader->id, "uTextured");
+		}
+		Shaders::print(stdout);
+	}
+	{
+		StartupPhase phase("Upload");
+		const TextureHandle texture = uploadTexture(image);
+		const MaterialHandle material = Resources::materials.insert({ texture });
+		const vector<MeshHandle> meshes = uploadModel(imported);
+		for (const MeshHandle mesh : meshes) { // Cargar los vrtices solo una vez
+			Resources::meshes.get(mesh)->material = material;
+			scene.spawnMesh(mesh);
+		}
+		// Solo se vigilan si alguien llama a HotReload::start(). Con un archivo
+		// montado los ficheros sueltos no son los que se cargan.
+		if (!Pak::mounted()) {
+			HotReload::watchModel(modelPath, meshes);
+			if (texturePath) HotReload::watchTexture(texturePath, texture);
+		}
+		SceneFile::trackModel(modelPath, meshes);
+		if (texturePath) SceneFile::trackTexture(texturePath, texture);
+	}
+	return window;
+}
+
+// Arranque del render por software: la misma carga en paralelo que start_engine
+// pero sin ventana ni OpenGL; las mallas y la textura se quedan en CPU
+static void start_software(const char* modelPath, const char* texturePath)
+{
+	{
+		StartupPhase phase("JobSystem");
+		Profiler::setThreadName("Main");
+		JobSystem::init();
+	}
+
+	struct LoadArgs { const char* texture; DecodedImage* image; };
+	ImportedModel imported;
+	DecodedImage image;
+	const LoadArgs args = { texturePath, &image };
+	JobCounter loaded;
+	if (texturePath) {
+		JobSystem::run(loaded, [args]() {
+			StartupPhase phase("DecodeTexture");
+			*args.image = decodeImage(args.texture);
+		});
+	}
+	{
+		StartupPhase phase("ImportModel");
+		imported = importFBX(modelPath);
+	}
+	{
+		StartupPhase phase("WaitAssets");
+		JobSystem::wait(loaded);
+	}
+	{
+		// Se llama igual que en start_engine para que loadMs mida lo mismo
+		StartupPhase phase("Upload");
+		const TextureHandle texture = insertTextureCpu(image);
+		const MaterialHandle material = Resources::materials.insert({ texture });
+		for (const MeshHandle mesh : insertModelCpu(imported)) {
+			Resources::meshes.get(mesh)->material = material;
+			scene.spawnMesh(mesh);
+		}
+	}
+}
+
+// Ultimo frame del FBO enlazado a BMP; OpenGL lo devuelve con la fila 0 abajo
+static bool save_framebuffer(const char* path, int width, int height)
+{
+	const size_t rowBytes = static_cast<size_t>(width) * 4;
+	vector<unsigned char> pixels(rowBytes * height);
+	vector<unsigned char> flipped(pixels.size());
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	for (int y = 0; y < height; y++) memcpy(&flipped[y * rowBytes], &pixels[(height - 1 - y) * rowBytes], rowBytes);
+
+	SDL_Surface* image = SDL_CreateRGBSurfaceWithFormatFrom(flipped.data(), width, height, 32, static_cast<int>(rowBytes), SDL_PIXELFORMAT_RGBA32);
+	const bool saved = image && SDL_SaveBMP(image, path) == 0;
+	if (!saved) fprintf(stderr, "No se puede guardar %s: %s\n", path, SDL_GetError());
+	if (image) SDL_FreeSurface(image);
+	return saved;
+}
+
+// Modo headless: renderiza un numero fijo de frames en un FBO siguiendo un
+// recorrido de camara y escribe las estadisticas en JSON. No abre ventana
+// visible ni necesita GPU (funciona con llvmpipe).
+// Con --software no se crea contexto de OpenGL: dibuja SoftwareRenderer, y el
+// JSON se puede comparar con el de la misma ejecucion sin --software.
+// --image guarda el ultimo frame en BMP con cualquiera de los dos.
+// --headless <modelo> [--texture f] [--camera f] [--frames N] [--out f.json] [--software] [--image f.bmp]
+static int run_headless(int argc, char** argv, const char* tracePath, int traceFrames)
+{
+	const char* model = nullptr;
+	const char* texture = nullptr;
+	const char* cameraPath = nullptr;
+	const char* out = nullptr;
+	const char* imagePath = nullptr;
+	bool softwareRender = false;
+	int frames = 600;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--software") == 0) softwareRender = true;
+		if (i + 1 >= argc) break;
+		if (strcmp(argv[i], "--headless") == 0) model = argv[++i];
+		else if (strcmp(argv[i], "--texture") == 0) texture = argv[++i];
+		else if (strcmp(argv[i], "--camera") == 0) cameraPath = argv[++i];
+		else if (strcmp(argv[i], "--frames") == 0) frames = max(1, atoi(argv[++i]));
+		else if (strcmp(argv[i], "--out") == 0) out = argv[++i];
+		else if (strcmp(argv[i], "--image") == 0) imagePath = argv[++i];
+	}
+	if (!model) {
+		fprintf(stderr, "Uso: --headless <modelo> [--texture f] [--camera f] [--frames N] [--out f.json] [--software] [--image f.bmp]\n");
+		return 1;
+	}
+
+	// Driver "offscreen" de SDL (EGL surfaceless) salvo que se pida otro explicitamente
+	if (!getenv("SDL_VIDEODRIVER")) SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+
+	if (tracePath) TraceCapture::start(tracePath, traceFrames);
+	unique_ptr<MyWindow> window;
+	unique_ptr<OffscreenTarget> target;
+	unique_ptr<SoftwareRenderer> software;
+	if (softwareRender) {
+		start_software(model, texture);
+		software = make_unique<SoftwareRenderer>(WINDOW_SIZE.x, WINDOW_SIZE.y);
+	}
+	else {
+		window = start_engine("Oyuki headless", true, model, texture);
+		target = make_unique<OffscreenTarget>(WINDOW_SIZE.x, WINDOW_SIZE.y);
+	}
+
+	// Tiempo de pared de la carga, aunque se haya solapado con la ventana
+	const double loadMs = Startup::spanMs("ImportModel", "Upload");
+	Profiler::endFrame(); // La carga no cuenta como frame
+
+	const auto path = Benchmark::loadCameraPath(cameraPath, frames);
+	vector<double> frameMs;
+	frameMs.reserve(frames);
+	long long drawCalls = 0, triangles = 0;
+	FramePacket packet;
+	// Los primeros frames aun hacen crecer vectores y arenas; el resto deberia reservar 0
+	const int warmupFrames = min(frames / 2, 10);
+	long long steadyAllocations = 0;
+	uint64_t lastAllocations = AllocationCounter::count();
+
+	if (target) target->bind();
+	for (int f = 0; f < frames; f++) {
+		const auto t0 = hrclock::now();
+
+		const Benchmark::CameraKey key = Benchmark::sampleCameraPath(path, f);
+		SimState state;
+		state.rotationX = key.rotationX;
+		state.rotationY = key.rotationY;
+		state.zoomLevel = key.zoomLevel;
+		state.cameraOffsetX = key.cameraOffsetX;
+		state.cameraOffsetY = key.cameraOffsetY;
+
+		packet.reset(f);
+		extract_frame(state, packet, camera); // sin late latch: la misma camara dibuja y hace el culling
+		if (software) {
+			software->draw(packet, camera);
+		}
+		else {
+			display_func(packet, camera);
+			glFinish(); // Sin swap: esperamos a la GPU para que el tiempo del frame la incluya
+		}
+		Startup::markFirstFrame();
+
+		frameMs.push_back(chrono::duration<double, milli>(hrclock::now() - t0).count());
+		GpuTimer::endFrame();
+		FrameArena::resetAll();
+		const uint64_t allocations = AllocationCounter::count();
+		Profiler::addCounter(Counter::HeapAllocations, static_cast<int64_t>(allocations - lastAllocations));
+		lastAllocations = allocations;
+		Profiler::endFrame();
+		TraceCapture::endFrame();
+		drawCalls += Profiler::lastCounter(Counter::DrawCalls);
+		triangles += Profiler::lastCounter(Counter::Triangles);
+		if (f >= warmupFrames) steadyAllocations += Profiler::lastCounter(Counter::HeapAllocations);
+	}
+	bool imageSaved = true;
+	if (imagePath) imageSaved = software ? software->save(imagePath) : save_framebuffer(imagePath, target->width(), target->height());
+	if (target) OffscreenTarget::unbind();
+
+	Benchmark::HeadlessReport report;
+	report.model = model;
+	if (software) {
+		report.renderer = string("Oyuki software (") + to_string(JobSystem::workerCount()) + " hilos, "
+			+ SimdMath::levelName(SimdMath::level()) + ")";
+		report.width = software->width();
+		report.height = software->height();
+	}
+	else {
+		report.renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+		report.width = target->width();
+		report.height = target->height();
+	}
+	report.frames = frames;
+	report.loadMs = loadMs;
+	report.frameTimes = Benchmark::computeFrameTimes(frameMs);
+	report.drawCallsPerFrame = static_cast<double>(drawCalls) / frames;
+	report.trianglesPerFrame = static_cast<double>(triangles) / frames;
+	report.peakMemory = Benchmark::peakMemoryBytes();
+	report.heapAllocationsPerFrame = static_cast<double>(steadyAllocations) / max(1, frames - warmupFrames);
+	const bool written = Benchmark::writeReport(report, out);
+
+	software.reset();
+	target.reset();
+	scene.clear();
+	Resources::destroyAll();
+	TraceCapture::stop();
+	GpuTimer::shutdown();
+	JobSystem::shutdown();
+	Pak::unmount();
+	return written && imageSaved ? 0 : 1;
 }
 
 int main(int argc, char** argv) {
-	MyWindow window("SDL2 Simple Example", WINDOW_SIZE.x, WINDOW_SIZE.y);
-	init_openGL();
+	if (argc > 1 && strcmp(argv[1], "--bench-jobs") == 0) return Benchmark::runJobSystem();
+
+	// --bench-stages [maxTriangulos] [--out fichero.json]: etapas de carga y extraccion
+	if (argc > 1 && strcmp(argv[1], "--bench-stages") == 0) {
+		size_t maxTriangles = 2000000; // la ultima malla pasa del millon de vertices
+		const char* out = nullptr;
+		for (int i = 2; i < argc; i++) {
+			if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) out = argv[++i];
+			else maxTriangles = strtoull(argv[i], nullptr, 10);
+		}
+		return Benchmark::runStages(maxTriangles, out);
+	}
+
+	// --bench-scene [entidades]: sistemas de la escena ECS (100k por defecto)
+	if (argc > 1 && strcmp(argv[1], "--bench-scene") == 0)
+		return Benchmark::runScene(argc > 2 ? strtoull(argv[2], nullptr, 10) : 100000);
+
+	// --bench-scene-file [entidades]: guardar y cargar la escena en binario (100k por defecto)
+	if (argc > 1 && strcmp(argv[1], "--bench-scene-file") == 0)
+		return Benchmark::runSceneFile(argc > 2 ? strtoull(argv[2], nullptr, 10) : 100000);
+
+	// --bench-simd [elementos]: valida y mide los kernels SIMD en cada nivel de la CPU
+	if (argc > 1 && strcmp(argv[1], "--bench-simd") == 0)
+		return Benchmark::runSimd(argc > 2 ? strtoull(argv[2], nullptr, 10) : 100000);
+
+	// --bench-pick [triangulos]: BVH y picking sobre una malla de 2M triangulos por defecto
+	if (argc > 1 && strcmp(argv[1], "--bench-pick") == 0)
+		return Benchmark::runPicking(argc > 2 ? strtoull(argv[2], nullptr, 10) : 2000000);
+
+	// --bench-raster [triangulos]: render por software (1M triangulos por defecto) en cada nivel SIMD
+	if (argc > 1 && strcmp(argv[1], "--bench-raster") == 0)
+		return Benchmark::runRaster(argc > 2 ? strtoull(argv[2], nullptr, 10) : 1000000);
+
+	// --bench-import [modelo] [--runs N] [--io stdio|mmap|memory]: tiempo y pico de memoria de
+	// la importacion con cada forma de leer el fichero
+	if (argc > 1 && strcmp(argv[1], "--bench-import") == 0) {
+		const char* model = MODEL_PATH;
+		const char* io = nullptr;
+		int runs = 5;
+		for (int i = 2; i < argc; i++) {
+			if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) runs = atoi(argv[++i]);
+			else if (strcmp(argv[i], "--io") == 0 && i + 1 < argc) io = argv[++i];
+			else model = argv[i];
+		}
+		return Benchmark::runImport(model, runs, io);
+	}
+
+	// --pack <salida.pak> <directorio|fichero>...: empaqueta los assets (nombres relativos al directorio)
+	if (argc > 1 && strcmp(argv[1], "--pack") == 0) {
+		if (argc < 4) {
+			fprintf(stderr, "Uso: --pack <salida.pak> <directorio|fichero>...\n");
+			return 1;
+		}
+		vector<PakInput> inputs;
+		for (int i = 3; i < argc; i++) Pak::collect(argv[i], inputs);
+		JobSystem::init(); // los bloques se comprimen en paralelo
+		const bool written = Pak::write(argv[2], inputs);
+		JobSystem::shutdown();
+		return written ? 0 : 1;
+	}
+
+	// --trace <fichero.json> [frames]: captura desde el arranque (incluye la carga)
+	const char* tracePath = nullptr;
+	int traceFrames = 300;
+	bool headless = false;
+	bool relativeMouse = true;
+	bool continuous = false;
+	const char* inputLogPath = nullptr;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+			tracePath = argv[++i];
+			if (i + 1 < argc && argv[i + 1][0] != '-') traceFrames = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--headless") == 0) headless = true;
+		else if (strcmp(argv[i], "--no-shader-cache") == 0) shaderCacheDirectory = nullptr;
+		else if (strcmp(argv[i], "--no-relative-mouse") == 0) relativeMouse = false;
+		// --continuous: dibuja todos los frames aunque no cambie nada (para medir)
+		else if (strcmp(argv[i], "--continuous") == 0) continuous = true;
+		// --input-log <fichero.csv>: latencia de cada frame con eventos de camara
+		else if (strcmp(argv[i], "--input-log") == 0 && i + 1 < argc) inputLogPath = argv[++i];
+		else if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+			scenePath = argv[++i];
+			persistScene = true;
+		}
+		// --pak <archivo.pak>: el modelo y la textura se leen del archivo
+		else if (strcmp(argv[i], "--pak") == 0 && i + 1 < argc) {
+			if (!Pak::mount(argv[++i])) {
+				fprintf(stderr, "No se puede montar %s\n", argv[i]);
+				return 1;
+			}
+		}
+	}
+	if (headless) return run_headless(argc, argv, tracePath, traceFrames);
+
+	if (tracePath) TraceCapture::start(tracePath, traceFrames);
+	const unique_ptr<MyWindow> window = start_engine("SDL2 Simple Example", false, MODEL_PATH, TEXTURE_PATH);
+	if (persistScene && filesystem::exists(scenePath)) load_scene();
+	Input::init(relativeMouse, inputLogPath);
+	Redraw::init(!continuous);
+	HotReload::start();
 	srand(static_cast<unsigned int>(time(nullptr)));
 
-	dato = LoadFBX(); // Cargar los vrtices solo una vez
-	LoadText();
-	while (processEvents()) {
+	// La simulacion avanza a paso fijo; el render interpola entre los dos ultimos estados
+	FixedTimestep timestep(SIM_DT, MAX_SIM_STEPS);
+	FramePipeline pipeline;
+	unsigned long long frameIndex = 0;
+	pipeline.back().reset(frameIndex);
+	extract_frame(currentState, pipeline.back(), cullCamera);
+	pipeline.swap();
+	uint64_t lastAllocations = AllocationCounter::count();
+
+	while (processEvents(*window)) {
+		// Nada nuevo que ensenar: se espera a un evento en vez de dibujar lo mismo otra vez.
+		// Al despertar solo se miran los ficheros vigilados; la escena no se toca
+		if (!needs_redraw()) {
+			Redraw::wait(HotReload::busy() ? HOT_RELOAD_POLL_MS : IDLE_TIMEOUT_MS);
+			HotReload::poll();
+			continue;
+		}
 		const auto t0 = hrclock::now();
-		display_func();
-		window.draw();
+		// Estado mas reciente con todo el input recibido: la base de la camara del late latch
+		const SimState latchBase = applyInput(currentState, pendingInput);
+
+		// Frame N+1: simulacion y extraccion en un worker mientras este hilo dibuja el frame N
+		struct SimulateArgs { FixedTimestep* timestep; FramePacket* packet; unsigned long long frame; };
+		SimulateArgs args = { &timestep, &pipeline.back(), ++frameIndex };
+		JobCounter simulated;
+		JobSystem::run(simulated, [args]() {
+			PROFILE_SCOPE("Simulate");
+			const int steps = args.timestep->advance();
+			for (int i = 0; i < steps; i++) {
+				previousState = currentState;
+				update_simulation(currentState, pendingInput);
+			}
+			args.packet->resetKeepingDraws(args.frame);
+			extract_frame(lerpState(previousState, currentState, static_cast<float>(args.timestep->alpha())), *args.packet, cullCamera);
+		});
+
+		// Late latch: la camara del frame N se calcula ahora, con los eventos que acaban
+		// de llegar y sin interpolar. Lo que se anade aqui lo recoge la simulacion del frame siguiente
+		if (!Input::pump()) quitRequested = true;
+		camera.setPose(applyInput(latchBase, Input::peek()));
+		Input::latch();
+		display_func(pipeline.front(), camera);
+		window->draw();
+		Input::presented();
+		Redraw::frameDrawn();
+		GpuTimer::endFrame();
+		Startup::markFirstFrame();
+
+		JobSystem::wait(simulated);
+		pipeline.swap();
+		// Limite entre frames: ningun job lee recursos, se pueden cambiar los recargados
+		HotReload::update(scene);
+		update_selection();
+		if (saveSceneRequested) save_scene();
+		if (loadSceneRequested) load_scene();
+
+		// Ya no queda ningun job del frame: las arenas se pueden reiniciar
+		FrameArena::resetAll();
+		const uint64_t allocations = AllocationCounter::count();
+		Profiler::addCounter(Counter::HeapAllocations, static_cast<int64_t>(allocations - lastAllocations));
+		lastAllocations = allocations;
+		Profiler::endFrame();
+		TraceCapture::endFrame();
 		const auto t1 = hrclock::now();
 		const auto dt = t1 - t0;
 		if(dt<FRAME_DT) this_thread::sleep_for(FRAME_DT - dt);
 	}
-	for (auto& mesh : dato) {
-		cleanupMeshData(mesh);
-	}
+	if (persistScene) save_scene();
+	Input::shutdown();
+	Redraw::shutdown();
+	HotReload::stop();
+	scene.clear();
+	Resources::destroyAll();
+	TraceCapture::stop();
+	GpuTimer::shutdown();
+	JobSystem::shutdown();
+	Pak::unmount();
 
 	return 0;
 }
\ No newline at end of file